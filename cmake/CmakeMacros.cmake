@@ -23,8 +23,15 @@ macro(CREATE_APP name)
     message(STATUS "HEADER_FILES: ${HEADER_FILES}")
     message(STATUS "SHADER_FILES: ${SHADER_FILES}")
 
+    # The engine is built once as a static library, the app and the tests link against it
+    set(ENGINE_SRC_FILES ${SRC_FILES})
+    list(FILTER ENGINE_SRC_FILES EXCLUDE REGEX ".*/src/main\\.cpp$")
+    set(ENGINE_NAME ${PROJECT_NAME}_Engine)
+
     include_directories(${CMAKE_SOURCE_DIR}/src)
-    add_executable(${PROJECT_NAME} ${SRC_FILES} ${HEADER_FILES} ${SHADER_FILES})
+    add_library(${ENGINE_NAME} STATIC ${ENGINE_SRC_FILES} ${HEADER_FILES} ${SHADER_FILES})
+    add_executable(${PROJECT_NAME} ${CMAKE_SOURCE_DIR}/src/main.cpp)
+    target_link_libraries(${PROJECT_NAME} PRIVATE ${ENGINE_NAME})
 
     SETUP_GROUPS("${SRC_FILES}")
     SETUP_GROUPS("${HEADER_FILES}")
@@ -39,9 +46,9 @@ macro(CREATE_APP name)
         set_target_properties(${PROJECT_NAME} PROPERTIES RUNTIME_OUTPUT_DIRECTORY "${CMAKE_SOURCE_DIR}/bin")
     endif()
 
-    set_property(TARGET ${PROJECT_NAME} PROPERTY CXX_STANDARD 20)
-    set_property(TARGET ${PROJECT_NAME} PROPERTY CXX_STANDARD_REQUIRED ON)
-    set_property(TARGET ${PROJECT_NAME} PROPERTY CMAKE_CXX_EXTENSIONS OFF)
+    set_property(TARGET ${PROJECT_NAME} ${ENGINE_NAME} PROPERTY CXX_STANDARD 20)
+    set_property(TARGET ${PROJECT_NAME} ${ENGINE_NAME} PROPERTY CXX_STANDARD_REQUIRED ON)
+    set_property(TARGET ${PROJECT_NAME} ${ENGINE_NAME} PROPERTY CMAKE_CXX_EXTENSIONS OFF)
     if(MSVC)
         add_compile_options(/std:c++20)
     else()
@@ -53,4 +60,18 @@ macro(CREATE_APP name)
         add_definitions(-D_CONSOLE)
         set_property(TARGET ${PROJECT_NAME} PROPERTY VS_DEBUGGER_WORKING_DIRECTORY "${CMAKE_SOURCE_DIR}")
     endif()
-endmacro()
\ No newline at end of file
+endmacro()
+
+
+# Tests and benchmarks link against the engine library like the app, its defines and libraries come along with it
+macro(CREATE_TEST name)
+    add_executable(${name} ${ARGN})
+    target_link_libraries(${name} PRIVATE EOS_Engine)
+
+    set_property(TARGET ${name} PROPERTY CXX_STANDARD 20)
+    set_property(TARGET ${name} PROPERTY CXX_STANDARD_REQUIRED ON)
+
+    if (UNIX)
+        set_target_properties(${name} PROPERTIES RUNTIME_OUTPUT_DIRECTORY "${CMAKE_SOURCE_DIR}/bin")
+    endif()
+endmacro()
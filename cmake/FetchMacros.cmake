@@ -13,16 +13,16 @@
     set(GLFW_BUILD_WAYLAND OFF)
     set(GLFW_BUILD_X11 OFF)
 
-    target_compile_definitions(EOS PRIVATE GLFW_INCLUDE_VULKAN)
+    target_compile_definitions(EOS_Engine PUBLIC GLFW_INCLUDE_VULKAN)
 
     if(USE_WINDOWS)
-        target_compile_definitions(EOS PRIVATE GLFW_EXPOSE_NATIVE_WIN32)
+        target_compile_definitions(EOS_Engine PUBLIC GLFW_EXPOSE_NATIVE_WIN32)
         set(GLFW_BUILD_WIN32 ON)
     elseif (USE_WAYLAND)
-        target_compile_definitions(EOS PRIVATE GLFW_EXPOSE_NATIVE_WAYLAND)
+        target_compile_definitions(EOS_Engine PUBLIC GLFW_EXPOSE_NATIVE_WAYLAND)
         set(GLFW_BUILD_WAYLAND ON)
     elseif (USE_X11)
-        target_compile_definitions(EOS PRIVATE GLFW_EXPOSE_NATIVE_X11)
+        target_compile_definitions(EOS_Engine PUBLIC GLFW_EXPOSE_NATIVE_X11)
         set(GLFW_BUILD_X11 ON)
     else ()
         message(FATAL_ERROR "Could not detect OS for GLFW")
@@ -37,7 +37,7 @@
             SOURCE_DIR     ${GLFW_ROOT_DIR}
     )
     add_subdirectory(${GLFW_ROOT_DIR})
-    target_link_libraries(EOS PUBLIC glfw)
+    target_link_libraries(EOS_Engine PUBLIC glfw)
 endmacro()
 
 macro(FETCH_VOLK tag, depsDir)
@@ -53,7 +53,7 @@ macro(FETCH_VOLK tag, depsDir)
     )
 
     add_subdirectory(${VOLK_ROOT_DIR})
-    target_link_libraries(EOS PRIVATE volk_headers)
+    target_link_libraries(EOS_Engine PUBLIC volk_headers)
 endmacro()
 
 macro(FETCH_VMA depsDir)
@@ -68,7 +68,7 @@ macro(FETCH_VMA depsDir)
     )
 
     add_subdirectory(${VMA_ROOT_DIR})
-    target_link_libraries(EOS PRIVATE GPUOpen::VulkanMemoryAllocator)
+    target_link_libraries(EOS_Engine PUBLIC GPUOpen::VulkanMemoryAllocator)
 endmacro()
 
 macro(FETCH_SPDLOG depsDir)
@@ -82,7 +82,7 @@ macro(FETCH_SPDLOG depsDir)
             SOURCE_DIR     ${SPDLOG_ROOT_DIR}
     )
     add_subdirectory(${SPDLOG_ROOT_DIR})
-    target_link_libraries(EOS PRIVATE spdlog)
+    target_link_libraries(EOS_Engine PUBLIC spdlog)
 endmacro()
 
 macro(FETCH_SLANG)
@@ -103,7 +103,7 @@ macro(FETCH_SLANG)
     else()
 
         message(STATUS "Found Slang library: ${SLANG_LIBRARY}")
-        target_link_libraries(EOS PRIVATE ${SLANG_LIBRARY})
+        target_link_libraries(EOS_Engine PUBLIC ${SLANG_LIBRARY})
 
         # Add include directory if it exists
         if(EXISTS "${SLANG_BASE_PATH}/include")
@@ -6,6 +6,15 @@
 
 namespace EOS
 {
+    bool SamplerDescription::operator==(const SamplerDescription& other) const
+    {
+        return MinFilter == other.MinFilter && MagFilter == other.MagFilter && MipMap == other.MipMap
+            && WrapU == other.WrapU && WrapV == other.WrapV && WrapW == other.WrapW
+            && DepthCompareOp == other.DepthCompareOp && DepthCompareEnabled == other.DepthCompareEnabled
+            && MipLodMin == other.MipLodMin && MipLodMax == other.MipLodMax && MipLodBias == other.MipLodBias
+            && MaxAnisotropy == other.MaxAnisotropy;
+    }
+
     std::unique_ptr<IContext> CreateContextWithSwapChain(const ContextCreationDescription& contextCreationDescription)
     {
         //Initialize the logger
@@ -15,6 +24,18 @@ namespace EOS
         return std::move( std::make_unique<VulkanContext>(contextCreationDescription) );
     }
 
+    std::unique_ptr<IContext> CreateHeadlessContext(const ContextCreationDescription& contextCreationDescription)
+    {
+        Logger::Init("EOS", ".cache/log.txt");
+
+        //Without a window no surface and SwapChain get created
+        ContextCreationDescription headlessDescription = contextCreationDescription;
+        headlessDescription.window = nullptr;
+        headlessDescription.display = nullptr;
+
+        return std::make_unique<VulkanContext>(headlessDescription);
+    }
+
     std::unique_ptr<ShaderCompiler> CreateShaderCompiler(const std::filesystem::path& shaderFolder)
     {
         return std::move(std::make_unique<EOS::ShaderCompiler>(shaderFolder));
@@ -1,7 +1,11 @@
 ﻿#pragma once
 
+#include <array>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -48,6 +52,8 @@ namespace EOS
     using TextureHandle             = Handle<struct Texture>;
     using QueryPoolHandle           = Handle<struct QueryPool>;
     using AccelStructHandle         = Handle<struct AccelerationStructure>;
+    using SplitBarrierHandle        = Handle<struct SplitBarrier>;
+    using TransientMemoryHandle     = Handle<struct TransientMemory>;
 
     struct HardwareDeviceDescription final
     {
@@ -60,6 +66,20 @@ namespace EOS
     {
         bool enableValidationLayers{ true };
         ColorSpace DesiredSwapChainColorSpace { ColorSpace::SRGB_Linear };
+        uint32_t NumFramesInFlight{ 2 };
+        uint64_t UploadRingFrameSize{ 16 * 1024 * 1024 };   // the amount of bytes that can be uploaded through AllocateUpload per frame in flight
+        float MemoryBudgetThreshold{ 0.9f };                // the eviction callbacks get called once a device local heap uses more than this part of its budget
+        uint64_t DefragmentationBytesPerFrame{ 32 * 1024 * 1024 };  // the amount of bytes the defragmentation can move per submit
+        uint32_t DefragmentationMovesPerFrame{ 64 };                // the amount of allocations the defragmentation can move per submit
+        uint32_t MaxBindlessTextures{ 16 * 1024 };          // the size of the bindless arrays, clamped to what the device supports
+        uint32_t MaxBindlessSamplers{ 1024 };
+        uint32_t MaxBindlessBuffers{ 16 * 1024 };
+        bool PreferDescriptorBuffer{ true };                // use VK_EXT_descriptor_buffer for the bindless resources when the device supports it, descriptors are still written by the thread that submits
+        float MaxSamplerAnisotropy{ 16.0f };                // every sampler's anisotropy is clamped to this, 1 disables anisotropic filtering everywhere
+        float SamplerMipLodBias{ 0.0f };                    // added to the lod bias of every sampler, for example to sharpen textures when rendering at a lower resolution
+        const char* PipelineCachePath{ ".cache/pipelines.bin" };   // compiled pipelines are kept here between runs, nullptr disables it
+        uint32_t PipelineCacheSaveInterval{ 60 };           // seconds between saves of the pipeline cache while it keeps growing
+        bool UseShaderObjects{ false };                     // also create VK_EXT_shader_object shaders for every shader module when the device supports them, see cmdBindShaders
     };
 
     struct ContextCreationDescription final
@@ -71,23 +91,136 @@ namespace EOS
         void*                   display{};
     };
 
+    static constexpr uint32_t RemainingMipLevels    = 0xFFFFFFFF;
+    static constexpr uint32_t RemainingArrayLayers  = 0xFFFFFFFF;
+    static constexpr uint64_t WholeSize             = 0xFFFFFFFFFFFFFFFF;
+    static constexpr uint32_t MaxColorAttachments   = 8;
+
     /**
-     * @brief Used for buffer StateTransitioning without changing the index queue
+     * @brief A range of mip levels and array layers of a texture, by default it covers the whole texture.
+     */
+    struct SubresourceRange final
+    {
+        uint32_t BaseMipLevel   = 0;
+        uint32_t NumMipLevels   = RemainingMipLevels;
+        uint32_t BaseArrayLayer = 0;
+        uint32_t NumArrayLayers = RemainingArrayLayers;
+    };
+
+    /**
+     * @brief Used for buffer StateTransitioning without changing the index queue.
+     * When a Buffer is given only the bytes in [Offset, Offset + Size) are made available, otherwise it acts on all memory.
      */
     struct GlobalBarrier final
     {
         const BufferHandle      Buffer;
         const ResourceState     CurrentState;
         const ResourceState     NextState;
+        const uint64_t          Offset  = 0;
+        const uint64_t          Size    = WholeSize;
     };
 
+    /**
+     * @brief Transitions the given mip levels and array layers of a texture, by default the whole texture is transitioned.
+     */
     struct ImageBarrier final
     {
-        const TextureHandle    Texture;
+        const TextureHandle     Texture;
         const ResourceState     CurrentState;
         const ResourceState     NextState;
+        const SubresourceRange  Range{};
+    };
+
+    struct TextureDescription final
+    {
+        ImageType Type          = ImageType::Image_2D;
+        Format TextureFormat    = Format::Invalid;
+        uint32_t Width          = 1;
+        uint32_t Height         = 1;
+        uint32_t Depth          = 1;
+        uint32_t NumLayers      = 1;
+        uint32_t NumMipLevels   = 1;
+        uint32_t NumSamples     = 1;
+        uint8_t Usage           = TextureUsageFlags::Sampled;
+        StorageType Storage     = StorageType::Device;
+        const char* DebugName   = "";
     };
 
+    /**
+    * @brief Samplers with the same description share 1 sampler, so asking for the same description again is cheap.
+    */
+    struct SamplerDescription final
+    {
+        [[nodiscard]] bool operator==(const SamplerDescription& other) const;
+
+        SamplerFilter MinFilter     = SamplerFilter::Linear;
+        SamplerFilter MagFilter     = SamplerFilter::Linear;
+        SamplerMipMap MipMap        = SamplerMipMap::Linear;
+        SamplerWrap WrapU           = SamplerWrap::Repeat;
+        SamplerWrap WrapV           = SamplerWrap::Repeat;
+        SamplerWrap WrapW           = SamplerWrap::Repeat;
+        CompareOp DepthCompareOp    = CompareOp::AlwaysPass;
+        bool DepthCompareEnabled    = false;
+        float MipLodMin             = 0.0f;
+        float MipLodMax             = 1000.0f;     // VK_LOD_CLAMP_NONE
+        float MipLodBias            = 0.0f;
+        float MaxAnisotropy         = 1.0f;        // anisotropic filtering is used when this is above 1
+        const char* DebugName       = "";          // not part of the description, the name of the first sampler with a description is used
+    };
+
+    /**
+    * @brief The memory a resource needs, used to place resources with non overlapping lifetimes in the same transient memory.
+    */
+    struct MemoryRequirements final
+    {
+        uint64_t Size               = 0;
+        uint64_t Alignment          = 1;
+        uint32_t MemoryTypeBits     = 0xFFFFFFFF;   // the memory types the resource can live in
+    };
+
+    struct BufferDescription final
+    {
+        uint8_t Usage           = 0;
+        StorageType Storage     = StorageType::HostVisible;
+        size_t Size             = 0;
+        const void* Data        = nullptr;  // Optional data the buffer gets filled with
+        const char* DebugName   = "";
+    };
+
+    /**
+    * @brief A part of the upload ring, it is only valid until the GPU has finished the submit of the frame it was allocated in.
+    */
+    struct UploadAllocation final
+    {
+        [[nodiscard]] bool Valid() const { return Data != nullptr; }
+
+        uint8_t* Data           = nullptr;  // CPU pointer to write to
+        uint64_t GPUAddress     = 0;        // GPU address of the first byte
+        BufferHandle Buffer{};              // The buffer the allocation lives in, for copies or bindings that need a buffer and offset
+        uint64_t Offset         = 0;
+        uint64_t Size           = 0;
+    };
+
+    struct MemoryHeapStatistics final
+    {
+        uint64_t Usage      = 0;        // bytes used by this process
+        uint64_t Budget     = 0;        // bytes this process can use before the OS starts paging the memory out
+        bool IsDeviceLocal  = false;
+    };
+
+    struct MemoryStatistics final
+    {
+        std::array<uint64_t, static_cast<size_t>(MemoryCategory::Count)> CategoryUsage{};   // bytes allocated per MemoryCategory
+        std::vector<MemoryHeapStatistics> Heaps;
+    };
+
+    /**
+    * @brief Gets called when the device memory usage gets above the budget threshold, for example to let texture streaming drop mips.
+    * @param bytesToFree The amount of bytes that should be freed to get back under the threshold.
+    * @return The amount of bytes that were freed, callbacks that were added later only get called when this is not enough.
+    */
+    using EvictionCallback = std::function<uint64_t(uint64_t bytesToFree)>;
+
     struct ShaderInfo final
     {
         std::vector<uint32_t> spirv;
@@ -96,6 +229,87 @@ namespace EOS
         const char* debugName;
     };
 
+    /**
+    * @brief Gives the specialization constant with the ID the Size bytes at Offset in the data of the SpecializationInfo.
+    */
+    struct SpecializationConstant final
+    {
+        uint32_t ID     = 0;    // the constant_id of the constant in the shader
+        uint32_t Offset = 0;
+        uint32_t Size   = 0;
+    };
+
+    /**
+    * @brief The values of the specialization constants of a pipeline, they are copied when the pipeline is created.
+    */
+    struct SpecializationInfo final
+    {
+        std::span<const SpecializationConstant> Constants{};
+        const void* Data    = nullptr;
+        size_t DataSize     = 0;
+    };
+
+    struct ComputePipelineDescription final
+    {
+        ShaderModuleHandle ComputeShader{};
+        SpecializationInfo Specialization{};
+        const char* DebugName   = "";
+    };
+
+    struct ColorAttachmentDescription final
+    {
+        Format ColorFormat  = Format::Invalid;
+        BlendMode Blending  = BlendMode::Opaque;
+    };
+
+    /**
+    * @brief The shaders and fixed function state of a render pipeline, it renders into attachments of the given formats.
+    * There is no vertex input, vertex shaders pull their vertices from buffers through their GPU address.
+    * The viewport and scissor are set while recording.
+    */
+    struct RenderPipelineDescription final
+    {
+        ShaderModuleHandle VertexShader{};
+        ShaderModuleHandle FragmentShader{};
+        Topology PrimitiveTopology  = Topology::Triangle;
+        PolygonMode Polygon         = PolygonMode::Fill;
+        CullMode Culling            = CullMode::Back;
+        WindingMode FrontFace       = WindingMode::CounterClockWise;
+        std::array<ColorAttachmentDescription, MaxColorAttachments> ColorAttachments{};     // the attachments up to the first one without a format are used
+        Format DepthFormat          = Format::Invalid;
+        CompareOp DepthCompareOp    = CompareOp::AlwaysPass;
+        bool DepthWriteEnabled      = false;
+        uint32_t NumSamples         = 1;
+        const char* DebugName       = "";
+    };
+
+    struct ColorAttachment final
+    {
+        TextureHandle Texture{};
+        LoadOp Load                     = LoadOp::Clear;
+        StoreOp Store                   = StoreOp::Store;
+        std::array<float, 4> ClearColor = { 0.0f, 0.0f, 0.0f, 1.0f };
+        TextureHandle ResolveTexture{};     // a multisampled texture gets resolved into this one, the texture itself can then often use StoreOp::DontCare
+    };
+
+    struct DepthAttachment final
+    {
+        TextureHandle Texture{};
+        LoadOp Load             = LoadOp::Clear;
+        StoreOp Store           = StoreOp::DontCare;
+        float ClearDepth        = 1.0f;
+    };
+
+    /**
+    * @brief The attachments rendered into between cmdBeginRendering and cmdEndRendering, the first mip level and array layer of each texture is used.
+    * All attachments need to have the same size, the load and store ops decide which attachments ever get read from or written to memory.
+    */
+    struct Framebuffer final
+    {
+        std::array<ColorAttachment, MaxColorAttachments> ColorAttachments{};     // the attachments up to the first one without a texture are used
+        DepthAttachment Depth{};
+    };
+
 #pragma region INTERFACES
     //TODO: instead of interfaces use concept and a forward declare. And then every API implements 1 class of that name with the concept.
     //CMake should handle that only 1 type of API is being used at the time.
@@ -131,6 +345,12 @@ namespace EOS
         */
         virtual SubmitHandle Submit(ICommandBuffer& commandBuffer, TextureHandle present) = 0;
 
+        /**
+        * @brief Blocks until the GPU has finished a submission, for example to read back what it wrote into a host visible buffer.
+        * @param handle The handle returned by Submit, an empty handle waits until the GPU is idle.
+        */
+        virtual void Wait(SubmitHandle handle) = 0;
+
         /**
          * @brief Gets the handle to the currently in use SwapChain.
          * @return The handle of the currently in use SwapChain.
@@ -144,12 +364,190 @@ namespace EOS
         */
         virtual EOS::Holder<EOS::ShaderModuleHandle> CreateShaderModule(const EOS::ShaderInfo& shaderInfo) = 0;
 
+        /**
+        * @brief Gets a sampler for the description, samplers with the same description are shared and stay alive until their last Holder is gone.
+        * @param samplerDescription The description of the sampler, the anisotropy and lod bias overrides of the ContextConfiguration get applied to it.
+        * @return A Holder Handle to the sampler, its index is the slot of the sampler in the bindless samplers.
+        */
+        [[nodiscard]] virtual EOS::Holder<EOS::SamplerHandle> CreateSampler(const EOS::SamplerDescription& samplerDescription) = 0;
+
+        /**
+        * @brief Creates a compute pipeline without blocking. A pipeline that is in the pipeline cache is ready right away, otherwise it gets compiled on a worker thread.
+        * @param computePipelineDescription The compute shader of the pipeline.
+        * @return A Holder Handle to the pipeline, it can only be used once IsPipelineReady() returns true.
+        */
+        [[nodiscard]] virtual EOS::Holder<EOS::ComputePipelineHandle> CreateComputePipeline(const EOS::ComputePipelineDescription& computePipelineDescription) = 0;
+
+        /**
+        * @brief Creates a render pipeline without blocking. A pipeline that is in the pipeline cache is ready right away, otherwise it gets compiled on a worker thread.
+        * @param renderPipelineDescription The shaders, fixed function state and attachment formats of the pipeline.
+        * @return A Holder Handle to the pipeline, it can only be used once IsPipelineReady() returns true.
+        */
+        [[nodiscard]] virtual EOS::Holder<EOS::RenderPipelineHandle> CreateRenderPipeline(const EOS::RenderPipelineDescription& renderPipelineDescription) = 0;
+
+        /**
+        * @brief Creates a render pipeline that renders into attachments like the ones of the framebuffer.
+        * @param renderPipelineDescription The shaders and fixed function state of the pipeline, its attachment formats and number of samples are ignored.
+        * @param framebuffer The attachment formats and number of samples are taken from its textures.
+        * @return A Holder Handle to the pipeline, it can only be used once IsPipelineReady() returns true.
+        */
+        [[nodiscard]] virtual EOS::Holder<EOS::RenderPipelineHandle> CreateRenderPipeline(const EOS::RenderPipelineDescription& renderPipelineDescription, const EOS::Framebuffer& framebuffer) = 0;
+
+        /**
+        * @brief Whether the pipeline is done compiling, while it isn't a fallback pipeline can be used instead.
+        */
+        [[nodiscard]] virtual bool IsPipelineReady(ComputePipelineHandle handle) = 0;
+        [[nodiscard]] virtual bool IsPipelineReady(RenderPipelineHandle handle) = 0;
+
+        /**
+        * @brief Whether shader modules can be rendered with through cmdBindShaders without creating render pipelines.
+        * This is only the case when ContextConfiguration::UseShaderObjects is set and the device supports shader objects.
+        */
+        [[nodiscard]] virtual bool HasShaderObjects() const = 0;
+
+        /**
+        * @brief Creates a texture, its memory is sub-allocated from bigger memory blocks.
+        * @param textureDescription The type, size, format and usage of the texture.
+        * @return A Holder Handle to the texture.
+        */
+        virtual EOS::Holder<EOS::TextureHandle> CreateTexture(const EOS::TextureDescription& textureDescription) = 0;
+
+        /**
+        * @brief Creates a buffer, every buffer can be accessed in shaders through its GPU address without the need of a descriptor.
+        * @param bufferDescription The size, usage and storage of the buffer and optionally the data it should be filled with.
+        * @return A Holder Handle to the buffer.
+        */
+        virtual EOS::Holder<EOS::BufferHandle> CreateBuffer(const EOS::BufferDescription& bufferDescription) = 0;
+
+        /**
+        * @brief Gets the CPU pointer to the memory of a buffer, only HostVisible buffers are mapped.
+        * @param handle The buffer we want the pointer of.
+        * @return The persistently mapped pointer, nullptr when the buffer is not mapped.
+        */
+        [[nodiscard]] virtual uint8_t* GetMappedPtr(BufferHandle handle) const = 0;
+
+        /**
+        * @brief Gets the GPU address of a buffer, it stays the same for the lifetime of the buffer.
+        * @param handle The buffer we want the address of.
+        * @return The address that can be passed to shaders, for example through push constants.
+        */
+        [[nodiscard]] virtual uint64_t GetGPUAddress(BufferHandle handle) const = 0;
+
+        /**
+        * @brief Makes CPU writes to the mapped memory visible to the GPU, this does nothing when the memory is host coherent.
+        * @param handle The buffer we have written to.
+        * @param offset The offset in bytes of the written range.
+        * @param size The size in bytes of the written range.
+        */
+        virtual void FlushMappedMemory(BufferHandle handle, size_t offset, size_t size) const = 0;
+
+        /**
+        * @brief Allocates memory from the upload ring, used for data that changes every frame like constants or instance data.
+        * The memory gets reused once the GPU has finished the submit that follows the allocation, so it never has to be freed.
+        * @param size The amount of bytes needed, this can't be more than ContextConfiguration::UploadRingFrameSize.
+        * @param alignment The alignment of the allocation, must be a power of 2.
+        * @return The allocation, it is not valid when the frame has run out of upload memory.
+        */
+        [[nodiscard]] virtual UploadAllocation AllocateUpload(uint64_t size, uint64_t alignment = 16) = 0;
+
+        /**
+        * @brief Uploads data to a buffer. On devices where the buffer memory is host visible it is written directly,
+        * otherwise it is copied through a staging buffer in a submit that is ordered before the next submit.
+        * @param handle The buffer we want to upload to.
+        * @param data The data to upload.
+        * @param size The size of the data in bytes.
+        * @param offset The offset in the buffer in bytes.
+        * @note A direct write happens immediately, the range should not be in use by the GPU.
+        */
+        virtual void Upload(BufferHandle handle, const void* data, size_t size, size_t offset = 0) = 0;
+
+        /**
+        * @brief Uploads the tightly packed texels of 1 mip level of 1 layer of a texture through a staging buffer.
+        * Sampled textures are left in the ShaderResource state afterwards, others in the CopyDest state.
+        * @param handle The texture we want to upload to.
+        * @param data The texels to upload.
+        * @param mipLevel The mip level to upload to.
+        * @param arrayLayer The array layer to upload to.
+        */
+        virtual void Upload(TextureHandle handle, const void* data, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) = 0;
+
+        /**
+        * @brief Uploads the tightly packed texels of 1 mip level of 1 layer of a texture on a worker thread.
+        * When the device supports host image copy the texels are copied straight into the texture by the CPU, without staging memory or a submit.
+        * This is only done for the first upload to a subresource, the GPU might still read a subresource that was uploaded before.
+        * Otherwise this falls back to Upload() on the calling thread and the returned future is ready immediately.
+        * @param handle The texture we want to upload to.
+        * @param data The texels to upload, they have to stay alive until the returned future is ready.
+        * @param mipLevel The mip level to upload to.
+        * @param arrayLayer The array layer to upload to.
+        * @return A future that is ready once the texels are in the texture, the texture should not be used by the GPU before that.
+        */
+        [[nodiscard]] virtual std::future<void> UploadAsync(TextureHandle handle, const void* data, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) = 0;
+
+        /**
+        * @brief Gets the memory usage per category and the usage and budget of every memory heap, the heaps are updated once per submit.
+        */
+        [[nodiscard]] virtual MemoryStatistics GetMemoryStatistics() const = 0;
+
+        /**
+        * @brief Adds a callback that frees memory when the usage of a device local heap gets close to its budget, checked once per submit.
+        * @param callback The callback, callbacks are called in the order they were added until enough memory is freed.
+        * @return An id to remove the callback with.
+        */
+        virtual uint32_t AddEvictionCallback(EvictionCallback callback) = 0;
+
+        virtual void RemoveEvictionCallback(uint32_t id) = 0;
+
+        /**
+        * @brief Starts moving textures closer together in device memory so fragmented memory blocks can be freed.
+        * The work is spread over the next submits, each submit moves at most ContextConfiguration::DefragmentationBytesPerFrame.
+        * Handles stay valid while their texture is moved. Buffers are never moved, so their GPU addresses stay valid.
+        * Attachments and storage textures are never moved either, frames in flight would miss the writes to their new image.
+        */
+        virtual void Defragment() = 0;
+
+        [[nodiscard]] virtual bool IsDefragmenting() const = 0;
+
+        /**
+        * @brief Gets the memory a texture would need, without creating it.
+        * @param textureDescription The description the texture would be created with.
+        */
+        [[nodiscard]] virtual MemoryRequirements GetMemoryRequirements(const TextureDescription& textureDescription) const = 0;
+
+        /**
+        * @brief Allocates a block of device memory that textures with non overlapping lifetimes can be placed in, for example the transient textures of a RenderGraph.
+        * @param requirements The size, alignment and memory types of the block, RenderGraph::GetTransientMemoryRequirements() gives these for the transient textures.
+        * @param debugName The name of the memory, used for debugging.
+        */
+        [[nodiscard]] virtual Holder<TransientMemoryHandle> CreateTransientMemory(const MemoryRequirements& requirements, const char* debugName = "") = 0;
+
+        /**
+        * @brief Creates a texture in a part of transient memory, it doesn't own the memory so other textures can alias it.
+        * @param textureDescription The texture to create, its storage has to be Device.
+        * @param memory The memory the texture gets placed in.
+        * @param offset The offset in bytes in the memory, it has to respect the alignment of GetMemoryRequirements().
+        * @return A Holder Handle to the texture, its content is undefined every time it is used after an other texture used the same memory.
+        */
+        [[nodiscard]] virtual Holder<TextureHandle> CreateAliasedTexture(const TextureDescription& textureDescription, TransientMemoryHandle memory, uint64_t offset) = 0;
+
         /**
         * @brief Handles the destruction of a TextureHandle and what it holds.
         * @param handle The handle to the texture you want to destroy.
         */
         virtual void Destroy(TextureHandle handle) = 0;
 
+        /**
+        * @brief Handles the destruction of a BufferHandle and what it holds.
+        * @param handle The handle to the buffer you want to destroy.
+        */
+        virtual void Destroy(BufferHandle handle) = 0;
+
+        /**
+        * @brief Handles the destruction of a TransientMemoryHandle, the textures that were placed in it have to be destroyed first.
+        * @param handle The handle to the memory you want to destroy.
+        */
+        virtual void Destroy(TransientMemoryHandle handle) = 0;
+
 
         /**
         * @brief Handles the destruction of a ShaderModuleHandle and what it holds.
@@ -157,6 +555,24 @@ namespace EOS
         */
         virtual void Destroy(ShaderModuleHandle handle) = 0;
 
+        /**
+        * @brief Releases 1 reference to a sampler, it gets destroyed when no Holder of it is left.
+        * @param handle The handle to the sampler you want to release.
+        */
+        virtual void Destroy(SamplerHandle handle) = 0;
+
+        /**
+        * @brief Handles the destruction of a ComputePipelineHandle, waits for the pipeline when it is still compiling.
+        * @param handle The handle to the pipeline you want to destroy.
+        */
+        virtual void Destroy(ComputePipelineHandle handle) = 0;
+
+        /**
+        * @brief Handles the destruction of a RenderPipelineHandle, waits for the pipeline when it is still compiling.
+        * @param handle The handle to the pipeline you want to destroy.
+        */
+        virtual void Destroy(RenderPipelineHandle handle) = 0;
+
     protected:
         IContext() = default;
     };
@@ -260,6 +676,13 @@ namespace EOS
     */
     std::unique_ptr<IContext> CreateContextWithSwapChain(const ContextCreationDescription& contextCreationDescription);
 
+    /**
+    * @brief Creates a context for the used Graphics API without a window or SwapChain, for example to render offscreen or on a software device.
+    * @param contextCreationDescription The settings with which we want to create our Context, its window and display are ignored.
+    * @returns A unique pointer to the created Context interface.
+    */
+    std::unique_ptr<IContext> CreateHeadlessContext(const ContextCreationDescription& contextCreationDescription);
+
     /**
     * @brief Creates a ShaderCompiler.
     * @param shaderFolder The folder where our non-compiled shaders are stored.
@@ -273,8 +696,169 @@ namespace EOS
 /**
 * @brief Inserts a pipeline barrier in the commandbuffer.
 * @param commandBuffer The commandbuffer we want to insert the barrier into.
-* @param globalBarriers The globalBarriers we want to insert used for Buffer barriers.
+* @param globalBarriers The globalBarriers we want to insert, when they hold a Buffer only its byte range is synchronized.
 * @param imageBarriers The imageBarriers we want to insert
+* @note The barriers are gathered in fixed size storage in the commandbuffer and merged where possible,
+*       they get recorded before the next dispatch, copy or cmdBeginRendering. No heap allocations are done while recording.
+*/
+void cmdPipelineBarrier(const EOS::ICommandBuffer& commandBuffer, std::span<const EOS::GlobalBarrier> globalBarriers, std::span<const EOS::ImageBarrier> imageBarriers);
+
+/**
+* @brief Transitions a texture to the next state. The current state of every texture is tracked, so only the barriers that are actually needed get recorded.
+* @param commandBuffer The commandbuffer we want to record the transition into.
+* @param texture The texture we want to transition.
+* @param nextState The state the texture will be used in next.
+* @param range The mip levels and array layers we want to transition, the state of each of them is tracked separately.
+*/
+void cmdTransition(const EOS::ICommandBuffer& commandBuffer, EOS::TextureHandle texture, EOS::ResourceState nextState, const EOS::SubresourceRange& range = {});
+
+/**
+* @brief Transitions a whole buffer to the next state. The state of every buffer is tracked, so only the barriers that are actually needed get recorded.
+* @param commandBuffer The commandbuffer we want to record the transition into.
+* @param buffer The buffer we want to transition.
+* @param nextState The state the buffer will be used in next.
+* @note Barriers through cmdPipelineBarrier that only cover a part of a buffer don't change its tracked state.
+*/
+void cmdTransition(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, EOS::ResourceState nextState);
+
+/**
+* @brief Starts a split transition of a texture, the transition can happen while the GPU works on the commands recorded between the signal and the wait.
+* @param commandBuffer The commandbuffer we want to record the signal into.
+* @param texture The texture we want to transition, it can't be used until cmdWaitTransition has been recorded.
+* @param nextState The state the texture will be used in after the wait.
+* @param range The mip levels and array layers we want to transition, they all need to be in the same state.
+* @return A handle that needs to be passed to cmdWaitTransition, it is empty when no transition was needed.
+*/
+[[nodiscard]] EOS::SplitBarrierHandle cmdSignalTransition(const EOS::ICommandBuffer& commandBuffer, EOS::TextureHandle texture, EOS::ResourceState nextState, const EOS::SubresourceRange& range = {});
+
+/**
+* @brief Waits until the split transition started by cmdSignalTransition is done, every split transition needs to be waited on exactly once in the same commandbuffer.
+* @param commandBuffer The commandbuffer we want to record the wait into.
+* @param splitBarrier The handle returned by cmdSignalTransition.
+*/
+void cmdWaitTransition(const EOS::ICommandBuffer& commandBuffer, EOS::SplitBarrierHandle splitBarrier);
+
+/**
+* @brief Binds the shaders of the description without a pipeline and sets all of its fixed function state dynamically, only possible when IContext::HasShaderObjects().
+* Any combination of shaders and state can be drawn with right away, nothing gets compiled.
+* @param commandBuffer The commandbuffer we want to bind the shaders in.
+* @param description The shaders and state to draw with, its attachment formats are only used for the number of attachments.
+*/
+void cmdBindShaders(const EOS::ICommandBuffer& commandBuffer, const EOS::RenderPipelineDescription& description);
+
+/**
+* @brief Binds a compute pipeline for the dispatches that follow, the bindless resources are bound along with it.
+* @param commandBuffer The commandbuffer we want to bind the pipeline in.
+* @param pipeline The pipeline we want to bind, it has to be ready, see IContext::IsPipelineReady().
+*/
+void cmdBindComputePipeline(const EOS::ICommandBuffer& commandBuffer, EOS::ComputePipelineHandle pipeline);
+
+/**
+* @brief Sets push constants for all shader stages, every pipeline has the same push constant range.
+* @param commandBuffer The commandbuffer we want to set the push constants in.
+* @param data The bytes we want to set.
+* @param size The amount of bytes, offset + size can't go over the push constant range of the device (at most 256 bytes).
+* @param offset The byte in the push constant range where the data starts.
+*/
+void cmdPushConstants(const EOS::ICommandBuffer& commandBuffer, const void* data, uint32_t size, uint32_t offset = 0);
+
+/**
+* @brief Dispatches the bound compute pipeline, the pending barriers are recorded before it.
+* @param commandBuffer The commandbuffer we want to record the dispatch into.
+* @param numGroupsX The number of workgroups in X, the size of a workgroup is set in the shader.
+* @param numGroupsY The number of workgroups in Y.
+* @param numGroupsZ The number of workgroups in Z.
+*/
+void cmdDispatch(const EOS::ICommandBuffer& commandBuffer, uint32_t numGroupsX, uint32_t numGroupsY = 1, uint32_t numGroupsZ = 1);
+
+/**
+* @brief Dispatches the bound compute pipeline with the number of workgroups read from a buffer by the GPU, the pending barriers are recorded before it.
+* @param commandBuffer The commandbuffer we want to record the dispatch into.
+* @param buffer An Indirect buffer that holds 3 uint32_t's with the number of workgroups in X, Y and Z.
+* @param offset The byte in the buffer where the workgroup counts start.
+*/
+void cmdDispatchIndirect(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, uint64_t offset = 0);
+
+/**
+* @brief Starts rendering into the attachments of the framebuffer, they are transitioned to be rendered into and the pending barriers are recorded before it.
+* The viewport and scissor cover the whole framebuffer.
+* @param commandBuffer The commandbuffer we want to record the rendering into.
+* @param framebuffer The attachments and what happens with their content at the start and end of the rendering.
+*/
+void cmdBeginRendering(const EOS::ICommandBuffer& commandBuffer, const EOS::Framebuffer& framebuffer);
+
+/**
+* @brief Ends the rendering started by cmdBeginRendering, the attachments get stored and resolved as their store ops say.
+* @param commandBuffer The commandbuffer we want to record the end of the rendering into.
+*/
+void cmdEndRendering(const EOS::ICommandBuffer& commandBuffer);
+
+/**
+* @brief Binds a render pipeline for the draws that follow, the bindless resources are bound along with it.
+* @param commandBuffer The commandbuffer we want to bind the pipeline in.
+* @param pipeline The pipeline we want to bind, it has to be ready, see IContext::IsPipelineReady().
+*/
+void cmdBindRenderPipeline(const EOS::ICommandBuffer& commandBuffer, EOS::RenderPipelineHandle pipeline);
+
+/**
+* @brief Binds the index buffer for the indexed draws that follow.
+* @param commandBuffer The commandbuffer we want to bind the index buffer in.
+* @param buffer A buffer with the Index usage.
+* @param indexFormat The size of each index.
+* @param offset The byte in the buffer where the indices start.
+*/
+void cmdBindIndexBuffer(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, EOS::IndexFormat indexFormat, uint64_t offset = 0);
+
+/**
+* @brief Draws with the bound render pipeline, it can only be recorded between cmdBeginRendering and cmdEndRendering.
+* @param commandBuffer The commandbuffer we want to record the draw into.
+* @param numVertices The number of vertices, the vertex shader pulls them from buffers with SV_VertexID.
+* @param numInstances The number of instances.
+* @param firstVertex The first SV_VertexID.
+* @param firstInstance The first SV_InstanceID.
+*/
+void cmdDraw(const EOS::ICommandBuffer& commandBuffer, uint32_t numVertices, uint32_t numInstances = 1, uint32_t firstVertex = 0, uint32_t firstInstance = 0);
+
+/**
+* @brief Draws with the bound render pipeline and index buffer, it can only be recorded between cmdBeginRendering and cmdEndRendering.
+* @param commandBuffer The commandbuffer we want to record the draw into.
+* @param numIndices The number of indices.
+* @param numInstances The number of instances.
+* @param firstIndex The first index in the index buffer.
+* @param vertexOffset Gets added to every index before it becomes the SV_VertexID.
+* @param firstInstance The first SV_InstanceID.
+*/
+void cmdDrawIndexed(const EOS::ICommandBuffer& commandBuffer, uint32_t numIndices, uint32_t numInstances = 1, uint32_t firstIndex = 0, int32_t vertexOffset = 0, uint32_t firstInstance = 0);
+
+/**
+* @brief Draws with the bound render pipeline, the draws are read from a buffer by the GPU.
+* @param commandBuffer The commandbuffer we want to record the draws into.
+* @param buffer An Indirect buffer that holds VkDrawIndirectCommand's (4 uint32_t's: numVertices, numInstances, firstVertex, firstInstance).
+* @param offset The byte in the buffer where the first draw starts.
+* @param numDraws The number of draws.
+* @param stride The bytes between 2 draws, 0 means they are tightly packed.
+*/
+void cmdDrawIndirect(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, uint64_t offset, uint32_t numDraws, uint32_t stride = 0);
+
+/**
+* @brief Draws with the bound render pipeline and index buffer, the draws are read from a buffer by the GPU.
+* @param commandBuffer The commandbuffer we want to record the draws into.
+* @param buffer An Indirect buffer that holds VkDrawIndexedIndirectCommand's (numIndices, numInstances, firstIndex, vertexOffset, firstInstance).
+* @param offset The byte in the buffer where the first draw starts.
+* @param numDraws The number of draws.
+* @param stride The bytes between 2 draws, 0 means they are tightly packed.
+*/
+void cmdDrawIndexedIndirect(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, uint64_t offset, uint32_t numDraws, uint32_t stride = 0);
+
+/**
+* @brief Copies the texels of 1 mip level and array layer of a texture into a buffer, tightly packed row after row, for example to read back what was rendered.
+* The buffer can be read through IContext::GetMappedPtr() once IContext::Wait() returned for the submission.
+* @param commandBuffer The commandbuffer we want to record the copy into, it can't be recorded between cmdBeginRendering and cmdEndRendering.
+* @param texture The texture we want to copy from, it is transitioned to CopySource.
+* @param buffer The buffer we want to copy into, it is transitioned to CopyDest.
+* @param bufferOffset The byte in the buffer where the first texel is written.
+* @param mipLevel The mip level we want to copy.
+* @param arrayLayer The array layer we want to copy.
 */
-void cmdPipelineBarrier(const EOS::ICommandBuffer& commandBuffer, const std::vector<EOS::GlobalBarrier>& globalBarriers, const std::vector<EOS::ImageBarrier>& imageBarriers);
+void cmdCopyTextureToBuffer(const EOS::ICommandBuffer& commandBuffer, EOS::TextureHandle texture, EOS::BufferHandle buffer, uint64_t bufferOffset = 0, uint32_t mipLevel = 0, uint32_t arrayLayer = 0);
 #pragma endregion
\ No newline at end of file
@@ -27,6 +27,158 @@ namespace EOS
         SwapChain       = 7,
     };
 
+    enum class Format : uint8_t
+    {
+        Invalid = 0,
+
+        R_UN8,
+        RG_UN8,
+        RGBA_UN8,
+        BGRA_UN8,
+        RGBA_SRGB8,
+        BGRA_SRGB8,
+
+        R_F16,
+        RG_F16,
+        RGBA_F16,
+
+        R_F32,
+        RG_F32,
+        RGBA_F32,
+
+        R_UI32,
+        RGB10_A2_UN,
+
+        Z_UN16,
+        Z_UN24,
+        Z_F32,
+        Z_UN24_S_UI8,
+        Z_F32_S_UI8,
+    };
+
+    enum TextureUsageFlags : uint8_t
+    {
+        Sampled     = 1 << 0,
+        Storage     = 1 << 1,
+        Attachment  = 1 << 2,
+    };
+
+    enum BufferUsageFlags : uint8_t
+    {
+        Index           = 1 << 0,
+        Vertex          = 1 << 1,
+        Uniform         = 1 << 2,
+        StorageBuffer   = 1 << 3,
+        Indirect        = 1 << 4,
+    };
+
+    enum class StorageType : uint8_t
+    {
+        Device,         // Only accessible by the GPU
+        HostVisible,    // Persistently mapped, accessible by both the CPU and the GPU
+        Memoryless,     // Only for attachments whose content is not needed after the render pass, on tiled GPUs it never leaves tile memory
+    };
+
+    enum class SamplerFilter : uint8_t
+    {
+        Nearest,
+        Linear,
+    };
+
+    enum class SamplerMipMap : uint8_t
+    {
+        Disabled,       // only the first mip level is sampled
+        Nearest,
+        Linear,
+    };
+
+    enum class SamplerWrap : uint8_t
+    {
+        Repeat,
+        Clamp,
+        MirrorRepeat,
+        ClampToBorder,  // the border is transparent black
+    };
+
+    enum class CompareOp : uint8_t
+    {
+        Never,
+        Less,
+        Equal,
+        LessEqual,
+        Greater,
+        NotEqual,
+        GreaterEqual,
+        AlwaysPass,
+    };
+
+    enum class Topology : uint8_t
+    {
+        Point,
+        Line,
+        LineStrip,
+        Triangle,
+        TriangleStrip,
+    };
+
+    enum class PolygonMode : uint8_t
+    {
+        Fill,
+        Line,
+    };
+
+    enum class CullMode : uint8_t
+    {
+        None,
+        Front,
+        Back,
+    };
+
+    enum class WindingMode : uint8_t
+    {
+        CounterClockWise,
+        ClockWise,
+    };
+
+    enum class BlendMode : uint8_t
+    {
+        Opaque,
+        AlphaBlend,         // src * srcAlpha + dst * (1 - srcAlpha)
+        Premultiplied,      // src + dst * (1 - srcAlpha)
+        Additive,           // src + dst
+    };
+
+    //What happens with the content of an attachment when rendering starts
+    enum class LoadOp : uint8_t
+    {
+        Load,               // keep what is in it, on tiled GPUs it has to be read back into tile memory
+        Clear,
+        DontCare,           // the content is undefined, use it when every pixel gets overwritten anyway
+    };
+
+    //What happens with the content of an attachment when rendering ends
+    enum class StoreOp : uint8_t
+    {
+        Store,
+        DontCare,           // the content is not needed afterwards, on tiled GPUs it never gets written to memory
+    };
+
+    enum class IndexFormat : uint8_t
+    {
+        UI16,
+        UI32,
+    };
+
+    //What device memory is used for, the memory budget keeps track of the usage per category
+    enum class MemoryCategory : uint8_t
+    {
+        Texture,
+        Buffer,
+        Transient,      // Memory of render graph resources that only live for a part of the frame
+        Staging,        // Memory the CPU writes to so it can be copied to device memory
+        Count,
+    };
+
     enum ResourceState : uint32_t
     {
         Undefined = 0,
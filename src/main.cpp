@@ -20,6 +20,31 @@ int main()
     std::unique_ptr<EOS::IContext> context = EOS::CreateContextWithSwapChain(contextDescr);
     std::unique_ptr<EOS::ShaderCompiler> shaderCompiler = EOS::CreateShaderCompiler("./");
     EOS::Holder<EOS::ShaderModuleHandle> shaderHandle = EOS::LoadShader(context, shaderCompiler, "test");
+    EOS::Holder<EOS::ShaderModuleHandle> vertexShader = EOS::LoadShader(context, shaderCompiler, "triangleVertex");
+    EOS::Holder<EOS::ShaderModuleHandle> fragmentShader = EOS::LoadShader(context, shaderCompiler, "triangleFragment");
+
+    //The formats of the pipeline come from the SwapChain texture it renders into
+    EOS::Framebuffer framebuffer{};
+    framebuffer.ColorAttachments[0] = { .Texture = context->GetSwapChainTexture(), .Load = EOS::LoadOp::Clear, .Store = EOS::StoreOp::Store, .ClearColor = { 0.1f, 0.1f, 0.1f, 1.0f } };
+    EOS::Holder<EOS::RenderPipelineHandle> trianglePipeline = context->CreateRenderPipeline({ .VertexShader = vertexShader, .FragmentShader = fragmentShader, .Culling = EOS::CullMode::None, .DebugName = "Triangle" }, framebuffer);
+
+    EOS::Holder<EOS::ComputePipelineHandle> computePipeline = context->CreateComputePipeline({ .ComputeShader = shaderHandle, .DebugName = "Test" });
+
+    constexpr uint32_t count = 256;
+    const std::vector<float> values(count, 1.0f);
+    const EOS::BufferDescription bufferDescription{ .Usage = EOS::BufferUsageFlags::StorageBuffer, .Size = count * sizeof(float), .Data = values.data(), .DebugName = "Test" };
+    EOS::Holder<EOS::BufferHandle> buffer0 = context->CreateBuffer(bufferDescription);
+    EOS::Holder<EOS::BufferHandle> buffer1 = context->CreateBuffer(bufferDescription);
+    EOS::Holder<EOS::BufferHandle> result = context->CreateBuffer(bufferDescription);
+
+    //Matches the uniform parameters of the test shader
+    struct
+    {
+        uint64_t Buffer0;
+        uint64_t Buffer1;
+        uint64_t Result;
+        uint32_t Count;
+    } pushConstants{ context->GetGPUAddress(buffer0), context->GetGPUAddress(buffer1), context->GetGPUAddress(result), count };
 
     while (!glfwWindowShouldClose(window))
     {
@@ -27,7 +52,23 @@ int main()
 
         EOS::ICommandBuffer& cmdBuffer = context->AcquireCommandBuffer();
 
-        cmdPipelineBarrier(cmdBuffer, {}, {{context->GetSwapChainTexture(), EOS::ResourceState::Undefined, EOS::ResourceState::Present}});
+        if (context->IsPipelineReady(computePipeline))
+        {
+            cmdBindComputePipeline(cmdBuffer, computePipeline);
+            cmdPushConstants(cmdBuffer, &pushConstants, sizeof(pushConstants));
+            cmdDispatch(cmdBuffer, count / 64);
+        }
+
+        if (context->IsPipelineReady(trianglePipeline))
+        {
+            framebuffer.ColorAttachments[0].Texture = context->GetSwapChainTexture();
+            cmdBeginRendering(cmdBuffer, framebuffer);
+            cmdBindRenderPipeline(cmdBuffer, trianglePipeline);
+            cmdDraw(cmdBuffer, 3);
+            cmdEndRendering(cmdBuffer);
+        }
+
+        cmdTransition(cmdBuffer, context->GetSwapChainTexture(), EOS::ResourceState::Present);
 
         context->Submit(cmdBuffer, context->GetSwapChainTexture());
     }
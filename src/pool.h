@@ -23,12 +23,13 @@ namespace EOS
     private:
         struct PoolEntry
         {
-            explicit PoolEntry(ObjectType_Impl& object)
-            : Object(std::move(object)) {}
+            PoolEntry(ObjectType_Impl& object, uint32_t generation)
+            : Object(std::move(object)), Generation(generation) {}
 
             ObjectType_Impl Object{};
             uint32_t Generation     = 1;
             uint32_t NextFree       = ListEnd;
+            bool IsAlive            = true;
         };
 
     public:
@@ -46,6 +47,12 @@ namespace EOS
         //Destroy the given object
         void Destroy(Handle<ObjectType> handle);
 
+        //Destroy the given object, but keep its index out of the free list until the returned handle is released.
+        //For objects that are still referred to by their index after they are destroyed, like the bindless slots the GPU reads.
+        //Releasing after the pool was cleared does nothing, also when the index has been created again since.
+        [[nodiscard]] Handle<ObjectType> Retire(Handle<ObjectType> handle);
+        void Release(Handle<ObjectType> retired);
+
         //Get the given implementation
         [[nodiscard]] ObjectType_Impl* Get(const Handle<ObjectType> handle);
         [[nodiscard]] const ObjectType_Impl* Get(const Handle<ObjectType> handle) const;
@@ -56,6 +63,10 @@ namespace EOS
         //search for the handle of the object based on the pointer
         [[nodiscard]] Handle<ObjectType> FindObject(const ObjectType_Impl* object);
 
+        //Call the function with the handle and object of every object that is still alive in the pool, destroying the current object is allowed
+        template<typename Function>
+        void ForEach(Function&& function);
+
         //Clear the pool. All handles to objects become stale
         void Clear();
 
@@ -74,6 +85,7 @@ namespace EOS
         uint32_t FreeListHead = ListEnd;
         uint32_t FreeList{};
         uint32_t NumberOfObjects{};
+        uint32_t FirstGeneration = 1;   // above every generation from before the last Clear, so their handles stay stale
     };
 
 
@@ -94,6 +106,7 @@ namespace EOS
             index = FreeListHead;
             FreeListHead = Objects[index].NextFree;
             Objects[index].Object = std::move(object);
+            Objects[index].IsAlive = true;
         }
 
         //Else if the pool doesn't have a free slot
@@ -104,7 +117,7 @@ namespace EOS
             size_t oldCapacity = Objects.capacity();
 #endif
             index = static_cast<uint32_t>(Objects.size());
-            Objects.emplace_back(object);
+            Objects.emplace_back(object, FirstGeneration);
 
 
 
@@ -143,6 +156,7 @@ namespace EOS
             const uint32_t index = FreeListHead;
             FreeListHead = Objects[index].NextFree;
             Objects[index].Object = std::move(*first++);
+            Objects[index].IsAlive = true;
             handles.emplace_back(Handle<ObjectType>(index, Objects[index].Generation));
             ++NumberOfObjects;
             ++reused;
@@ -157,7 +171,7 @@ namespace EOS
 
             for (size_t i{}; i < remaining; ++i, ++first)
             {
-                Objects.emplace_back(PoolEntry(std::move(*first)));
+                Objects.emplace_back(PoolEntry(std::move(*first), FirstGeneration));
                 handles.emplace_back(Handle<ObjectType>(static_cast<uint32_t>(currentSize + i),Objects[currentSize + i].Generation));
                 ++NumberOfObjects;
             }
@@ -171,6 +185,14 @@ namespace EOS
     {
         if (handle.Empty()) { return; }
 
+        Release(Retire(handle));
+    }
+
+    template<typename ObjectType, typename ObjectType_Impl>
+    Handle<ObjectType> Pool<ObjectType, ObjectType_Impl>::Retire(Handle<ObjectType> handle)
+    {
+        if (handle.Empty()) { return {}; }
+
         // (this one could already be deleted)
         CHECK(NumberOfObjects > 0, "There are no objects left in the pool");
 
@@ -182,18 +204,33 @@ namespace EOS
 
         //Reset to a default state
         Objects[index].Object = ObjectType_Impl{};
+        Objects[index].IsAlive = false;
 
         //Increase the amount it has been reused (generation)
         ++Objects[index].Generation;
 
+        //reduce the number of in use objects
+        --NumberOfObjects;
+
+        return Handle<ObjectType>(index, Objects[index].Generation);
+    }
+
+    template<typename ObjectType, typename ObjectType_Impl>
+    void Pool<ObjectType, ObjectType_Impl>::Release(const Handle<ObjectType> retired)
+    {
+        if (retired.Empty()) { return; }
+
+        //The pool was cleared in the meantime, the index might not exist or hold an object that was created after the clear
+        const uint32_t index = retired.Index();
+        if (index >= Objects.size() || Objects[index].Generation != retired.Gen()) { return; }
+
+        CHECK(!Objects[index].IsAlive, "Only retired objects can be released");
+
         //Update the next free pool object in this object
         Objects[index].NextFree = FreeListHead;
 
         //markt this object as free
         FreeListHead = index;
-
-        //reduce the number of in use objects
-        --NumberOfObjects;
     }
 
     template<typename ObjectType, typename ObjectType_Impl>
@@ -249,9 +286,27 @@ namespace EOS
         return {};
     }
 
+    template<typename ObjectType, typename ObjectType_Impl>
+    template<typename Function>
+    void Pool<ObjectType, ObjectType_Impl>::ForEach(Function&& function)
+    {
+        for (size_t idx{}; idx != Objects.size(); ++idx)
+        {
+            if (Objects[idx].IsAlive)
+            {
+                function(Handle<ObjectType>(static_cast<uint32_t>(idx), Objects[idx].Generation), Objects[idx].Object);
+            }
+        }
+    }
+
     template<typename ObjectType, typename ObjectType_Impl>
     void Pool<ObjectType, ObjectType_Impl>::Clear()
     {
+        for (const PoolEntry& entry : Objects)
+        {
+            FirstGeneration = std::max(FirstGeneration, entry.Generation + 1);
+        }
+
         Objects.clear();
         FreeListHead = ListEnd;
         NumberOfObjects = 0;
@@ -0,0 +1,503 @@
+#include "renderGraph.h"
+
+#include <algorithm>
+
+#include "logger.h"
+#include "utils.h"
+
+namespace EOS
+{
+    namespace
+    {
+        constexpr uint32_t NoPass = 0xFFFFFFFF;
+
+        [[nodiscard]] bool IsWriteState(const ResourceState state)
+        {
+            constexpr uint32_t writeStates = RenderTarget | UnorderedAccess | UnorderedAccessPixel | DepthWrite | CopyDest | StreamOut | AccelerationStructureWrite | Common;
+            return (state & writeStates) != 0;
+        }
+
+        //Going from a read only state to one that only waits on the same or fewer stages doesn't need a transition
+        [[nodiscard]] bool NeedsTransition(const ResourceState previousState, const ResourceState nextState)
+        {
+            return IsWriteState(previousState) || IsWriteState(nextState) || (nextState & ~previousState) != 0;
+        }
+
+        [[nodiscard]] bool Overlaps(const uint64_t beginA, const uint64_t endA, const uint64_t beginB, const uint64_t endB)
+        {
+            return beginA < endB && beginB < endA;
+        }
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Read(const RenderGraphResource resource, const ResourceState state)
+    {
+        Graph.AddAccess(PassIndex, resource, state, false);
+        return *this;
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::Write(const RenderGraphResource resource, const ResourceState state)
+    {
+        Graph.AddAccess(PassIndex, resource, state, true);
+        return *this;
+    }
+
+    RenderGraphPassBuilder& RenderGraphPassBuilder::SideEffect()
+    {
+        Graph.Passes[PassIndex].HasSideEffect = true;
+        return *this;
+    }
+
+    RenderGraphResource RenderGraph::ImportTexture(const char* name, const TextureHandle& texture, const ResourceState finalState)
+    {
+        Resources.emplace_back(Resource{ .Name = name, .Type = ResourceType::ImportedTexture, .Texture = texture, .State = finalState });
+        return { static_cast<uint32_t>(Resources.size() - 1) };
+    }
+
+    RenderGraphResource RenderGraph::ImportBuffer(const char* name, const BufferHandle& buffer)
+    {
+        Resources.emplace_back(Resource{ .Name = name, .Type = ResourceType::ImportedBuffer, .Buffer = buffer });
+        return { static_cast<uint32_t>(Resources.size() - 1) };
+    }
+
+    RenderGraphResource RenderGraph::CreateTransientTexture(const char* name, const TransientTextureDescription& description)
+    {
+        CHECK(description.Size > 0 && description.Alignment > 0, "The transient texture {} needs a size and alignment", name);
+        Resources.emplace_back(Resource{ .Name = name, .Type = ResourceType::TransientTexture, .TransientDescription = description });
+        return { static_cast<uint32_t>(Resources.size() - 1) };
+    }
+
+    void RenderGraph::BindTransientTexture(const RenderGraphResource resource, const TextureHandle& texture)
+    {
+        CHECK_RETURN(resource.Index < Resources.size(), "Trying to bind a texture to a resource that is not part of the render graph");
+        CHECK_RETURN(Resources[resource.Index].Type == ResourceType::TransientTexture, "Only transient textures can be bound, {} is imported", Resources[resource.Index].Name);
+
+        Resources[resource.Index].Texture = TextureHandle(texture);
+    }
+
+    RenderGraphPassBuilder RenderGraph::AddPass(const char* name, RenderGraphExecuteCallback callback, const RenderGraphQueue queue)
+    {
+        Passes.emplace_back(Pass{ .Name = name, .Queue = queue, .Callback = std::move(callback) });
+        return { *this, static_cast<uint32_t>(Passes.size() - 1) };
+    }
+
+    void RenderGraph::AddAccess(const uint32_t passIndex, const RenderGraphResource resource, const ResourceState state, const bool isWrite)
+    {
+        CHECK_RETURN(resource.Index < Resources.size(), "The pass {} uses a resource that is not part of the render graph", Passes[passIndex].Name);
+
+        std::vector<Access>& accesses = Passes[passIndex].Accesses;
+        const auto it = std::ranges::find_if(accesses, [resource](const Access& access){ return access.Resource.Index == resource.Index; });
+        if (it != accesses.end())
+        {
+            it->State = static_cast<ResourceState>(it->State | state);
+            it->IsRead |= !isWrite;
+            it->IsWrite |= isWrite;
+            return;
+        }
+
+        accesses.emplace_back(Access{ .Resource = resource, .State = state, .IsRead = !isWrite, .IsWrite = isWrite });
+    }
+
+    uint64_t RenderGraph::HashTopology() const
+    {
+        //The handles of the resources are left out, so a new swapchain texture each frame doesn't trigger a compile
+        uint64_t hash = HashSeed;
+        HashCombine(hash, Resources.size());
+        for (const Resource& resource : Resources)
+        {
+            HashCombine(hash, static_cast<uint64_t>(resource.Type));
+            HashCombine(hash, resource.State);
+            HashCombine(hash, resource.TransientDescription.Size);
+            HashCombine(hash, resource.TransientDescription.Alignment);
+            HashCombine(hash, resource.TransientDescription.MemoryTypeBits);
+        }
+
+        HashCombine(hash, Passes.size());
+        for (const Pass& pass : Passes)
+        {
+            HashCombine(hash, static_cast<uint64_t>(pass.Queue) | (static_cast<uint64_t>(pass.HasSideEffect) << 8));
+            HashCombine(hash, pass.Accesses.size());
+            for (const Access& access : pass.Accesses)
+            {
+                HashCombine(hash, (static_cast<uint64_t>(access.Resource.Index) << 32) | access.State);
+                HashCombine(hash, static_cast<uint64_t>(access.IsRead) | (static_cast<uint64_t>(access.IsWrite) << 1));
+            }
+        }
+
+        return hash;
+    }
+
+    void RenderGraph::Compile()
+    {
+        const uint64_t topologyHash = HashTopology();
+        if (IsCompiled && topologyHash == CompiledTopologyHash) { return; }
+
+        CompiledPasses.assign(Passes.size(), CompiledPass{});
+        CompiledTransients.assign(Resources.size(), CompiledTransient{});
+        FinalTransitions.clear();
+        TransientMemorySize = 0;
+        TransientMemoryAlignment = 1;
+        TransientMemoryTypeBits = 0xFFFFFFFF;
+        TransientFinalState = ResourceState::Undefined;
+
+        CullPasses();
+        PlaceTransientTextures();
+        ComputeTransitions();
+        FindAsyncComputeCandidates();
+
+        CompiledTopologyHash = topologyHash;
+        IsCompiled = true;
+
+        const auto numCulledPasses = std::ranges::count_if(CompiledPasses, [](const CompiledPass& pass){ return pass.IsCulled; });
+        const auto numAsyncComputeCandidates = std::ranges::count_if(CompiledPasses, [](const CompiledPass& pass){ return pass.IsAsyncComputeCandidate; });
+        EOS::Logger->debug("Compiled the render graph, {} of the {} passes are culled, {} are async compute candidates and the transient textures use {} bytes", numCulledPasses, Passes.size(), numAsyncComputeCandidates, TransientMemorySize);
+    }
+
+    void RenderGraph::CullPasses()
+    {
+        //Everything that ends up in an imported resource is needed, walk back from the last pass and keep the passes that write something needed.
+        std::vector<bool> isNeeded(Resources.size(), false);
+        for (uint32_t i{}; i < Resources.size(); ++i)
+        {
+            isNeeded[i] = Resources[i].Type != ResourceType::TransientTexture;
+        }
+
+        for (uint32_t passIndex = static_cast<uint32_t>(Passes.size()); passIndex-- > 0;)
+        {
+            const Pass& pass = Passes[passIndex];
+            const bool isLive = pass.HasSideEffect || std::ranges::any_of(pass.Accesses, [&isNeeded](const Access& access){ return access.IsWrite && isNeeded[access.Resource.Index]; });
+            CompiledPasses[passIndex].IsCulled = !isLive;
+
+            if (!isLive) { continue; }
+            for (const Access& access : pass.Accesses)
+            {
+                if (access.IsRead) { isNeeded[access.Resource.Index] = true; }
+            }
+        }
+    }
+
+    void RenderGraph::PlaceTransientTextures()
+    {
+        std::vector<uint32_t> transients;
+        for (uint32_t passIndex{}; passIndex < Passes.size(); ++passIndex)
+        {
+            if (CompiledPasses[passIndex].IsCulled) { continue; }
+
+            for (const Access& access : Passes[passIndex].Accesses)
+            {
+                if (Resources[access.Resource.Index].Type != ResourceType::TransientTexture) { continue; }
+
+                CompiledTransient& transient = CompiledTransients[access.Resource.Index];
+                if (!transient.IsUsed)
+                {
+                    transient.IsUsed = true;
+                    transient.FirstPass = passIndex;
+                    transients.push_back(access.Resource.Index);
+                }
+                transient.LastPass = passIndex;
+            }
+        }
+
+        //Place the biggest textures first, each texture goes at the lowest offset that doesn't overlap with a placed texture that is alive at the same time.
+        std::ranges::sort(transients, [this](const uint32_t a, const uint32_t b){ return Resources[a].TransientDescription.Size > Resources[b].TransientDescription.Size; });
+
+        std::vector<uint32_t> placed;
+        placed.reserve(transients.size());
+        for (const uint32_t resourceIndex : transients)
+        {
+            const TransientTextureDescription& description = Resources[resourceIndex].TransientDescription;
+            CompiledTransient& transient = CompiledTransients[resourceIndex];
+
+            uint64_t offset = 0;
+            bool hasMoved = true;
+            while (hasMoved)
+            {
+                hasMoved = false;
+                offset = (offset + description.Alignment - 1) / description.Alignment * description.Alignment;
+
+                for (const uint32_t placedIndex : placed)
+                {
+                    const CompiledTransient& other = CompiledTransients[placedIndex];
+                    const uint64_t otherEnd = other.Offset + Resources[placedIndex].TransientDescription.Size;
+
+                    if (Overlaps(transient.FirstPass, transient.LastPass + 1ull, other.FirstPass, other.LastPass + 1ull) && Overlaps(offset, offset + description.Size, other.Offset, otherEnd))
+                    {
+                        offset = otherEnd;
+                        hasMoved = true;
+                    }
+                }
+            }
+
+            transient.Offset = offset;
+            TransientMemorySize = std::max(TransientMemorySize, offset + description.Size);
+            TransientMemoryAlignment = std::max(TransientMemoryAlignment, description.Alignment);
+            TransientMemoryTypeBits &= description.MemoryTypeBits;
+            placed.push_back(resourceIndex);
+        }
+    }
+
+    void RenderGraph::ComputeTransitions()
+    {
+        //The state of imported resources before the graph is unknown to us, their first transition is always recorded and the backend skips it if it isn't needed.
+        std::vector<ResourceState> lastStates(Resources.size(), ResourceState::Undefined);
+        std::vector<bool> isKnown(Resources.size(), false);
+
+        for (uint32_t passIndex{}; passIndex < Passes.size(); ++passIndex)
+        {
+            CompiledPass& compiledPass = CompiledPasses[passIndex];
+            if (compiledPass.IsCulled) { continue; }
+
+            for (const Access& access : Passes[passIndex].Accesses)
+            {
+                const uint32_t resourceIndex = access.Resource.Index;
+                const bool isTransient = Resources[resourceIndex].Type == ResourceType::TransientTexture;
+
+                if (isTransient && CompiledTransients[resourceIndex].FirstPass == passIndex)
+                {
+                    //The memory might still be in use by the textures that lived there before, wait on their last use
+                    const CompiledTransient& transient = CompiledTransients[resourceIndex];
+                    const uint64_t transientEnd = transient.Offset + Resources[resourceIndex].TransientDescription.Size;
+
+                    ResourceState aliasedState = ResourceState::Undefined;
+                    for (uint32_t otherIndex{}; otherIndex < Resources.size(); ++otherIndex)
+                    {
+                        const CompiledTransient& other = CompiledTransients[otherIndex];
+                        if (!other.IsUsed || other.LastPass >= transient.FirstPass) { continue; }
+                        if (!Overlaps(transient.Offset, transientEnd, other.Offset, other.Offset + Resources[otherIndex].TransientDescription.Size)) { continue; }
+
+                        aliasedState = static_cast<ResourceState>(aliasedState | lastStates[otherIndex]);
+                    }
+
+                    compiledPass.Transitions.emplace_back(Transition{ .Resource = access.Resource, .PreviousState = aliasedState, .NextState = access.State, .DiscardContent = true });
+                }
+                else if (!isKnown[resourceIndex] || NeedsTransition(lastStates[resourceIndex], access.State))
+                {
+                    compiledPass.Transitions.emplace_back(Transition{ .Resource = access.Resource, .PreviousState = lastStates[resourceIndex], .NextState = access.State, .DiscardContent = false });
+                }
+
+                lastStates[resourceIndex] = access.State;
+                isKnown[resourceIndex] = true;
+            }
+        }
+
+        for (uint32_t i{}; i < Resources.size(); ++i)
+        {
+            if (CompiledTransients[i].IsUsed)
+            {
+                TransientFinalState = static_cast<ResourceState>(TransientFinalState | lastStates[i]);
+            }
+        }
+
+        for (uint32_t i{}; i < Resources.size(); ++i)
+        {
+            const Resource& resource = Resources[i];
+            if (resource.Type != ResourceType::ImportedTexture || resource.State == ResourceState::Undefined) { continue; }
+            if (isKnown[i] && !NeedsTransition(lastStates[i], resource.State)) { continue; }
+
+            FinalTransitions.emplace_back(Transition{ .Resource = {i}, .PreviousState = lastStates[i], .NextState = resource.State, .DiscardContent = false });
+        }
+    }
+
+    void RenderGraph::FindAsyncComputeCandidates()
+    {
+        //Every pass gets a dependency level, a pass is always on a higher level than the passes it depends on.
+        //A compute pass that shares its level with graphics work can overlap with it on an async compute queue.
+        std::vector<uint32_t> levels(Passes.size(), 0);
+        std::vector<uint32_t> lastWriters(Resources.size(), NoPass);
+        std::vector<std::vector<uint32_t>> readersSinceWrite(Resources.size());
+
+        for (uint32_t passIndex{}; passIndex < Passes.size(); ++passIndex)
+        {
+            if (CompiledPasses[passIndex].IsCulled) { continue; }
+
+            uint32_t level = 0;
+            for (const Access& access : Passes[passIndex].Accesses)
+            {
+                const uint32_t lastWriter = lastWriters[access.Resource.Index];
+                if (lastWriter != NoPass)
+                {
+                    level = std::max(level, levels[lastWriter] + 1);
+                }
+
+                if (access.IsWrite)
+                {
+                    for (const uint32_t reader : readersSinceWrite[access.Resource.Index])
+                    {
+                        level = std::max(level, levels[reader] + 1);
+                    }
+                }
+            }
+            levels[passIndex] = level;
+
+            for (const Access& access : Passes[passIndex].Accesses)
+            {
+                if (access.IsWrite)
+                {
+                    lastWriters[access.Resource.Index] = passIndex;
+                    readersSinceWrite[access.Resource.Index].clear();
+                }
+                else
+                {
+                    readersSinceWrite[access.Resource.Index].push_back(passIndex);
+                }
+            }
+        }
+
+        for (uint32_t passIndex{}; passIndex < Passes.size(); ++passIndex)
+        {
+            if (CompiledPasses[passIndex].IsCulled || Passes[passIndex].Queue != RenderGraphQueue::Compute) { continue; }
+
+            for (uint32_t otherIndex{}; otherIndex < Passes.size(); ++otherIndex)
+            {
+                if (CompiledPasses[otherIndex].IsCulled || Passes[otherIndex].Queue != RenderGraphQueue::Graphics) { continue; }
+                if (levels[otherIndex] == levels[passIndex] && CanOverlap(passIndex, otherIndex))
+                {
+                    CompiledPasses[passIndex].IsAsyncComputeCandidate = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    bool RenderGraph::CanOverlap(const uint32_t passA, const uint32_t passB) const
+    {
+        //Passes on the same level can still both read a resource in different states, or use transient textures that alias, so they may not touch the same memory at all
+        for (const Access& accessA : Passes[passA].Accesses)
+        {
+            const uint32_t indexA = accessA.Resource.Index;
+            const bool isTransientA = Resources[indexA].Type == ResourceType::TransientTexture;
+
+            for (const Access& accessB : Passes[passB].Accesses)
+            {
+                const uint32_t indexB = accessB.Resource.Index;
+                if (indexA == indexB) { return false; }
+
+                if (!isTransientA || Resources[indexB].Type != ResourceType::TransientTexture) { continue; }
+
+                const CompiledTransient& transientA = CompiledTransients[indexA];
+                const CompiledTransient& transientB = CompiledTransients[indexB];
+                if (Overlaps(transientA.Offset, transientA.Offset + Resources[indexA].TransientDescription.Size, transientB.Offset, transientB.Offset + Resources[indexB].TransientDescription.Size))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void RenderGraph::Execute(const ICommandBuffer& commandBuffer)
+    {
+        Compile();
+
+        //TODO: Submit the async compute candidates on the compute queue once the context can hand out compute commandbuffers
+        for (uint32_t passIndex{}; passIndex < Passes.size(); ++passIndex)
+        {
+            const CompiledPass& compiledPass = CompiledPasses[passIndex];
+            if (compiledPass.IsCulled) { continue; }
+
+            for (const Transition& transition : compiledPass.Transitions)
+            {
+                RecordTransition(commandBuffer, transition);
+            }
+
+            Passes[passIndex].Callback(commandBuffer, *this);
+        }
+
+        for (const Transition& transition : FinalTransitions)
+        {
+            RecordTransition(commandBuffer, transition);
+        }
+
+        //The aliases of the next Execute can't know which texture used a part of the memory last, so they wait on all of them
+        PreviousTransientState = TransientFinalState;
+    }
+
+    void RenderGraph::RecordTransition(const ICommandBuffer& commandBuffer, const Transition& transition) const
+    {
+        const Resource& resource = Resources[transition.Resource.Index];
+        switch (resource.Type)
+        {
+            case ResourceType::ImportedTexture:
+            {
+                cmdTransition(commandBuffer, resource.Texture, transition.NextState);
+                break;
+            }
+
+            case ResourceType::TransientTexture:
+            {
+                CHECK_RETURN(resource.Texture.Valid(), "The transient texture {} is used without a texture bound to it", resource.Name);
+                if (!transition.DiscardContent)
+                {
+                    cmdTransition(commandBuffer, resource.Texture, transition.NextState);
+                    break;
+                }
+
+                //Start from undefined, the content is thrown away anyway.
+                //The memory was last used by the aliases earlier in this Execute, or by any transient texture in the previous one.
+                const ResourceState aliasedState = static_cast<ResourceState>(transition.PreviousState | PreviousTransientState);
+                const GlobalBarrier aliasBarrier{ .Buffer = {}, .CurrentState = aliasedState, .NextState = transition.NextState };
+                const ImageBarrier imageBarrier{ .Texture = resource.Texture, .CurrentState = ResourceState::Undefined, .NextState = transition.NextState };
+                const bool isAliased = aliasedState != ResourceState::Undefined;
+                cmdPipelineBarrier(commandBuffer, {&aliasBarrier, isAliased ? 1u : 0u}, {&imageBarrier, 1});
+                break;
+            }
+
+            case ResourceType::ImportedBuffer:
+            {
+                cmdTransition(commandBuffer, resource.Buffer, transition.NextState);
+                break;
+            }
+        }
+    }
+
+    void RenderGraph::Reset()
+    {
+        Resources.clear();
+        Passes.clear();
+    }
+
+    TextureHandle RenderGraph::GetTexture(const RenderGraphResource resource) const
+    {
+        CHECK(resource.Index < Resources.size(), "The resource is not part of the render graph");
+        return Resources[resource.Index].Texture;
+    }
+
+    BufferHandle RenderGraph::GetBuffer(const RenderGraphResource resource) const
+    {
+        CHECK(resource.Index < Resources.size(), "The resource is not part of the render graph");
+        return Resources[resource.Index].Buffer;
+    }
+
+    uint32_t RenderGraph::GetNumPasses() const
+    {
+        return static_cast<uint32_t>(Passes.size());
+    }
+
+    bool RenderGraph::IsPassCulled(const uint32_t passIndex) const
+    {
+        CHECK(IsCompiled && passIndex < CompiledPasses.size(), "The render graph needs to be compiled before asking which passes are culled");
+        return CompiledPasses[passIndex].IsCulled;
+    }
+
+    bool RenderGraph::IsAsyncComputeCandidate(const uint32_t passIndex) const
+    {
+        CHECK(IsCompiled && passIndex < CompiledPasses.size(), "The render graph needs to be compiled before asking which passes can run async");
+        return CompiledPasses[passIndex].IsAsyncComputeCandidate;
+    }
+
+    uint64_t RenderGraph::GetTransientMemorySize() const
+    {
+        return TransientMemorySize;
+    }
+
+    MemoryRequirements RenderGraph::GetTransientMemoryRequirements() const
+    {
+        return {.Size = TransientMemorySize, .Alignment = TransientMemoryAlignment, .MemoryTypeBits = TransientMemoryTypeBits};
+    }
+
+    uint64_t RenderGraph::GetTransientMemoryOffset(const RenderGraphResource resource) const
+    {
+        CHECK(IsCompiled && resource.Index < CompiledTransients.size(), "The render graph needs to be compiled before asking where a transient texture is placed");
+        return CompiledTransients[resource.Index].Offset;
+    }
+}
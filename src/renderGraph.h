@@ -0,0 +1,235 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "EOS.h"
+
+namespace EOS
+{
+    class RenderGraph;
+
+    /**
+    * @brief A resource that lives in a RenderGraph. It is only valid for the graph that created it.
+    */
+    struct RenderGraphResource final
+    {
+        static constexpr uint32_t InvalidIndex = 0xFFFFFFFF;
+
+        [[nodiscard]] bool Valid() const { return Index != InvalidIndex; }
+
+        uint32_t Index = InvalidIndex;
+    };
+
+    enum class RenderGraphQueue : uint8_t
+    {
+        Graphics,
+        Compute,
+    };
+
+    /**
+    * @brief The memory a transient texture needs, transient textures whose lifetimes don't overlap share the same memory.
+    * IContext::GetMemoryRequirements() gives these for a TextureDescription.
+    */
+    using TransientTextureDescription = MemoryRequirements;
+
+    using RenderGraphExecuteCallback = std::function<void(const ICommandBuffer& commandBuffer, const RenderGraph& renderGraph)>;
+
+    /**
+    * @brief Used to declare what a pass reads and writes. Reading and writing the same resource in 1 pass combines both states.
+    */
+    class RenderGraphPassBuilder final
+    {
+    public:
+        RenderGraphPassBuilder& Read(RenderGraphResource resource, ResourceState state);
+        RenderGraphPassBuilder& Write(RenderGraphResource resource, ResourceState state);
+
+        /**
+        * @brief The pass will never be culled, even when nothing reads what it writes.
+        */
+        RenderGraphPassBuilder& SideEffect();
+
+    private:
+        RenderGraphPassBuilder(RenderGraph& renderGraph, uint32_t passIndex) : Graph(renderGraph), PassIndex(passIndex) {}
+
+        RenderGraph& Graph;
+        uint32_t PassIndex;
+
+        friend class RenderGraph;
+    };
+
+    /**
+    * @brief Schedules passes that declare their reads and writes.
+    * The graph gets compiled once per change in topology, when compiled it:
+    *  - culls the passes that don't contribute to an imported resource or have a side effect.
+    *  - precomputes the minimal set of transitions between the passes.
+    *  - flags compute passes that could run on an async compute queue next to the graphics work.
+    *  - places transient textures with non overlapping lifetimes in the same memory.
+    * The passes are executed in the order they were added.
+    * @note The execute callbacks should not transition the resources of the graph themselves, the graph keeps track of their state.
+    */
+    class RenderGraph final
+    {
+    public:
+        RenderGraph() = default;
+        ~RenderGraph() = default;
+        DELETE_COPY_MOVE(RenderGraph);
+
+        /**
+        * @brief Makes a texture that lives outside the graph usable by the passes.
+        * @param name The name of the resource, used for debugging.
+        * @param texture The texture, this can change every frame without the graph having to be compiled again.
+        * @param finalState The state the texture gets transitioned to after the last pass, Undefined keeps the state of the last pass.
+        */
+        RenderGraphResource ImportTexture(const char* name, const TextureHandle& texture, ResourceState finalState = ResourceState::Undefined);
+
+        /**
+        * @brief Makes a buffer that lives outside the graph usable by the passes.
+        * @param name The name of the resource, used for debugging.
+        * @param buffer The buffer, this can change every frame without the graph having to be compiled again, the context keeps track of its state.
+        */
+        RenderGraphResource ImportBuffer(const char* name, const BufferHandle& buffer);
+
+        /**
+        * @brief Creates a texture that only lives for the duration of the graph, its content is undefined at its first use.
+        * @param name The name of the resource, used for debugging.
+        * @param description The memory requirements of the texture.
+        */
+        RenderGraphResource CreateTransientTexture(const char* name, const TransientTextureDescription& description);
+
+        /**
+        * @brief Binds the texture that is placed at GetTransientMemoryOffset() of the transient memory to a transient resource.
+        * The texture is typically created with IContext::CreateAliasedTexture() in memory of GetTransientMemoryRequirements().
+        */
+        void BindTransientTexture(RenderGraphResource resource, const TextureHandle& texture);
+
+        /**
+        * @brief Adds a pass to the graph.
+        * @param name The name of the pass, used for debugging.
+        * @param callback Records the work of the pass.
+        * @param queue The queue the pass wants to run on, compute passes can become async compute candidates.
+        * @return A builder to declare the reads and writes of the pass.
+        */
+        RenderGraphPassBuilder AddPass(const char* name, RenderGraphExecuteCallback callback, RenderGraphQueue queue = RenderGraphQueue::Graphics);
+
+        /**
+        * @brief Compiles the graph if its topology changed since the last compile.
+        */
+        void Compile();
+
+        /**
+        * @brief Compiles the graph if needed and records all the passes that were not culled.
+        * @param commandBuffer The commandbuffer the passes get recorded into.
+        */
+        void Execute(const ICommandBuffer& commandBuffer);
+
+        /**
+        * @brief Removes all passes and resources so the graph can be declared again, the compiled result is kept as long as the topology stays the same.
+        */
+        void Reset();
+
+        [[nodiscard]] TextureHandle GetTexture(RenderGraphResource resource) const;
+        [[nodiscard]] BufferHandle GetBuffer(RenderGraphResource resource) const;
+
+        [[nodiscard]] uint32_t GetNumPasses() const;
+        [[nodiscard]] bool IsPassCulled(uint32_t passIndex) const;
+
+        //A compute pass that doesn't depend on, and shares no resources or transient memory with, a graphics pass of the same dependency level.
+        //The context has no compute queue yet, so Execute still records every pass in order, this only reports which passes could overlap.
+        [[nodiscard]] bool IsAsyncComputeCandidate(uint32_t passIndex) const;
+
+        //The total amount of memory all transient textures need together and where in that memory each of them is placed
+        [[nodiscard]] uint64_t GetTransientMemorySize() const;
+        [[nodiscard]] MemoryRequirements GetTransientMemoryRequirements() const;
+        [[nodiscard]] uint64_t GetTransientMemoryOffset(RenderGraphResource resource) const;
+
+    private:
+        enum class ResourceType : uint8_t
+        {
+            ImportedTexture,
+            ImportedBuffer,
+            TransientTexture,
+        };
+
+        struct Resource final
+        {
+            std::string Name;
+            ResourceType Type;
+            TextureHandle Texture{};
+            BufferHandle Buffer{};
+            ResourceState State = ResourceState::Undefined;     // final state for imported textures
+            TransientTextureDescription TransientDescription{};
+        };
+
+        struct Access final
+        {
+            RenderGraphResource Resource;
+            ResourceState State;
+            bool IsRead;
+            bool IsWrite;
+        };
+
+        struct Pass final
+        {
+            std::string Name;
+            RenderGraphQueue Queue;
+            RenderGraphExecuteCallback Callback;
+            std::vector<Access> Accesses;
+            bool HasSideEffect = false;
+        };
+
+        struct Transition final
+        {
+            RenderGraphResource Resource;
+            ResourceState PreviousState;
+            ResourceState NextState;
+            bool DiscardContent;    // first use of a transient texture, its memory might have been used by an other texture
+        };
+
+        struct CompiledPass final
+        {
+            std::vector<Transition> Transitions;
+            bool IsCulled = true;
+            bool IsAsyncComputeCandidate = false;
+        };
+
+        // lifetime and placement of a resource in the transient memory, only filled in for transient textures
+        struct CompiledTransient final
+        {
+            uint64_t Offset = 0;
+            uint32_t FirstPass = 0;
+            uint32_t LastPass = 0;
+            bool IsUsed = false;
+        };
+
+        void AddAccess(uint32_t passIndex, RenderGraphResource resource, ResourceState state, bool isWrite);
+        [[nodiscard]] uint64_t HashTopology() const;
+
+        void CullPasses();
+        void ComputeTransitions();
+        void FindAsyncComputeCandidates();
+        void PlaceTransientTextures();
+        [[nodiscard]] bool CanOverlap(uint32_t passA, uint32_t passB) const;
+
+        void RecordTransition(const ICommandBuffer& commandBuffer, const Transition& transition) const;
+
+        std::vector<Resource> Resources;
+        std::vector<Pass> Passes;
+
+        // compiled result, kept around between Reset() calls as long as the topology hash matches
+        uint64_t CompiledTopologyHash = 0;
+        bool IsCompiled = false;
+        std::vector<CompiledPass> CompiledPasses;
+        std::vector<CompiledTransient> CompiledTransients;
+        std::vector<Transition> FinalTransitions;
+        uint64_t TransientMemorySize = 0;
+        uint64_t TransientMemoryAlignment = 1;
+        uint32_t TransientMemoryTypeBits = 0xFFFFFFFF;
+        ResourceState TransientFinalState = ResourceState::Undefined;      // the states the transient textures are left in after their last pass
+
+        // the transient memory still holds the work of the previous Execute, the first use of every transient texture waits on it as well
+        ResourceState PreviousTransientState = ResourceState::Undefined;
+
+        friend class RenderGraphPassBuilder;
+    };
+}
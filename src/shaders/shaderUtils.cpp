@@ -1,4 +1,5 @@
 #include "shaderUtils.h"
+#include <algorithm>
 #include <fstream>
 
 #include "logger.h"
@@ -126,11 +127,9 @@ namespace EOS
             VariableLayoutReflection* variableLayout = entryPointLayout->getParameterByIndex(i);
             if (variableLayout->getCategory() == slang::Uniform)
             {
-                //This is asumed to be a push constnat
-                size_t offset = variableLayout->getOffset();
-                TypeReflection* type = variableLayout->getVariable()->getType();
-
-                outShaderInfo.pushConstantSize += offset;
+                //Uniform entry point parameters end up in the push constants, the size is where the last one ends
+                const size_t end = variableLayout->getOffset() + variableLayout->getTypeLayout()->getSize();
+                outShaderInfo.pushConstantSize = std::max(outShaderInfo.pushConstantSize, static_cast<uint32_t>(end));
             }
         }
 
@@ -0,0 +1,60 @@
+#include "threadPool.h"
+
+namespace EOS
+{
+    ThreadPool::ThreadPool(const uint32_t numThreads)
+    {
+        Workers.reserve(numThreads);
+        for (uint32_t i = 0; i < numThreads; ++i)
+        {
+            Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::scoped_lock lock(TasksMutex);
+            IsStopping = true;
+        }
+        TasksChanged.notify_all();
+
+        for (std::thread& worker : Workers)
+        {
+            worker.join();
+        }
+    }
+
+    std::future<void> ThreadPool::Enqueue(std::function<void()> task)
+    {
+        std::packaged_task<void()> packagedTask(std::move(task));
+        std::future<void> future = packagedTask.get_future();
+        {
+            std::scoped_lock lock(TasksMutex);
+            Tasks.push(std::move(packagedTask));
+        }
+        TasksChanged.notify_one();
+
+        return future;
+    }
+
+    void ThreadPool::WorkerLoop()
+    {
+        while (true)
+        {
+            std::packaged_task<void()> task;
+            {
+                std::unique_lock lock(TasksMutex);
+                TasksChanged.wait(lock, [this]() { return IsStopping || !Tasks.empty(); });
+
+                //Only stop once all work is done
+                if (Tasks.empty()) { return; }
+
+                task = std::move(Tasks.front());
+                Tasks.pop();
+            }
+
+            task();
+        }
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "defines.h"
+
+namespace EOS
+{
+    /**
+    * @brief A fixed amount of worker threads that execute the enqueued tasks in the order they were enqueued.
+    * The destructor finishes every task that was enqueued before it returns.
+    */
+    class ThreadPool final
+    {
+    public:
+        explicit ThreadPool(uint32_t numThreads = std::max(2u, std::thread::hardware_concurrency()) - 1);
+        ~ThreadPool();
+        DELETE_COPY_MOVE(ThreadPool);
+
+        /**
+        * @brief Executes the task on one of the worker threads.
+        * @return A future that becomes ready once the task has been executed.
+        */
+        std::future<void> Enqueue(std::function<void()> task);
+
+    private:
+        void WorkerLoop();
+
+        std::vector<std::thread> Workers;
+        std::queue<std::packaged_task<void()>> Tasks;
+        std::mutex TasksMutex;
+        std::condition_variable TasksChanged;
+        bool IsStopping = false;
+    };
+}
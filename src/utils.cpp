@@ -51,6 +51,15 @@ namespace EOS
         out.write(reinterpret_cast<const char*>(content.data()), content.size());
         out.close();
     }
+
+    void HashCombine(uint64_t& hash, const uint64_t value)
+    {
+        for (uint32_t i{}; i < sizeof(uint64_t); ++i)
+        {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 0x100000001B3ull;
+        }
+    }
 }
 
 
@@ -15,4 +15,11 @@ namespace EOS
     * @return
     */
     void WriteFile(const std::filesystem::path& filePath, const std::string& content);
+
+    /**
+    * @brief Mixes the value into the hash with FNV-1a, start from HashSeed.
+    */
+    void HashCombine(uint64_t& hash, uint64_t value);
+
+    static constexpr uint64_t HashSeed = 0xCBF29CE484222325ull;
 }
\ No newline at end of file
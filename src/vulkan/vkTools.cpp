@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <vector>
 #include <ranges>
 
@@ -435,7 +436,7 @@ namespace VkContext
         vkGetPhysicalDeviceProperties2(physicalDevice, &physicalDeviceProperties);
     }
 
-    void CreateVulkanDevice(VkDevice& device, const VkPhysicalDevice& physicalDevice, DeviceQueues& deviceQueues)
+    void CreateVulkanDevice(VkDevice& device, const VkPhysicalDevice& physicalDevice, DeviceQueues& deviceQueues, DeviceCapabilities& capabilities)
     {
         CHECK(physicalDevice != VK_NULL_HANDLE, "Cannot Create a Vulkan Device if the Physical Device is not valid");
 
@@ -521,6 +522,8 @@ namespace VkContext
             .shaderImageGatherExtended      = VK_TRUE,
             .shaderInt64                    = startOfDeviceFeaturespNextChain.features.shaderInt64,
         };
+        capabilities.GeometryShader = deviceFeatures10.geometryShader;
+        capabilities.TessellationShader = deviceFeatures10.tessellationShader;
 
         VkPhysicalDeviceVulkan11Features deviceFeatures11
         {
@@ -543,6 +546,7 @@ namespace VkContext
             .shaderSampledImageArrayNonUniformIndexing      = VK_TRUE,
             .descriptorBindingSampledImageUpdateAfterBind   = VK_TRUE,
             .descriptorBindingStorageImageUpdateAfterBind   = VK_TRUE,
+            .descriptorBindingStorageBufferUpdateAfterBind  = VK_TRUE,
             .descriptorBindingUpdateUnusedWhilePending      = VK_TRUE,
             .descriptorBindingPartiallyBound                = VK_TRUE,
             .descriptorBindingVariableDescriptorCount       = VK_TRUE,
@@ -560,10 +564,11 @@ namespace VkContext
         {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
             .pNext = &deviceFeatures12,
-            .subgroupSizeControl  = VK_TRUE,
-            .synchronization2     = VK_TRUE,
-            .dynamicRendering     = VK_TRUE,
-            .maintenance4         = VK_TRUE,
+            .pipelineCreationCacheControl   = VK_TRUE,     // lets pipeline creation fail instead of compile, so only worker threads compile
+            .subgroupSizeControl            = VK_TRUE,
+            .synchronization2               = VK_TRUE,
+            .dynamicRendering               = VK_TRUE,
+            .maintenance4                   = VK_TRUE,
         };
 
         VkPhysicalDeviceAccelerationStructureFeaturesKHR accelerationStructureFeatures =
@@ -599,6 +604,13 @@ namespace VkContext
            .indexTypeUint8 = VK_TRUE,
         };
 
+        //Will only be tried to enable on 1.3 Vulkan, it is part of the 1.4 features
+        VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeatures =
+        {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+            .hostImageCopy = VK_TRUE,
+        };
+
         void* createInfoNext = nullptr;
         VkPhysicalDeviceVulkan14Features deviceFeatures14{}; //TODO: Check if VkPhysicalDeviceVulkan14Features will work in 1.3
         if (version == vkVersion::VERSION_14)
@@ -633,6 +645,9 @@ namespace VkContext
 
             deviceFeatures14.pNext = &deviceFeatures13;
             createInfoNext = &deviceFeatures14;
+            capabilities.HostImageCopy = deviceFeatures14.hostImageCopy;
+            capabilities.LineRasterization = deviceFeatures14.rectangularLines || deviceFeatures14.bresenhamLines || deviceFeatures14.smoothLines
+                || deviceFeatures14.stippledRectangularLines || deviceFeatures14.stippledBresenhamLines || deviceFeatures14.stippledSmoothLines;
         }
         else
         {
@@ -710,8 +725,52 @@ namespace VkContext
         if (version == vkVersion::VERSION_13)
         {
             addOptionalExtension(VK_KHR_INDEX_TYPE_UINT8_EXTENSION_NAME, &indexTypeUint8Features);
+            capabilities.HostImageCopy = addOptionalExtension(VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME, &hostImageCopyFeatures);
         }
 
+        //Lets VMA query how much of each heap we can still use
+        capabilities.MemoryBudget = addOptionalExtension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+        //Fills in the features of an extension the device supports, the features stay VK_FALSE when the extension isn't there
+        auto getSupportedFeatures = [&allDeviceExtensions, physicalDevice](const char* name, void* features)
+        {
+            if (std::ranges::none_of(allDeviceExtensions, [name](const VkExtensionProperties& extension) { return strcmp(extension.extensionName, name) == 0; })) { return; }
+
+            VkPhysicalDeviceFeatures2 features2{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2, .pNext = features };
+            vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+        };
+
+        //Lets the freed slots of the bindless heap point at nothing instead of at a destroyed resource
+        VkPhysicalDeviceRobustness2FeaturesEXT supportedRobustness2Features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ROBUSTNESS_2_FEATURES_EXT };
+        getSupportedFeatures(VK_EXT_ROBUSTNESS_2_EXTENSION_NAME, &supportedRobustness2Features);
+        VkPhysicalDeviceRobustness2FeaturesEXT robustness2Features{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ROBUSTNESS_2_FEATURES_EXT, .nullDescriptor = VK_TRUE };
+        capabilities.NullDescriptor = supportedRobustness2Features.nullDescriptor && addOptionalExtension(VK_EXT_ROBUSTNESS_2_EXTENSION_NAME, &robustness2Features);
+
+        //Lets the bindless heap write descriptors straight into a buffer, without descriptor pools and sets
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT supportedDescriptorBufferFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT };
+        getSupportedFeatures(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME, &supportedDescriptorBufferFeatures);
+        VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT, .descriptorBuffer = VK_TRUE };
+        capabilities.DescriptorBuffer = supportedDescriptorBufferFeatures.descriptorBuffer && addOptionalExtension(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME, &descriptorBufferFeatures);
+
+        //Lets render pipelines be linked out of parts that are compiled once, only worth it when the device can link them fast
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supportedGraphicsPipelineLibraryFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT };
+        getSupportedFeatures(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, &supportedGraphicsPipelineLibraryFeatures);
+        VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphicsPipelineLibraryProperties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT };
+        if (supportedGraphicsPipelineLibraryFeatures.graphicsPipelineLibrary)
+        {
+            VkPhysicalDeviceProperties2 properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &graphicsPipelineLibraryProperties };
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+        }
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphicsPipelineLibraryFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT, .graphicsPipelineLibrary = VK_TRUE };
+        capabilities.GraphicsPipelineLibrary = graphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking
+            && addOptionalExtensions(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, &graphicsPipelineLibraryFeatures);
+
+        //Lets shaders be bound without pipelines, with all of their state set while recording
+        VkPhysicalDeviceShaderObjectFeaturesEXT supportedShaderObjectFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT };
+        getSupportedFeatures(VK_EXT_SHADER_OBJECT_EXTENSION_NAME, &supportedShaderObjectFeatures);
+        VkPhysicalDeviceShaderObjectFeaturesEXT shaderObjectFeatures{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT, .shaderObject = VK_TRUE };
+        capabilities.ShaderObject = supportedShaderObjectFeatures.shaderObject && addOptionalExtension(VK_EXT_SHADER_OBJECT_EXTENSION_NAME, &shaderObjectFeatures);
+
 
         const VkDeviceCreateInfo deviceCreateInfo =
         {
@@ -731,6 +790,26 @@ namespace VkContext
         //Fill in our Device Queue's
         vkGetDeviceQueue(device, deviceQueues.Compute.QueueFamilyIndex, 0, &deviceQueues.Compute.Queue);
         vkGetDeviceQueue(device, deviceQueues.Graphics.QueueFamilyIndex, 0, &deviceQueues.Graphics.Queue);
+
+        //Samplers clamp their anisotropy to what the device supports
+        VkPhysicalDeviceProperties deviceProperties{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+        capabilities.MaxSamplerAnisotropy = deviceProperties.limits.maxSamplerAnisotropy;
+
+        //Textures that are copied into by the host are left in SHADER_READ_ONLY_OPTIMAL when the device allows it, so they don't need a transition before they are sampled
+        if (capabilities.HostImageCopy)
+        {
+            VkPhysicalDeviceHostImageCopyProperties hostImageCopyProperties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES};
+            VkPhysicalDeviceProperties2 properties{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &hostImageCopyProperties};
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+            std::vector<VkImageLayout> copyDstLayouts(hostImageCopyProperties.copyDstLayoutCount);
+            hostImageCopyProperties.pCopyDstLayouts = copyDstLayouts.data();
+            vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+            const bool canCopyToShaderReadOnly = std::ranges::find(copyDstLayouts, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) != copyDstLayouts.end();
+            capabilities.HostImageCopyLayout = canCopyToShaderReadOnly ? VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+        }
     }
 };
 
@@ -788,229 +867,87 @@ namespace VkSynchronization
         return fence;
     }
 
-    VkPipelineStageFlags2 ConvertToVkPipelineStage2(const EOS::ResourceState &state)
+    VkEvent CreateDeviceEvent(const VkDevice& device, const char* debugName)
     {
-        VkPipelineStageFlags2 flags = 0;
-
-        // Raytracing
-        if (state & (EOS::ResourceState::AccelerationStructureRead))
-        {
-            flags |= VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-        }
-
-        if (state & (EOS::ResourceState::AccelerationStructureWrite))
-        {
-            flags |= VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-        }
-
-        // Graphics
-        if (state & EOS::ResourceState::IndexBuffer)
-        {
-            flags |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
-        }
-
-        if (state & EOS::ResourceState::VertexAndConstantBuffer)
-        {
-            flags |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT;
-            //flags |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT; //TODO: Test this out if the latter flag is needed
-        }
-
-        if (state & EOS::ResourceState::PixelShaderResource)
-        {
-            flags |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-        }
-
-        if (state & EOS::ResourceState::NonPixelShaderResource)
-        {
-            flags |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT;
-            flags |= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-
-            //TODO: if (IsGeometryShaderSupported)
-            {
-                //flags |= VK_PIPELINE_STAGE_2_GEOMETRY_SHADER_BIT;
-            }
-
-            //TODO: if (IsTesselationSupported)
-            {
-                //flags |= VK_PIPELINE_STAGE_2_TESSELLATION_CONTROL_SHADER_BIT;
-                //flags |= VK_PIPELINE_STAGE_2_TESSELLATION_EVALUATION_SHADER_BIT;
-            }
-
-            //TODO: if (IsRayTracingSupported)
-            {
-                //flags |= VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR;
-            }
-        }
-
-        if (state & EOS::ResourceState::UnorderedAccess)
-        {
-            flags |= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-        }
-        if (state & EOS::ResourceState::UnorderedAccessPixel)
-        {
-            flags |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-        }
-        if (state & EOS::ResourceState::RenderTarget)
-        {
-            flags |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-        }
-        if (state & (EOS::ResourceState::DepthRead | EOS::ResourceState::DepthWrite))
-        {
-            flags |= VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
-        }
-
-        //TODO: Compute
-        {
-            //flags |= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
-        }
-
-        //TODO: Transfer
-        {
-            //return VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-            //return VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-        }
-
-        // Compatible with both compute and graphics queues
-        if (state & EOS::ResourceState::IndirectArgument)
-        {
-            flags |= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
-        }
-
-        if (state & (EOS::ResourceState::CopyDest | EOS::ResourceState::CopySource))
-        {
-            flags |= VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-        }
-
-        if (flags == 0)
+        //We only ever signal and wait on the GPU, so the driver doesn't need to make the event visible to the host
+        constexpr VkEventCreateInfo createInfo =
         {
-            flags = VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
-        }
+            .sType = VK_STRUCTURE_TYPE_EVENT_CREATE_INFO,
+            .flags = VK_EVENT_CREATE_DEVICE_ONLY_BIT,
+        };
 
-        return flags;
+        VkEvent event = VK_NULL_HANDLE;
+        VK_ASSERT(vkCreateEvent(device, &createInfo, nullptr, &event));
+        VK_ASSERT(VkDebug::SetDebugObjectName(device, VK_OBJECT_TYPE_EVENT, reinterpret_cast<uint64_t>(event), debugName));
+        return event;
     }
 
-    VkAccessFlags2 ConvertToVkAccessFlags2(const EOS::ResourceState &state)
+    //The tables should give the same result as testing every state 1 by 1
+    static_assert(ConvertToVkPipelineStage2(EOS::ResourceState::Undefined) == VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT);
+    static_assert(ConvertToVkPipelineStage2(EOS::ResourceState::IndexBuffer) == VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT);
+    static_assert(ConvertToVkPipelineStage2(EOS::ResourceState::ShaderResource) == (VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT));
+    static_assert(ConvertToVkAccessFlags2(EOS::ResourceState::GenericRead) == (VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT |
+                                                                             VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_2_TRANSFER_READ_BIT));
+    static_assert(ConvertToVkImageLayout(static_cast<EOS::ResourceState>(EOS::ResourceState::CopySource | EOS::ResourceState::RenderTarget)) == VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    static_assert(ConvertToVkImageLayout(static_cast<EOS::ResourceState>(EOS::ResourceState::UnorderedAccess | EOS::ResourceState::ShaderResource)) == VK_IMAGE_LAYOUT_GENERAL);
+    static_assert(ConvertToVkImageLayout(static_cast<EOS::ResourceState>(EOS::ResourceState::Common | EOS::ResourceState::StreamOut)) == VK_IMAGE_LAYOUT_UNDEFINED);
+    static_assert(ConvertToVkImageLayout(EOS::ResourceState::Common) == VK_IMAGE_LAYOUT_GENERAL);
+    static_assert(!NeedsBarrier(EOS::ResourceState::ShaderResource, EOS::ResourceState::PixelShaderResource));
+    static_assert(NeedsBarrier(EOS::ResourceState::RenderTarget, EOS::ResourceState::RenderTarget));
+
+    VkImageMemoryBarrier2 CreateImageMemoryBarrier(const BarrierDescription& description, const VulkanImage& image, const EOS::SubresourceRange& range)
     {
-        VkAccessFlags flags = 0;
-
-        if (state & EOS::ResourceState::CopySource)
-        {
-            flags |= VK_ACCESS_2_TRANSFER_READ_BIT;
-        }
-
-        if (state & EOS::ResourceState::CopyDest)
-        {
-            flags |= VK_ACCESS_2_TRANSFER_WRITE_BIT;
-        }
-
-        if (state & EOS::ResourceState::VertexAndConstantBuffer)
-        {
-            flags |= VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT;
-        }
-
-        if (state & EOS::ResourceState::IndexBuffer)
-        {
-            flags |= VK_ACCESS_2_INDEX_READ_BIT;
-        }
-
-        if (state & (EOS::ResourceState::UnorderedAccess | EOS::ResourceState::UnorderedAccessPixel))
+        VkImageAspectFlags aspectMask = description.AspectMask;
+        if (VulkanImage::IsDepthAttachment(image))
         {
-            flags |= VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT;
-        }
-
-        if (state & EOS::ResourceState::IndirectArgument)
-        {
-            flags |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
-        }
-
-        if (state & EOS::ResourceState::RenderTarget)
-        {
-            flags |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
-        }
-
-        if (state & EOS::ResourceState::DepthWrite)
-        {
-            flags |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-        }
-
-        if (state & EOS::ResourceState::DepthRead)
-        {
-            flags |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-        }
-
-        if (state & EOS::ResourceState::ShaderResource)
-        {
-            flags |= VK_ACCESS_2_SHADER_READ_BIT;
-        }
-
-        if (state & EOS::ResourceState::Present)
-        {
-            flags |= VK_ACCESS_2_MEMORY_READ_BIT;
-        }
-
-        if (state & EOS::ResourceState::AccelerationStructureRead)
-        {
-            flags |= VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR;
+            aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+            switch (image.ImageFormat)
+            {
+                case VK_FORMAT_D16_UNORM_S8_UINT:
+                case VK_FORMAT_D24_UNORM_S8_UINT:
+                case VK_FORMAT_D32_SFLOAT_S8_UINT:
+                    aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+                    break;
+                default:
+                    break;
+            }
         }
 
-        if (state & EOS::ResourceState::AccelerationStructureWrite)
+        return VkImageMemoryBarrier2
         {
-            flags |= VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
-        }
-
-        return flags;
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask       = description.SrcStageMask,
+            .srcAccessMask      = description.SrcAccessMask,
+            .dstStageMask       = description.DstStageMask,
+            .dstAccessMask      = description.DstAccessMask,
+            .oldLayout          = description.OldLayout,
+            .newLayout          = description.NewLayout,
+            .image              = image.Image,
+            .subresourceRange   = {aspectMask, range.BaseMipLevel, range.NumMipLevels, range.BaseArrayLayer, range.NumArrayLayers}
+        };
     }
 
-    VkImageLayout ConvertToVkImageLayout(const EOS::ResourceState &state)
+    VkImageMemoryBarrier2 CreateImageMemoryBarrier(const VulkanImage& image, const EOS::ResourceState currentState, const EOS::ResourceState nextState, const EOS::SubresourceRange& range)
     {
-        if (state & EOS::ResourceState::CopySource)
-            return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-
-        if (state & EOS::ResourceState::CopyDest)
-            return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-
-        if (state & EOS::ResourceState::RenderTarget)
-            return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-        if (state & EOS::ResourceState::DepthWrite)
-            return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
-
-        if (state & EOS::DepthRead)
-            return VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
-
-        if (state & (EOS::ResourceState::UnorderedAccess | EOS::UnorderedAccessPixel))
-            return VK_IMAGE_LAYOUT_GENERAL;
-
-        if (state & EOS::ResourceState::ShaderResource)
-            return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-        if (state & EOS::ResourceState::Present)
-            return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
-
-        if (state == EOS::ResourceState::Common)
-            return VK_IMAGE_LAYOUT_GENERAL;
-
-        return VK_IMAGE_LAYOUT_UNDEFINED;
+        return CreateImageMemoryBarrier(CreateBarrierDescription(currentState, nextState), image, range);
     }
 
-    VkImageAspectFlags ConvertToVkImageAspectFlags(const EOS::ResourceState &state)
+    VkBufferMemoryBarrier2 CreateBufferMemoryBarrier(VkBuffer buffer, const EOS::ResourceState currentState, const EOS::ResourceState nextState, const VkDeviceSize offset, const VkDeviceSize size)
     {
-        VkImageAspectFlags aspectMask = 0;
-
-        if (state & EOS::ResourceState::RenderTarget)
-        {
-            aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        }
-        else
-        {
-            aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        }
-
-        if (state & (EOS::ResourceState::DepthRead | EOS::ResourceState::DepthWrite))
-        {
-            aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-        }
-
-        return aspectMask;
+        return VkBufferMemoryBarrier2
+        {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+            .pNext = nullptr,
+            .srcStageMask           = ConvertToVkPipelineStage2(currentState),
+            .srcAccessMask          = ConvertToVkAccessFlags2(currentState),
+            .dstStageMask           = ConvertToVkPipelineStage2(nextState),
+            .dstAccessMask          = ConvertToVkAccessFlags2(nextState),
+            .srcQueueFamilyIndex    = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex    = VK_QUEUE_FAMILY_IGNORED,
+            .buffer                 = buffer,
+            .offset                 = offset,
+            .size                   = size,
+        };
     }
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 ﻿#pragma once
+#include <array>
+#include <bit>
 #include <cstdio>
 
 #include <volk.h>
@@ -14,9 +16,12 @@
 #pragma region ForwardDeclare
 
 struct DeviceQueues;
+struct DeviceCapabilities;
+struct VulkanImage;
 namespace EOS
 {
     struct HardwareDeviceDescription;
+    struct SubresourceRange;
     enum class ColorSpace : uint8_t;
 }
 #pragma endregion
@@ -101,7 +106,7 @@ namespace VkContext
     void GetDeviceExtensions(std::vector<VkExtensionProperties>& deviceExtensions,const VkPhysicalDevice& vulkanPhysicalDevice, const char* forValidationLayer = nullptr);
     void GetDeviceExtensions(const VkPhysicalDevice& vulkanPhysicalDevice, std::vector<VkExtensionProperties>& allDeviceExtensions);
     void GetPhysicalDeviceProperties(VkPhysicalDeviceProperties2& physicalDeviceProperties, VkPhysicalDeviceDriverProperties& physicalDeviceDriverProperties, VkPhysicalDevice physicalDevice, uint32_t SDKMinorVersion);
-    void CreateVulkanDevice(VkDevice& device, const VkPhysicalDevice& physicalDevice, DeviceQueues& deviceQueues);
+    void CreateVulkanDevice(VkDevice& device, const VkPhysicalDevice& physicalDevice, DeviceQueues& deviceQueues, DeviceCapabilities& capabilities);
 }
 
 namespace VkSynchronization
@@ -109,8 +114,175 @@ namespace VkSynchronization
     [[nodiscard]] VkSemaphore CreateSemaphore(const VkDevice& device, const char* debugName);
     [[nodiscard]] VkSemaphore CreateSemaphoreTimeline(const VkDevice& device, uint64_t initialValue, const char* debugName);
     [[nodiscard]] VkFence CreateFence(const VkDevice& device, const char* debugName);
-    VkPipelineStageFlags2 ConvertToVkPipelineStage2(const EOS::ResourceState& state);
-    VkAccessFlags2 ConvertToVkAccessFlags2(const EOS::ResourceState& state);
-    VkImageLayout ConvertToVkImageLayout(const EOS::ResourceState& state);
-    VkImageAspectFlags ConvertToVkImageAspectFlags(const EOS::ResourceState& state);
+    [[nodiscard]] VkEvent CreateDeviceEvent(const VkDevice& device, const char* debugName);
+
+    //The conversions below run for both sides of every barrier we record, so instead of testing every state 1 by 1
+    //each bit of a EOS::ResourceState indexes a table and only the bits that are set get visited.
+    inline constexpr uint32_t NumResourceStateBits = 17;
+    inline constexpr uint32_t ResourceStateBitsMask = (1u << NumResourceStateBits) - 1;
+
+    inline constexpr std::array<VkPipelineStageFlags2, NumResourceStateBits> PipelineStagePerStateBit
+    {
+        VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,                                                           // VertexAndConstantBuffer
+        VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT,                                                           // VertexBuffer
+        VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,                                                // RenderTarget
+        VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,                                                         // UnorderedAccess
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,     // DepthWrite
+        VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,     // DepthRead
+        VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,                 // NonPixelShaderResource //TODO: Geometry, Tessellation and RayTracing stages once we check if they are supported
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,                                                        // PixelShaderResource
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT,                                                               // CopyDest
+        VK_PIPELINE_STAGE_2_TRANSFER_BIT,                                                               // CopySource
+        VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT,                                                          // IndirectArgument
+        0,                                                                                              // StreamOut
+        0,                                                                                              // Present
+        0,                                                                                              // Common
+        VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,  // AccelerationStructureRead
+        VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,                                       // AccelerationStructureWrite
+        VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT,                                                        // UnorderedAccessPixel
+    };
+
+    inline constexpr std::array<VkAccessFlags2, NumResourceStateBits> AccessPerStateBit
+    {
+        VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_2_INDEX_READ_BIT,  // VertexAndConstantBuffer
+        VK_ACCESS_2_INDEX_READ_BIT,                                                                     // VertexBuffer
+        VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,                 // RenderTarget
+        VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,                                     // UnorderedAccess
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,                                                 // DepthWrite
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT,                                                  // DepthRead
+        VK_ACCESS_2_SHADER_READ_BIT,                                                                    // NonPixelShaderResource
+        VK_ACCESS_2_SHADER_READ_BIT,                                                                    // PixelShaderResource
+        VK_ACCESS_2_TRANSFER_WRITE_BIT,                                                                 // CopyDest
+        VK_ACCESS_2_TRANSFER_READ_BIT,                                                                  // CopySource
+        VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT,                                                          // IndirectArgument
+        0,                                                                                              // StreamOut
+        VK_ACCESS_2_MEMORY_READ_BIT,                                                                    // Present
+        0,                                                                                              // Common
+        VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR,                                                // AccelerationStructureRead
+        VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR,                                               // AccelerationStructureWrite
+        VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT,                                     // UnorderedAccessPixel
+    };
+
+    //An image can only be in 1 layout, when multiple bits are set the one with the lowest priority value wins.
+    struct LayoutForStateBit final
+    {
+        uint8_t Priority;
+        VkImageLayout Layout;
+    };
+
+    inline constexpr uint8_t LowestLayoutPriority = 0xFF;
+    inline constexpr std::array<LayoutForStateBit, NumResourceStateBits> LayoutPerStateBit
+    {{
+        {LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED},                  // VertexAndConstantBuffer
+        {LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED},                  // VertexBuffer
+        {2, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL},                      // RenderTarget
+        {5, VK_IMAGE_LAYOUT_GENERAL},                                       // UnorderedAccess
+        {3, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL},              // DepthWrite
+        {4, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL},               // DepthRead
+        {6, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},                      // NonPixelShaderResource
+        {6, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL},                      // PixelShaderResource
+        {1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL},                          // CopyDest
+        {0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL},                          // CopySource
+        {LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED},                  // IndirectArgument
+        {LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED},                  // StreamOut
+        {7, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR},                               // Present
+        {LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED},                  // Common, only GENERAL when it is the only bit
+        {LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED},                  // AccelerationStructureRead
+        {LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED},                  // AccelerationStructureWrite
+        {5, VK_IMAGE_LAYOUT_GENERAL},                                       // UnorderedAccessPixel
+    }};
+
+    [[nodiscard]] constexpr VkPipelineStageFlags2 ConvertToVkPipelineStage2(const EOS::ResourceState state)
+    {
+        VkPipelineStageFlags2 flags = 0;
+        for (uint32_t bits = state & ResourceStateBitsMask; bits != 0; bits &= bits - 1)
+        {
+            flags |= PipelineStagePerStateBit[std::countr_zero(bits)];
+        }
+
+        return flags != 0 ? flags : VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+    }
+
+    [[nodiscard]] constexpr VkAccessFlags2 ConvertToVkAccessFlags2(const EOS::ResourceState state)
+    {
+        VkAccessFlags2 flags = 0;
+        for (uint32_t bits = state & ResourceStateBitsMask; bits != 0; bits &= bits - 1)
+        {
+            flags |= AccessPerStateBit[std::countr_zero(bits)];
+        }
+
+        return flags;
+    }
+
+    [[nodiscard]] constexpr VkImageLayout ConvertToVkImageLayout(const EOS::ResourceState state)
+    {
+        if (state == EOS::ResourceState::Common) { return VK_IMAGE_LAYOUT_GENERAL; }
+
+        LayoutForStateBit result{LowestLayoutPriority, VK_IMAGE_LAYOUT_UNDEFINED};
+        for (uint32_t bits = state & ResourceStateBitsMask; bits != 0; bits &= bits - 1)
+        {
+            const LayoutForStateBit& candidate = LayoutPerStateBit[std::countr_zero(bits)];
+            result = candidate.Priority < result.Priority ? candidate : result;
+        }
+
+        return result.Layout;
+    }
+
+    [[nodiscard]] constexpr VkImageAspectFlags ConvertToVkImageAspectFlags(const EOS::ResourceState state)
+    {
+        return (state & (EOS::ResourceState::DepthRead | EOS::ResourceState::DepthWrite)) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+    }
+
+    //Returns true when none of the bits in the state can write to the resource.
+    [[nodiscard]] constexpr bool IsReadOnlyState(const EOS::ResourceState state)
+    {
+        constexpr uint32_t writeStates = EOS::ResourceState::RenderTarget | EOS::ResourceState::UnorderedAccess | EOS::ResourceState::UnorderedAccessPixel |
+                                         EOS::ResourceState::DepthWrite | EOS::ResourceState::CopyDest | EOS::ResourceState::StreamOut |
+                                         EOS::ResourceState::AccelerationStructureWrite | EOS::ResourceState::Common;
+
+        //Undefined is not a read state, whatever comes next needs a barrier to get out of it.
+        return state != EOS::ResourceState::Undefined && (state & writeStates) == 0;
+    }
+
+    //Returns true when going from the current to the next state needs a barrier.
+    //Read only states that keep the same layout and don't add any new stage or access don't need one.
+    [[nodiscard]] constexpr bool NeedsBarrier(const EOS::ResourceState currentState, const EOS::ResourceState nextState)
+    {
+        if (!IsReadOnlyState(currentState) || !IsReadOnlyState(nextState)) { return true; }
+
+        //A read that uses stages or accesses that the current state does not cover, still needs to wait on the previous barrier.
+        if ((nextState & ~currentState) != 0) { return true; }
+
+        return ConvertToVkImageLayout(currentState) != ConvertToVkImageLayout(nextState);
+    }
+
+    //Everything of a barrier that only depends on the states, fixed transitions can build it at compile time.
+    struct BarrierDescription final
+    {
+        VkPipelineStageFlags2 SrcStageMask;
+        VkAccessFlags2 SrcAccessMask;
+        VkPipelineStageFlags2 DstStageMask;
+        VkAccessFlags2 DstAccessMask;
+        VkImageLayout OldLayout;
+        VkImageLayout NewLayout;
+        VkImageAspectFlags AspectMask;
+    };
+
+    [[nodiscard]] constexpr BarrierDescription CreateBarrierDescription(const EOS::ResourceState currentState, const EOS::ResourceState nextState)
+    {
+        return BarrierDescription
+        {
+            .SrcStageMask   = ConvertToVkPipelineStage2(currentState),
+            .SrcAccessMask  = ConvertToVkAccessFlags2(currentState),
+            .DstStageMask   = ConvertToVkPipelineStage2(nextState),
+            .DstAccessMask  = ConvertToVkAccessFlags2(nextState),
+            .OldLayout      = ConvertToVkImageLayout(currentState),
+            .NewLayout      = ConvertToVkImageLayout(nextState),
+            .AspectMask     = ConvertToVkImageAspectFlags(static_cast<EOS::ResourceState>(currentState | nextState)),
+        };
+    }
+
+    [[nodiscard]] VkImageMemoryBarrier2 CreateImageMemoryBarrier(const BarrierDescription& description, const VulkanImage& image, const EOS::SubresourceRange& range);
+    [[nodiscard]] VkImageMemoryBarrier2 CreateImageMemoryBarrier(const VulkanImage& image, EOS::ResourceState currentState, EOS::ResourceState nextState, const EOS::SubresourceRange& range);
+    [[nodiscard]] VkBufferMemoryBarrier2 CreateBufferMemoryBarrier(VkBuffer buffer, EOS::ResourceState currentState, EOS::ResourceState nextState, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
 }
\ No newline at end of file
@@ -1,899 +1,3764 @@
 #include "vulkanClasses.h"
 
+#include <algorithm>
+#include <bit>
 #include <complex>
 #include <cstring>
+#include <fstream>
+#include <limits>
 #include <ranges>
 
 #include "vulkan/vkTools.h"
+#include "utils.h"
 
 #pragma region GLOBAL_FUNCTIONS
-void cmdPipelineBarrier(const EOS::ICommandBuffer& commandBuffer, const std::vector<EOS::GlobalBarrier>& globalBarriers, const std::vector<EOS::ImageBarrier>& imageBarriers)
+void cmdPipelineBarrier(const EOS::ICommandBuffer& commandBuffer, std::span<const EOS::GlobalBarrier> globalBarriers, std::span<const EOS::ImageBarrier> imageBarriers)
 {
     const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
     CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-    std::vector<VkMemoryBarrier2KHR> vkMemoryBarriers;
-    vkMemoryBarriers.reserve(globalBarriers.size());
+    //The barriers are not recorded right away, they are gathered in the commandbuffer and flushed before the next command that needs them.
+    BarrierBatch& pendingBarriers = cmdBuffer->CommandBufferImpl->PendingBarriers;
+    const VkCommandBuffer vkCommandBuffer = cmdBuffer->CommandBufferImpl->VulkanCommandBuffer;
 
-    std::vector<VkImageMemoryBarrier2KHR> vkImageBarriers;
-    vkImageBarriers.reserve(imageBarriers.size());
-
-    for (const auto& barrier : globalBarriers)
+    for (const EOS::GlobalBarrier& barrier : globalBarriers)
     {
-        VkMemoryBarrier2 vkBarrier
+        //Only the given range of the buffer is synchronized
+        if (barrier.Buffer.Valid())
+        {
+            VulkanBuffer* buffer = cmdBuffer->VkContext->BufferPool.Get(barrier.Buffer);
+            CHECK(buffer, "The buffer of the barrier does not exist");
+            if (buffer)
+            {
+                pendingBarriers.AddBufferBarrier(vkCommandBuffer, VkSynchronization::CreateBufferMemoryBarrier(buffer->Buffer, barrier.CurrentState, barrier.NextState, barrier.Offset, barrier.Size));
+
+                //Keep the tracked state in sync when the barrier covers the whole buffer
+                if (barrier.Offset == 0 && (barrier.Size == EOS::WholeSize || barrier.Size >= buffer->Size))
+                {
+                    buffer->CurrentState = barrier.NextState;
+                }
+            }
+            continue;
+        }
+
+        pendingBarriers.AddMemoryBarrier(VkMemoryBarrier2
         {
-            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR,
+            .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2,
             .pNext = nullptr,
             .srcStageMask   = VkSynchronization::ConvertToVkPipelineStage2(barrier.CurrentState),
             .srcAccessMask  = VkSynchronization::ConvertToVkAccessFlags2(barrier.CurrentState),
             .dstStageMask   = VkSynchronization::ConvertToVkPipelineStage2(barrier.NextState),
             .dstAccessMask  = VkSynchronization::ConvertToVkAccessFlags2(barrier.NextState)
-        };
-
-        vkMemoryBarriers.emplace_back(vkBarrier);
+        });
     }
-    VulkanTexturePool&  texturePool = cmdBuffer->VkContext->TexturePool;
 
-    for (const auto&[Texture, CurrentState, NextState] : imageBarriers)
+    VulkanTexturePool& texturePool = cmdBuffer->VkContext->TexturePool;
+    for (const auto&[Texture, CurrentState, NextState, Range] : imageBarriers)
     {
-        const VulkanImage& currentImage = *texturePool.Get(Texture);
-
-        VkImageAspectFlags aspectMask = VkSynchronization::ConvertToVkImageAspectFlags(CurrentState);
-        if (VulkanImage::IsDepthAttachment(currentImage))
-        {
-            aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-        }
+        VulkanImage* currentImage = texturePool.Get(Texture);
+        CHECK(currentImage, "The texture of the barrier does not exist");
+        if (!currentImage) { continue; }
 
-        VkImageMemoryBarrier2 vkBarrier
-        {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR,
-            .pNext = nullptr,
-            .srcStageMask       = VkSynchronization::ConvertToVkPipelineStage2(CurrentState),
-            .srcAccessMask      = VkSynchronization::ConvertToVkAccessFlags2(CurrentState),
-            .dstStageMask       = VkSynchronization::ConvertToVkPipelineStage2(NextState),
-            .dstAccessMask      = VkSynchronization::ConvertToVkAccessFlags2(NextState),
-            .oldLayout          = VkSynchronization::ConvertToVkImageLayout(CurrentState),
-            .newLayout          = VkSynchronization::ConvertToVkImageLayout(NextState),
-            .image              = currentImage.Image,
-            .subresourceRange   = {aspectMask, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS}
-        };
+        pendingBarriers.AddImageBarrier(vkCommandBuffer, VkSynchronization::CreateImageMemoryBarrier(*currentImage, CurrentState, NextState, Range));
 
-        vkImageBarriers.emplace_back(vkBarrier);
+        //Keep the tracked state in sync with the explicit barriers
+        currentImage->SetState(Range, NextState);
     }
-
-    const VkDependencyInfoKHR dependencyInfo
-    {
-        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR,
-        .pNext = nullptr,
-        .dependencyFlags = 0,
-        .memoryBarrierCount = static_cast<uint32_t>(vkMemoryBarriers.size()),
-        .pMemoryBarriers = vkMemoryBarriers.data(),
-        .bufferMemoryBarrierCount = 0,
-        .pBufferMemoryBarriers = nullptr,
-        .imageMemoryBarrierCount = static_cast<uint32_t>(vkImageBarriers.size()),
-        .pImageMemoryBarriers = vkImageBarriers.data()
-    };
-
-    vkCmdPipelineBarrier2(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, &dependencyInfo);
 }
-#pragma endregion
-
 
-
-VulkanImage::VulkanImage(const ImageDescription &description)
-: Image(description.Image)
-, UsageFlags(description.UsageFlags)
-, Extent(description.Extent)
-, ImageType(description.ImageType)
-, ImageFormat(description.ImageFormat)
-, Levels(description.Levels)
-, Layers(description.Layers)
+void cmdTransition(const EOS::ICommandBuffer& commandBuffer, EOS::TextureHandle texture, EOS::ResourceState nextState, const EOS::SubresourceRange& range)
 {
-    VK_ASSERT(VkDebug::SetDebugObjectName(description.Device, VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(Image), description.DebugName));
-    CreateImageView(ImageView, description.Device, Image, ImageType, ImageFormat, Levels, Layers, description.DebugName);
-}
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-VkImageType VulkanImage::ToImageType(const EOS::ImageType imageType)
-{
-    switch (imageType)
+    VulkanImage* image = cmdBuffer->VkContext->TexturePool.Get(texture);
+    CHECK_RETURN(image, "Trying to transition a texture that does not exist");
+
+    CommandBufferData& commandBufferData = *cmdBuffer->CommandBufferImpl;
+    auto transition = [&](const EOS::ResourceState currentState, const EOS::SubresourceRange& subresourceRange)
     {
-        case (EOS::ImageType::Image_1D):
-        case (EOS::ImageType::Image_1D_Array):
-            return VK_IMAGE_TYPE_1D;
+        if (!VkSynchronization::NeedsBarrier(currentState, nextState)) { return; }
+        commandBufferData.PendingBarriers.AddImageBarrier(commandBufferData.VulkanCommandBuffer, VkSynchronization::CreateImageMemoryBarrier(*image, currentState, nextState, subresourceRange));
+    };
 
-        case(EOS::ImageType::Image_2D):
-        case(EOS::ImageType::Image_2D_Array):
-        case(EOS::ImageType::CubeMap):
-        case(EOS::ImageType::CubeMap_Array):
-        case(EOS::ImageType::SwapChain):
-            return VK_IMAGE_TYPE_2D;
+    if (!image->HasSubresourceStates)
+    {
+        transition(image->CurrentState, range);
+    }
+    else
+    {
+        //The subresources are in different states, transition every mip level in runs of layers that share the same state
+        const EOS::SubresourceRange resolvedRange = image->ResolveRange(range);
+        const uint32_t lastMipLevel = resolvedRange.BaseMipLevel + resolvedRange.NumMipLevels;
+        const uint32_t lastArrayLayer = resolvedRange.BaseArrayLayer + resolvedRange.NumArrayLayers;
 
-        case(EOS::ImageType::Image_3D):
-            return  VK_IMAGE_TYPE_3D;
+        for (uint32_t mipLevel = resolvedRange.BaseMipLevel; mipLevel < lastMipLevel; ++mipLevel)
+        {
+            uint32_t runStart = resolvedRange.BaseArrayLayer;
+            for (uint32_t arrayLayer = runStart + 1; arrayLayer <= lastArrayLayer; ++arrayLayer)
+            {
+                const EOS::ResourceState runState = image->GetState(mipLevel, runStart);
+                if (arrayLayer == lastArrayLayer || image->GetState(mipLevel, arrayLayer) != runState)
+                {
+                    transition(runState, {mipLevel, 1, runStart, arrayLayer - runStart});
+                    runStart = arrayLayer;
+                }
+            }
+        }
     }
 
-    return VK_IMAGE_TYPE_MAX_ENUM;
+    image->SetState(range, nextState);
 }
 
-VkImageViewType VulkanImage::ToImageViewType(EOS::ImageType imageType)
+void cmdTransition(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, EOS::ResourceState nextState)
 {
-    switch (imageType)
-    {
-        case (EOS::ImageType::Image_1D):
-            return VK_IMAGE_VIEW_TYPE_1D;
-        case (EOS::ImageType::Image_1D_Array):
-            return VK_IMAGE_VIEW_TYPE_1D_ARRAY;
-        case(EOS::ImageType::Image_2D):
-            return VK_IMAGE_VIEW_TYPE_2D;
-        case(EOS::ImageType::Image_2D_Array):
-            return VK_IMAGE_VIEW_TYPE_2D_ARRAY;
-        case(EOS::ImageType::CubeMap):
-            return VK_IMAGE_VIEW_TYPE_CUBE;
-        case(EOS::ImageType::CubeMap_Array):
-            return VK_IMAGE_VIEW_TYPE_CUBE_ARRAY;
-        case(EOS::ImageType::SwapChain):
-            return VK_IMAGE_VIEW_TYPE_2D;
-        case(EOS::ImageType::Image_3D):
-            return  VK_IMAGE_VIEW_TYPE_3D;
-    }
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-    return VK_IMAGE_VIEW_TYPE_MAX_ENUM;
-}
+    VulkanBuffer* vulkanBuffer = cmdBuffer->VkContext->BufferPool.Get(buffer);
+    CHECK_RETURN(vulkanBuffer, "Trying to transition a buffer that does not exist");
 
-void VulkanImage::CreateImageView(VkImageView& imageView, VkDevice device, VkImage image, const EOS::ImageType imageType,
-    const VkFormat &imageFormat, const uint32_t levels, const uint32_t layers, const char *debugName)
-{
-    const VkImageViewCreateInfo createInfo =
-   {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .image = image,
-        .viewType = ToImageViewType(imageType),
-        .format = imageFormat,
-        .components =  {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
-        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, levels , 0, layers},
-    };
+    if (VkSynchronization::NeedsBarrier(vulkanBuffer->CurrentState, nextState))
+    {
+        CommandBufferData& commandBufferData = *cmdBuffer->CommandBufferImpl;
+        commandBufferData.PendingBarriers.AddBufferBarrier(commandBufferData.VulkanCommandBuffer, VkSynchronization::CreateBufferMemoryBarrier(vulkanBuffer->Buffer, vulkanBuffer->CurrentState, nextState));
+    }
 
-    VK_ASSERT(vkCreateImageView(device, &createInfo, nullptr, &imageView));
-    VK_ASSERT(VkDebug::SetDebugObjectName(device, VK_OBJECT_TYPE_IMAGE_VIEW, reinterpret_cast<uint64_t>(imageView), debugName));
+    vulkanBuffer->CurrentState = nextState;
 }
 
-
-VulkanSwapChain::VulkanSwapChain(const VulkanSwapChainCreationDescription& vulkanSwapChainDescription)
-: VkContext(vulkanSwapChainDescription.vulkanContext)
-, GraphicsQueue(vulkanSwapChainDescription.vulkanContext->VulkanDeviceQueues.Graphics.Queue)
+EOS::SplitBarrierHandle cmdSignalTransition(const EOS::ICommandBuffer& commandBuffer, EOS::TextureHandle texture, EOS::ResourceState nextState, const EOS::SubresourceRange& range)
 {
-    CHECK(VkContext, "VulkanContext is not valid.");
-    CHECK(GraphicsQueue, "GraphicsQueue is not valid.");
-
-
-    //Get details of what we support
-    const VulkanSwapChainSupportDetails supportDetails{*VkContext};
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-    //Get the Surface Format (format and color space)
-    SurfaceFormat = GetSwapChainFormat(supportDetails.formats, VkContext->Configuration.DesiredSwapChainColorSpace);
-    VkPresentModeKHR presentMode {VK_PRESENT_MODE_FIFO_KHR};
+    VulkanContext& context = *cmdBuffer->VkContext;
+    VulkanImage* image = context.TexturePool.Get(texture);
+    CHECK(image, "Trying to transition a texture that does not exist");
+    if (!image) { return {}; }
 
-    // Try using Immediate mode presenting if we are running on a linux machine
-    // For Windows we try to use Mailbox mode
-    // If they are not available we use FIFO
-#if defined(EOS_PLATFORM_WAYLAND) || defined(EOS_PLATFORM_X11)
-    if (std::ranges::find(supportDetails.presentModes, VK_PRESENT_MODE_IMMEDIATE_KHR) != supportDetails.presentModes.cend())
+    //A split barrier can only describe 1 transition, subresources in different states get transitioned right away
+    const std::optional<EOS::ResourceState> currentState = image->GetState(range);
+    if (!currentState)
     {
-        presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+        EOS::Logger->warn("The subresources of the range are in different states, they are transitioned without a split barrier");
+        cmdTransition(commandBuffer, texture, nextState, range);
+        return {};
     }
-#elif defined(EOS_PLATFORM_WIN32)
-    if (std::ranges::find(supportDetails.presentModes, VK_PRESENT_MODE_MAILBOX_KHR) != supportDetails.presentModes.cend())
+
+    if (!VkSynchronization::NeedsBarrier(*currentState, nextState))
     {
-        presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+        image->SetState(range, nextState);
+        return {};
     }
-#endif
-
-    // Check The surface and QueueFamilyIndex
-    VkBool32 queueFamilySupportsPresentation = VK_FALSE;
-    VK_ASSERT(vkGetPhysicalDeviceSurfaceSupportKHR(VkContext->VulkanPhysicalDevice, VkContext->VulkanDeviceQueues.Graphics.QueueFamilyIndex, VkContext->VulkanSurface, &queueFamilySupportsPresentation));
-    CHECK(queueFamilySupportsPresentation == VK_TRUE, "The queue family does not support presentation");
-
-    //Get the device format properties
-    VkFormatProperties properties{};
-    vkGetPhysicalDeviceFormatProperties(VkContext->VulkanPhysicalDevice, SurfaceFormat.format, &properties);
 
-    // Get the imageUsageFlags
-    VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
-    const bool isStorageSupported = (supportDetails.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) > 0;
-    const bool isTilingOptimalSupported = (properties.optimalTilingFeatures & VK_IMAGE_USAGE_STORAGE_BIT > 0);
+    //The pending barriers were recorded before the signal, so they need to happen before the split transition
+    cmdBuffer->FlushBarriers();
 
-    if (isStorageSupported && isTilingOptimalSupported) { usageFlags |= VK_IMAGE_USAGE_STORAGE_BIT; }
-
-    const bool isCompositeAlphaSupported = (supportDetails.capabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) != 0;
+    VulkanSplitBarrier splitBarrier
+    {
+        .Event = context.AcquireEvent(),
+        .Barrier = VkSynchronization::CreateImageMemoryBarrier(*image, *currentState, nextState, range),
+    };
 
-    //Create SwapChain
-    const VkSwapchainCreateInfoKHR createInfo
+    const VkDependencyInfo dependencyInfo
     {
-        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-        .surface = VkContext->VulkanSurface,
-        .minImageCount = supportDetails.capabilities.minImageCount,
-        .imageFormat = SurfaceFormat.format,
-        .imageColorSpace = SurfaceFormat.colorSpace,
-        .imageExtent = {.width = vulkanSwapChainDescription.width, .height = vulkanSwapChainDescription.height},
-        .imageArrayLayers = 1,
-        .imageUsage = usageFlags,
-        .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &VkContext->VulkanDeviceQueues.Graphics.QueueFamilyIndex,
-        .preTransform = supportDetails.capabilities.currentTransform,
-        .compositeAlpha = isCompositeAlphaSupported ? VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR : VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
-        .presentMode = presentMode,
-        .clipped = VK_TRUE,
-        .oldSwapchain = VK_NULL_HANDLE,
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &splitBarrier.Barrier,
     };
-    VK_ASSERT(vkCreateSwapchainKHR(VkContext->VulkanDevice, &createInfo, nullptr, &SwapChain);)
+    vkCmdSetEvent2(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, splitBarrier.Event, &dependencyInfo);
 
-    //Create SwapChain Images
-    VK_ASSERT(vkGetSwapchainImagesKHR(VkContext->VulkanDevice,SwapChain, &NumberOfSwapChainImages, nullptr);)
-    NumberOfSwapChainImages = std::min(NumberOfSwapChainImages, MAX_IMAGES);  //Make sure we don't go over our max defined SwapChain images
-    std::vector<VkImage> swapChainImages(NumberOfSwapChainImages);
-    VK_ASSERT(vkGetSwapchainImagesKHR(VkContext->VulkanDevice, SwapChain, &NumberOfSwapChainImages,swapChainImages.data()));
-    CHECK(NumberOfSwapChainImages >  0, "Number of SwapChain images is 0");
-    CHECK(!swapChainImages.empty(), "The SwapChain images didn't got created");
+    image->SetState(range, nextState);
+    return context.SplitBarrierPool.Create(std::move(splitBarrier));
+}
 
-    AcquireSemaphores.clear();
-    AcquireSemaphores.reserve(NumberOfSwapChainImages);
+void cmdWaitTransition(const EOS::ICommandBuffer& commandBuffer, EOS::SplitBarrierHandle splitBarrier)
+{
+    //No transition was needed when signaling
+    if (splitBarrier.Empty()) { return; }
 
-    Textures.clear();
-    Textures.reserve(NumberOfSwapChainImages);
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-    TimelineWaitValues.resize(NumberOfSwapChainImages);
+    VulkanContext& context = *cmdBuffer->VkContext;
+    const VulkanSplitBarrier* pendingSplitBarrier = context.SplitBarrierPool.Get(splitBarrier);
+    CHECK_RETURN(pendingSplitBarrier, "Trying to wait on a split barrier that has already been waited on");
 
-    ImageDescription swapChainImageDescription
+    //The wait needs the same dependency info as the signal
+    const VkDependencyInfo dependencyInfo
     {
-        .Image = {},
-        .UsageFlags = usageFlags,
-        .Extent = VkExtent3D{.width = vulkanSwapChainDescription.width, .height = vulkanSwapChainDescription.height, .depth = 1},
-        .ImageType = EOS::ImageType::SwapChain,
-        .ImageFormat = SurfaceFormat.format,
-        .Device = VkContext->VulkanDevice,
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .imageMemoryBarrierCount = 1,
+        .pImageMemoryBarriers = &pendingSplitBarrier->Barrier,
     };
 
-    // create images, image views and framebuffers
-    for (uint32_t i{}; i < NumberOfSwapChainImages; ++i)
-    {
-        //Create our Acquire Semaphore for this swapChain image
-        AcquireSemaphores.emplace_back(VkSynchronization::CreateSemaphore(vulkanSwapChainDescription.vulkanContext->VulkanDevice, "SwapChain Acquire Semaphore: " + i));
+    const VkCommandBuffer vkCommandBuffer = cmdBuffer->CommandBufferImpl->VulkanCommandBuffer;
+    vkCmdWaitEvents2(vkCommandBuffer, 1, &pendingSplitBarrier->Event, &dependencyInfo);
 
-        //Create a image
-        swapChainImageDescription.Image = swapChainImages[i];
-        swapChainImageDescription.DebugName = fmt::format("SwapChain Image: {}", i).c_str();
-        VulkanImage swapChainImage{swapChainImageDescription};
+    //Reset the event after the stages that waited on it, so it can be signaled again once it is back in the pool
+    const VkPipelineStageFlags2 resetStage = pendingSplitBarrier->Barrier.dstStageMask ? pendingSplitBarrier->Barrier.dstStageMask : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    vkCmdResetEvent2(vkCommandBuffer, pendingSplitBarrier->Event, resetStage);
 
-        Textures.emplace_back(vulkanSwapChainDescription.vulkanContext->TexturePool.Create(std::move(swapChainImage)));
-    }
+    context.ReleaseEvent(pendingSplitBarrier->Event);
+    context.SplitBarrierPool.Destroy(splitBarrier);
 }
 
-VulkanSwapChain::~VulkanSwapChain()
+void cmdBindShaders(const EOS::ICommandBuffer& commandBuffer, const EOS::RenderPipelineDescription& description)
 {
-    CHECK(VkContext, "VkContext is no longer valid");
-    CHECK(SwapChain != VK_NULL_HANDLE, "The VkSwapChain is no longer valid");
-    CHECK(VkContext->VulkanDevice != VK_NULL_HANDLE, "The VulkanDevice is no longer valid");
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-    for (EOS::TextureHandle handle : Textures)
+    VulkanContext& context = *cmdBuffer->VkContext;
+    CHECK_RETURN(context.HasShaderObjects(), "Shaders can only be bound without a pipeline when the context has shader objects");
+
+    const VulkanShaderModuleState* vertexShader = context.ShaderModulePool.Get(description.VertexShader);
+    CHECK_RETURN(vertexShader && vertexShader->ShaderObject, "Trying to bind the shaders of {} without a vertex shader", description.DebugName);
+    const VulkanShaderModuleState* fragmentShader = context.ShaderModulePool.Get(description.FragmentShader);
+
+    cmdBuffer->BindBindlessHeap();
+
+    //The stages that are not used are bound to nothing, so no shader of an earlier bind stays active in them
+    const VkCommandBuffer vkCommandBuffer = cmdBuffer->CommandBufferImpl->VulkanCommandBuffer;
+    constexpr std::array<VkShaderStageFlagBits, 5> stages
     {
-        VkContext->Destroy(handle);
+        VK_SHADER_STAGE_VERTEX_BIT,
+        VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT,
+        VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT,
+        VK_SHADER_STAGE_GEOMETRY_BIT,
+        VK_SHADER_STAGE_FRAGMENT_BIT,
+    };
+    const std::array<VkShaderEXT, stages.size()> shaders{ vertexShader->ShaderObject, VK_NULL_HANDLE, VK_NULL_HANDLE, VK_NULL_HANDLE, fragmentShader ? fragmentShader->ShaderObject : VK_NULL_HANDLE };
+    vkCmdBindShadersEXT(vkCommandBuffer, static_cast<uint32_t>(stages.size()), stages.data(), shaders.data());
+
+    //The state comes from the same structs a render pipeline of the description would be created with
+    const GraphicsPipelineStates states(RenderPipelineState{ .Description = description });
+
+    vkCmdSetVertexInputEXT(vkCommandBuffer, 0, nullptr, 0, nullptr);
+    vkCmdSetPrimitiveTopology(vkCommandBuffer, states.InputAssembly.topology);
+    vkCmdSetPrimitiveRestartEnable(vkCommandBuffer, states.InputAssembly.primitiveRestartEnable);
+
+    vkCmdSetRasterizerDiscardEnable(vkCommandBuffer, states.Rasterization.rasterizerDiscardEnable);
+    vkCmdSetPolygonModeEXT(vkCommandBuffer, states.Rasterization.polygonMode);
+    vkCmdSetCullMode(vkCommandBuffer, states.Rasterization.cullMode);
+    vkCmdSetFrontFace(vkCommandBuffer, states.Rasterization.frontFace);
+    vkCmdSetLineWidth(vkCommandBuffer, states.Rasterization.lineWidth);
+    vkCmdSetDepthBiasEnable(vkCommandBuffer, states.Rasterization.depthBiasEnable);
+    vkCmdSetDepthBias(vkCommandBuffer, states.Rasterization.depthBiasConstantFactor, states.Rasterization.depthBiasClamp, states.Rasterization.depthBiasSlopeFactor);
+
+    //Without a pipeline nothing falls back to the default line state, once a line feature is enabled it has to be set as well
+    if (context.GetCapabilities().LineRasterization)
+    {
+        vkCmdSetLineRasterizationModeEXT(vkCommandBuffer, VK_LINE_RASTERIZATION_MODE_DEFAULT_EXT);
+        vkCmdSetLineStippleEnableEXT(vkCommandBuffer, VK_FALSE);
     }
 
-    vkDestroySwapchainKHR(VkContext->VulkanDevice, SwapChain, nullptr);
+    constexpr VkSampleMask sampleMask = 0xFFFFFFFF;
+    vkCmdSetRasterizationSamplesEXT(vkCommandBuffer, states.Multisample.rasterizationSamples);
+    vkCmdSetSampleMaskEXT(vkCommandBuffer, states.Multisample.rasterizationSamples, &sampleMask);
+    vkCmdSetAlphaToCoverageEnableEXT(vkCommandBuffer, states.Multisample.alphaToCoverageEnable);
+
+    vkCmdSetDepthTestEnable(vkCommandBuffer, states.DepthStencil.depthTestEnable);
+    vkCmdSetDepthWriteEnable(vkCommandBuffer, states.DepthStencil.depthWriteEnable);
+    vkCmdSetDepthCompareOp(vkCommandBuffer, states.DepthStencil.depthCompareOp);
+    vkCmdSetDepthBoundsTestEnable(vkCommandBuffer, states.DepthStencil.depthBoundsTestEnable);
+    vkCmdSetStencilTestEnable(vkCommandBuffer, states.DepthStencil.stencilTestEnable);
+    for (const auto& [faceMask, stencil] : { std::pair{VK_STENCIL_FACE_FRONT_BIT, states.DepthStencil.front}, std::pair{VK_STENCIL_FACE_BACK_BIT, states.DepthStencil.back} })
+    {
+        vkCmdSetStencilOp(vkCommandBuffer, faceMask, stencil.failOp, stencil.passOp, stencil.depthFailOp, stencil.compareOp);
+        vkCmdSetStencilCompareMask(vkCommandBuffer, faceMask, stencil.compareMask);
+        vkCmdSetStencilWriteMask(vkCommandBuffer, faceMask, stencil.writeMask);
+        vkCmdSetStencilReference(vkCommandBuffer, faceMask, stencil.reference);
+    }
 
-    for (const VkSemaphore& semaphore : AcquireSemaphores)
+    const uint32_t numColorAttachments = states.ColorBlend.attachmentCount;
+    if (numColorAttachments == 0) { return; }
+
+    std::array<VkBool32, EOS::MaxColorAttachments> blendEnables{};
+    std::array<VkColorBlendEquationEXT, EOS::MaxColorAttachments> blendEquations{};
+    std::array<VkColorComponentFlags, EOS::MaxColorAttachments> writeMasks{};
+    for (uint32_t i{}; i < numColorAttachments; ++i)
     {
-        vkDestroySemaphore(VkContext->VulkanDevice, semaphore, nullptr);
+        const VkPipelineColorBlendAttachmentState& blendState = states.BlendStates[i];
+        blendEnables[i] = blendState.blendEnable;
+        blendEquations[i] = { blendState.srcColorBlendFactor, blendState.dstColorBlendFactor, blendState.colorBlendOp, blendState.srcAlphaBlendFactor, blendState.dstAlphaBlendFactor, blendState.alphaBlendOp };
+        writeMasks[i] = blendState.colorWriteMask;
     }
+    vkCmdSetColorBlendEnableEXT(vkCommandBuffer, 0, numColorAttachments, blendEnables.data());
+    vkCmdSetColorBlendEquationEXT(vkCommandBuffer, 0, numColorAttachments, blendEquations.data());
+    vkCmdSetColorWriteMaskEXT(vkCommandBuffer, 0, numColorAttachments, writeMasks.data());
 }
 
-void VulkanSwapChain::Present(VkSemaphore waitSemaphore)
+void cmdBindComputePipeline(const EOS::ICommandBuffer& commandBuffer, EOS::ComputePipelineHandle pipeline)
 {
-    const VkPresentInfoKHR presentInfo =
-    {
-        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = &waitSemaphore,
-        .swapchainCount = 1,
-        .pSwapchains = &SwapChain,
-        .pImageIndices = &CurrentImageIndex,
-    };
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-    const VkResult result = vkQueuePresentKHR(GraphicsQueue, &presentInfo);
-    CHECK(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR, "Couldn't present the SwapChain image");
+    VulkanPipeline* computePipeline = cmdBuffer->VkContext->ComputePipelinePool.Get(pipeline);
+    CHECK_RETURN(computePipeline && computePipeline->Resolve(false), "Trying to bind a compute pipeline that is not ready, check IsPipelineReady() first");
 
-    GetNextImage = true;
-    ++CurrentFrame;
+    cmdBuffer->BindBindlessHeap();
+    vkCmdBindPipeline(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline->Pipeline);
 }
 
-VkImage VulkanSwapChain::GetCurrentImage() const
+void cmdPushConstants(const EOS::ICommandBuffer& commandBuffer, const void* data, uint32_t size, uint32_t offset)
 {
-    CHECK(CurrentImageIndex < NumberOfSwapChainImages, "The Current Image Index is bigger then the amount of SwapChain images we have");
-    return VkContext->TexturePool.Get(Textures[CurrentImageIndex])->Image;
-}
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
 
-VkImageView VulkanSwapChain::GetCurrentImageView() const
-{
-    CHECK(CurrentImageIndex < NumberOfSwapChainImages, "The Current Image Index is bigger then the amount of SwapChain images we have");
-    return VkContext->TexturePool.Get(Textures[CurrentImageIndex])->ImageView;
+    const BindlessHeap& bindless = cmdBuffer->VkContext->GetBindlessHeap();
+    CHECK_RETURN(offset + size <= bindless.GetPushConstantsSize(), "Trying to push {} bytes of constants at offset {}, only {} bytes fit", size, offset, bindless.GetPushConstantsSize());
+    CHECK_RETURN(size % 4 == 0 && offset % 4 == 0, "The size and offset of push constants need to be a multiple of 4");
+
+    vkCmdPushConstants(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, bindless.GetPipelineLayout(), VK_SHADER_STAGE_ALL, offset, size, data);
 }
 
-uint32_t VulkanSwapChain::GetNumSwapChainImages() const
+void cmdDispatch(const EOS::ICommandBuffer& commandBuffer, uint32_t numGroupsX, uint32_t numGroupsY, uint32_t numGroupsZ)
 {
-    return NumberOfSwapChainImages;
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+
+    cmdBuffer->FlushBarriers();
+    vkCmdDispatch(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, numGroupsX, numGroupsY, numGroupsZ);
 }
 
-const VkSurfaceFormatKHR& VulkanSwapChain::GetFormat() const
+void cmdDispatchIndirect(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, uint64_t offset)
 {
-    return SurfaceFormat;
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+
+    const VulkanBuffer* indirectBuffer = cmdBuffer->VkContext->BufferPool.Get(buffer);
+    CHECK_RETURN(indirectBuffer, "Trying to dispatch with an indirect buffer that does not exist");
+    CHECK_RETURN(indirectBuffer->UsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, "The buffer of an indirect dispatch needs the Indirect usage");
+
+    cmdBuffer->FlushBarriers();
+    vkCmdDispatchIndirect(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, indirectBuffer->Buffer, offset);
 }
 
-EOS::TextureHandle VulkanSwapChain::GetCurrentTexture()
+void cmdBeginRendering(const EOS::ICommandBuffer& commandBuffer, const EOS::Framebuffer& framebuffer)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+    CHECK_RETURN(!cmdBuffer->CommandBufferImpl->IsRendering, "Trying to begin rendering while already rendering, call cmdEndRendering first");
+
+    VulkanContext& context = *cmdBuffer->VkContext;
+    constexpr EOS::SubresourceRange attachmentRange{ .NumMipLevels = 1, .NumArrayLayers = 1 };
+    constexpr VkImageLayout colorLayout = VkSynchronization::ConvertToVkImageLayout(EOS::ResourceState::RenderTarget);
+    constexpr VkImageLayout depthLayout = VkSynchronization::ConvertToVkImageLayout(EOS::ResourceState::DepthWrite);
+
+    //The attachment ops are cast straight to their Vulkan values
+    static_assert(static_cast<VkAttachmentLoadOp>(EOS::LoadOp::Load) == VK_ATTACHMENT_LOAD_OP_LOAD);
+    static_assert(static_cast<VkAttachmentLoadOp>(EOS::LoadOp::Clear) == VK_ATTACHMENT_LOAD_OP_CLEAR);
+    static_assert(static_cast<VkAttachmentLoadOp>(EOS::LoadOp::DontCare) == VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    static_assert(static_cast<VkAttachmentStoreOp>(EOS::StoreOp::Store) == VK_ATTACHMENT_STORE_OP_STORE);
+    static_assert(static_cast<VkAttachmentStoreOp>(EOS::StoreOp::DontCare) == VK_ATTACHMENT_STORE_OP_DONT_CARE);
+
+    //All transitions of the attachments get gathered and recorded in 1 barrier right before the rendering starts
+    std::array<VkRenderingAttachmentInfo, EOS::MaxColorAttachments> colorAttachments{};
+    uint32_t numColorAttachments = 0;
+    VkExtent2D extent{};
+
+    for (const EOS::ColorAttachment& attachment : framebuffer.ColorAttachments)
+    {
+        VulkanImage* image = context.TexturePool.Get(attachment.Texture);
+        if (!image) { break; }
+
+        CHECK(VulkanImage::IsColorAttachment(*image), "Color attachment {} can't be rendered into, it needs the Attachment usage", numColorAttachments);
+        CHECK(numColorAttachments == 0 || (image->Extent.width == extent.width && image->Extent.height == extent.height), "All attachments of a framebuffer need to have the same size");
+        extent = { .width = image->Extent.width, .height = image->Extent.height };
+
+        cmdTransition(commandBuffer, attachment.Texture, EOS::ResourceState::RenderTarget, attachmentRange);
+        VkRenderingAttachmentInfo& attachmentInfo = colorAttachments[numColorAttachments++];
+        attachmentInfo =
+        {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .imageView = image->GetAttachmentView(context.VulkanDevice),
+            .imageLayout = colorLayout,
+            .resolveMode = VK_RESOLVE_MODE_NONE,
+            .loadOp = static_cast<VkAttachmentLoadOp>(attachment.Load),
+            .storeOp = static_cast<VkAttachmentStoreOp>(attachment.Store),
+            .clearValue = { .color = { .float32 = { attachment.ClearColor[0], attachment.ClearColor[1], attachment.ClearColor[2], attachment.ClearColor[3] } } },
+        };
+
+        if (VulkanImage* resolveImage = context.TexturePool.Get(attachment.ResolveTexture))
+        {
+            CHECK(image->Samples != VK_SAMPLE_COUNT_1_BIT, "Only multisampled attachments can be resolved");
+            cmdTransition(commandBuffer, attachment.ResolveTexture, EOS::ResourceState::RenderTarget, attachmentRange);
+
+            attachmentInfo.resolveMode = VulkanImage::GetResolveMode(image->ImageFormat);
+            attachmentInfo.resolveImageView = resolveImage->GetAttachmentView(context.VulkanDevice);
+            attachmentInfo.resolveImageLayout = colorLayout;
+        }
+    }
+
+    VkRenderingAttachmentInfo depthAttachment{};
+    VulkanImage* depthImage = context.TexturePool.Get(framebuffer.Depth.Texture);
+    if (depthImage)
+    {
+        CHECK(VulkanImage::IsDepthAttachment(*depthImage), "The depth attachment can't be rendered into, it needs the Attachment usage and a depth format");
+        CHECK(numColorAttachments == 0 || (depthImage->Extent.width == extent.width && depthImage->Extent.height == extent.height), "All attachments of a framebuffer need to have the same size");
+        extent = { .width = depthImage->Extent.width, .height = depthImage->Extent.height };
+
+        cmdTransition(commandBuffer, framebuffer.Depth.Texture, EOS::ResourceState::DepthWrite, attachmentRange);
+        depthAttachment =
+        {
+            .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+            .imageView = depthImage->GetAttachmentView(context.VulkanDevice),
+            .imageLayout = depthLayout,
+            .resolveMode = VK_RESOLVE_MODE_NONE,
+            .loadOp = static_cast<VkAttachmentLoadOp>(framebuffer.Depth.Load),
+            .storeOp = static_cast<VkAttachmentStoreOp>(framebuffer.Depth.Store),
+            .clearValue = { .depthStencil = { .depth = framebuffer.Depth.ClearDepth, .stencil = 0 } },
+        };
+    }
+
+    CHECK_RETURN(numColorAttachments > 0 || depthImage, "Trying to begin rendering without any attachments");
+    cmdBuffer->FlushBarriers();
+
+    //Render pipelines expect a stencil attachment for depth stencil formats, it shares the depth's view and ops
+    const bool hasStencil = depthImage && VulkanImage::HasStencil(depthImage->ImageFormat);
+    const VkRenderingInfo renderingInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+        .renderArea = { .offset = { 0, 0 }, .extent = extent },
+        .layerCount = 1,
+        .colorAttachmentCount = numColorAttachments,
+        .pColorAttachments = colorAttachments.data(),
+        .pDepthAttachment = depthImage ? &depthAttachment : nullptr,
+        .pStencilAttachment = hasStencil ? &depthAttachment : nullptr,
+    };
+
+    const VkCommandBuffer vkCommandBuffer = cmdBuffer->CommandBufferImpl->VulkanCommandBuffer;
+    vkCmdBeginRendering(vkCommandBuffer, &renderingInfo);
+    cmdBuffer->CommandBufferImpl->IsRendering = true;
+
+    const VkViewport viewport{ .x = 0.0f, .y = 0.0f, .width = static_cast<float>(extent.width), .height = static_cast<float>(extent.height), .minDepth = 0.0f, .maxDepth = 1.0f };
+    const VkRect2D scissor{ .offset = { 0, 0 }, .extent = extent };
+    vkCmdSetViewportWithCount(vkCommandBuffer, 1, &viewport);
+    vkCmdSetScissorWithCount(vkCommandBuffer, 1, &scissor);
+}
+
+void cmdEndRendering(const EOS::ICommandBuffer& commandBuffer)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+    CHECK_RETURN(cmdBuffer->CommandBufferImpl->IsRendering, "Trying to end rendering without cmdBeginRendering");
+
+    vkCmdEndRendering(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer);
+    cmdBuffer->CommandBufferImpl->IsRendering = false;
+}
+
+void cmdBindRenderPipeline(const EOS::ICommandBuffer& commandBuffer, EOS::RenderPipelineHandle pipeline)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+
+    VulkanPipeline* renderPipeline = cmdBuffer->VkContext->RenderPipelinePool.Get(pipeline);
+    CHECK_RETURN(renderPipeline && renderPipeline->Resolve(false), "Trying to bind a render pipeline that is not ready, check IsPipelineReady() first");
+
+    cmdBuffer->BindBindlessHeap();
+    vkCmdBindPipeline(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, renderPipeline->Pipeline);
+}
+
+void cmdBindIndexBuffer(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, EOS::IndexFormat indexFormat, uint64_t offset)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+
+    const VulkanBuffer* indexBuffer = cmdBuffer->VkContext->BufferPool.Get(buffer);
+    CHECK_RETURN(indexBuffer, "Trying to bind an index buffer that does not exist");
+    CHECK_RETURN(indexBuffer->UsageFlags & VK_BUFFER_USAGE_INDEX_BUFFER_BIT, "The index buffer needs the Index usage");
+
+    static_assert(static_cast<VkIndexType>(EOS::IndexFormat::UI16) == VK_INDEX_TYPE_UINT16);
+    static_assert(static_cast<VkIndexType>(EOS::IndexFormat::UI32) == VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, indexBuffer->Buffer, offset, static_cast<VkIndexType>(indexFormat));
+}
+
+void cmdDraw(const EOS::ICommandBuffer& commandBuffer, uint32_t numVertices, uint32_t numInstances, uint32_t firstVertex, uint32_t firstInstance)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+    CHECK_RETURN(cmdBuffer->CommandBufferImpl->IsRendering, "Draws can only be recorded between cmdBeginRendering and cmdEndRendering");
+
+    vkCmdDraw(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, numVertices, numInstances, firstVertex, firstInstance);
+}
+
+void cmdDrawIndexed(const EOS::ICommandBuffer& commandBuffer, uint32_t numIndices, uint32_t numInstances, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+    CHECK_RETURN(cmdBuffer->CommandBufferImpl->IsRendering, "Draws can only be recorded between cmdBeginRendering and cmdEndRendering");
+
+    vkCmdDrawIndexed(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, numIndices, numInstances, firstIndex, vertexOffset, firstInstance);
+}
+
+void cmdDrawIndirect(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, uint64_t offset, uint32_t numDraws, uint32_t stride)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+    CHECK_RETURN(cmdBuffer->CommandBufferImpl->IsRendering, "Draws can only be recorded between cmdBeginRendering and cmdEndRendering");
+
+    const VulkanBuffer* indirectBuffer = cmdBuffer->VkContext->BufferPool.Get(buffer);
+    CHECK_RETURN(indirectBuffer, "Trying to draw with an indirect buffer that does not exist");
+    CHECK_RETURN(indirectBuffer->UsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, "The buffer of an indirect draw needs the Indirect usage");
+
+    vkCmdDrawIndirect(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, indirectBuffer->Buffer, offset, numDraws, stride ? stride : static_cast<uint32_t>(sizeof(VkDrawIndirectCommand)));
+}
+
+void cmdDrawIndexedIndirect(const EOS::ICommandBuffer& commandBuffer, EOS::BufferHandle buffer, uint64_t offset, uint32_t numDraws, uint32_t stride)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+    CHECK_RETURN(cmdBuffer->CommandBufferImpl->IsRendering, "Draws can only be recorded between cmdBeginRendering and cmdEndRendering");
+
+    const VulkanBuffer* indirectBuffer = cmdBuffer->VkContext->BufferPool.Get(buffer);
+    CHECK_RETURN(indirectBuffer, "Trying to draw with an indirect buffer that does not exist");
+    CHECK_RETURN(indirectBuffer->UsageFlags & VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, "The buffer of an indirect draw needs the Indirect usage");
+
+    vkCmdDrawIndexedIndirect(cmdBuffer->CommandBufferImpl->VulkanCommandBuffer, indirectBuffer->Buffer, offset, numDraws, stride ? stride : static_cast<uint32_t>(sizeof(VkDrawIndexedIndirectCommand)));
+}
+
+void cmdCopyTextureToBuffer(const EOS::ICommandBuffer& commandBuffer, EOS::TextureHandle texture, EOS::BufferHandle buffer, uint64_t bufferOffset, uint32_t mipLevel, uint32_t arrayLayer)
+{
+    const CommandBuffer* cmdBuffer = static_cast<const CommandBuffer*>(&commandBuffer);
+    CHECK(cmdBuffer, "The commandBuffer is not valid");
+    CHECK_RETURN(!cmdBuffer->CommandBufferImpl->IsRendering, "Copies can't be recorded between cmdBeginRendering and cmdEndRendering");
+
+    const VulkanImage* image = cmdBuffer->VkContext->TexturePool.Get(texture);
+    const VulkanBuffer* dstBuffer = cmdBuffer->VkContext->BufferPool.Get(buffer);
+    CHECK_RETURN(image && dstBuffer, "Trying to copy from a texture or into a buffer that does not exist");
+    CHECK_RETURN(mipLevel < image->Levels && arrayLayer < image->Layers, "The mip level {} or layer {} is not part of the texture", mipLevel, arrayLayer);
+    CHECK_RETURN(image->UsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT, "Memoryless textures never leave the render pass, they can't be copied from");
+    CHECK_RETURN(!VulkanImage::IsDepthFormat(image->ImageFormat), "Copying from depth textures is not supported");
+
+    const uint32_t bytesPerTexel = VulkanImage::GetBytesPerTexel(image->ImageFormat);
+    CHECK_RETURN(bytesPerTexel, "Copying from textures of this format is not supported");
+
+    const VkExtent3D extent = image->GetMipExtent(mipLevel);
+    const uint64_t size = static_cast<uint64_t>(extent.width) * extent.height * extent.depth * bytesPerTexel;
+    CHECK_RETURN(bufferOffset + size <= dstBuffer->Size, "The {} bytes of the texture at offset {} don't fit in the buffer", size, bufferOffset);
+
+    const EOS::SubresourceRange range{ .BaseMipLevel = mipLevel, .NumMipLevels = 1, .BaseArrayLayer = arrayLayer, .NumArrayLayers = 1 };
+    cmdTransition(commandBuffer, texture, EOS::ResourceState::CopySource, range);
+    cmdTransition(commandBuffer, buffer, EOS::ResourceState::CopyDest);
+    cmdBuffer->FlushBarriers();
+
+    const VkCommandBuffer vkCommandBuffer = cmdBuffer->CommandBufferImpl->VulkanCommandBuffer;
+    const VkBufferImageCopy copy
+    {
+        .bufferOffset = bufferOffset,
+        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, arrayLayer, 1},
+        .imageExtent = extent,
+    };
+    vkCmdCopyImageToBuffer(vkCommandBuffer, image->Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, dstBuffer->Buffer, 1, &copy);
+
+    //Waiting on the submission only makes the copy available to the device, the host needs its own barrier to see the texels
+    const VkBufferMemoryBarrier2 hostBarrier
+    {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2,
+        .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT,
+        .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT,
+        .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = dstBuffer->Buffer,
+        .offset = bufferOffset,
+        .size = size,
+    };
+    const VkDependencyInfo dependencyInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .bufferMemoryBarrierCount = 1,
+        .pBufferMemoryBarriers = &hostBarrier,
+    };
+    vkCmdPipelineBarrier2(vkCommandBuffer, &dependencyInfo);
+}
+#pragma endregion
+
+
+
+VulkanImage::VulkanImage(const ImageDescription &description)
+: Image(description.Image)
+, UsageFlags(description.UsageFlags)
+, Extent(description.Extent)
+, ImageType(description.ImageType)
+, ImageFormat(description.ImageFormat)
+, Levels(description.Levels)
+, Layers(description.Layers)
+{
+    VK_ASSERT(VkDebug::SetDebugObjectName(description.Device, VK_OBJECT_TYPE_IMAGE, reinterpret_cast<uint64_t>(Image), description.DebugName));
+    CreateImageView(ImageView, description.Device, Image, ImageType, ImageFormat, Levels, Layers, description.DebugName);
+
+    //Images with more than 1 subresource can end up with their subresources in different states
+    if (Levels * Layers > 1)
+    {
+        SubresourceStates.resize(Levels * Layers, EOS::ResourceState::Undefined);
+    }
+}
+
+EOS::SubresourceRange VulkanImage::ResolveRange(const EOS::SubresourceRange& range) const
+{
+    CHECK(range.BaseMipLevel < Levels && range.BaseArrayLayer < Layers, "The subresource range starts outside of the image");
+
+    return EOS::SubresourceRange
+    {
+        .BaseMipLevel   = range.BaseMipLevel,
+        .NumMipLevels   = range.NumMipLevels == EOS::RemainingMipLevels ? Levels - range.BaseMipLevel : range.NumMipLevels,
+        .BaseArrayLayer = range.BaseArrayLayer,
+        .NumArrayLayers = range.NumArrayLayers == EOS::RemainingArrayLayers ? Layers - range.BaseArrayLayer : range.NumArrayLayers,
+    };
+}
+
+bool VulkanImage::IsWholeImage(const EOS::SubresourceRange& range) const
+{
+    const EOS::SubresourceRange resolvedRange = ResolveRange(range);
+    return resolvedRange.BaseMipLevel == 0 && resolvedRange.NumMipLevels == Levels && resolvedRange.BaseArrayLayer == 0 && resolvedRange.NumArrayLayers == Layers;
+}
+
+VkExtent3D VulkanImage::GetMipExtent(const uint32_t mipLevel) const
+{
+    return
+    {
+        .width = std::max(1u, Extent.width >> mipLevel),
+        .height = std::max(1u, Extent.height >> mipLevel),
+        .depth = std::max(1u, Extent.depth >> mipLevel),
+    };
+}
+
+VkImageView VulkanImage::GetAttachmentView(VkDevice device)
+{
+    //The default view can be used when it has 1 subresource, unless it leaves out the stencil of a depth stencil format
+    const bool hasStencil = HasStencil(ImageFormat);
+    if (Levels == 1 && Layers == 1 && !hasStencil) { return ImageView; }
+
+    VkImageView& attachmentView = ImageViewForFramebuffer[0][0];
+    if (attachmentView == VK_NULL_HANDLE)
+    {
+        const VkImageAspectFlags aspectMask = hasStencil ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : IsDepthFormat(ImageFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+        const VkImageViewCreateInfo createInfo =
+        {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .image = Image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = ImageFormat,
+            .components = {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
+            .subresourceRange = {aspectMask, 0, 1, 0, 1},
+        };
+
+        VK_ASSERT(vkCreateImageView(device, &createInfo, nullptr, &attachmentView));
+        VK_ASSERT(VkDebug::SetDebugObjectName(device, VK_OBJECT_TYPE_IMAGE_VIEW, reinterpret_cast<uint64_t>(attachmentView), "ImageView: Attachment"));
+    }
+
+    return attachmentView;
+}
+
+EOS::ResourceState VulkanImage::GetState(const uint32_t mipLevel, const uint32_t arrayLayer) const
+{
+    if (!HasSubresourceStates) { return CurrentState; }
+    return SubresourceStates[arrayLayer * Levels + mipLevel];
+}
+
+std::optional<EOS::ResourceState> VulkanImage::GetState(const EOS::SubresourceRange& range) const
+{
+    if (!HasSubresourceStates) { return CurrentState; }
+
+    const EOS::SubresourceRange resolvedRange = ResolveRange(range);
+    const EOS::ResourceState state = GetState(resolvedRange.BaseMipLevel, resolvedRange.BaseArrayLayer);
+    for (uint32_t arrayLayer = resolvedRange.BaseArrayLayer; arrayLayer < resolvedRange.BaseArrayLayer + resolvedRange.NumArrayLayers; ++arrayLayer)
+    {
+        for (uint32_t mipLevel = resolvedRange.BaseMipLevel; mipLevel < resolvedRange.BaseMipLevel + resolvedRange.NumMipLevels; ++mipLevel)
+        {
+            if (GetState(mipLevel, arrayLayer) != state) { return std::nullopt; }
+        }
+    }
+
+    return state;
+}
+
+void VulkanImage::SetState(const EOS::SubresourceRange& range, const EOS::ResourceState state)
+{
+    if (IsWholeImage(range))
+    {
+        CurrentState = state;
+        HasSubresourceStates = false;
+        return;
+    }
+
+    //The storage is allocated with the image, so this only fills it in
+    if (!HasSubresourceStates)
+    {
+        std::ranges::fill(SubresourceStates, CurrentState);
+        HasSubresourceStates = true;
+    }
+
+    const EOS::SubresourceRange resolvedRange = ResolveRange(range);
+    for (uint32_t arrayLayer = resolvedRange.BaseArrayLayer; arrayLayer < resolvedRange.BaseArrayLayer + resolvedRange.NumArrayLayers; ++arrayLayer)
+    {
+        for (uint32_t mipLevel = resolvedRange.BaseMipLevel; mipLevel < resolvedRange.BaseMipLevel + resolvedRange.NumMipLevels; ++mipLevel)
+        {
+            SubresourceStates[arrayLayer * Levels + mipLevel] = state;
+        }
+    }
+
+    //Once every subresource ended up in the same state we can go back to tracking 1 state for the whole image
+    if (std::ranges::all_of(SubresourceStates, [state](const EOS::ResourceState subresourceState){ return subresourceState == state; }))
+    {
+        CurrentState = state;
+        HasSubresourceStates = false;
+    }
+}
+
+VkImageType VulkanImage::ToImageType(const EOS::ImageType imageType)
+{
+    switch (imageType)
+    {
+        case (EOS::ImageType::Image_1D):
+        case (EOS::ImageType::Image_1D_Array):
+            return VK_IMAGE_TYPE_1D;
+
+        case(EOS::ImageType::Image_2D):
+        case(EOS::ImageType::Image_2D_Array):
+        case(EOS::ImageType::CubeMap):
+        case(EOS::ImageType::CubeMap_Array):
+        case(EOS::ImageType::SwapChain):
+            return VK_IMAGE_TYPE_2D;
+
+        case(EOS::ImageType::Image_3D):
+            return  VK_IMAGE_TYPE_3D;
+    }
+
+    return VK_IMAGE_TYPE_MAX_ENUM;
+}
+
+VkImageViewType VulkanImage::ToImageViewType(EOS::ImageType imageType)
+{
+    switch (imageType)
+    {
+        case (EOS::ImageType::Image_1D):
+            return VK_IMAGE_VIEW_TYPE_1D;
+        case (EOS::ImageType::Image_1D_Array):
+            return VK_IMAGE_VIEW_TYPE_1D_ARRAY;
+        case(EOS::ImageType::Image_2D):
+            return VK_IMAGE_VIEW_TYPE_2D;
+        case(EOS::ImageType::Image_2D_Array):
+            return VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+        case(EOS::ImageType::CubeMap):
+            return VK_IMAGE_VIEW_TYPE_CUBE;
+        case(EOS::ImageType::CubeMap_Array):
+            return VK_IMAGE_VIEW_TYPE_CUBE_ARRAY;
+        case(EOS::ImageType::SwapChain):
+            return VK_IMAGE_VIEW_TYPE_2D;
+        case(EOS::ImageType::Image_3D):
+            return  VK_IMAGE_VIEW_TYPE_3D;
+    }
+
+    return VK_IMAGE_VIEW_TYPE_MAX_ENUM;
+}
+
+VkFormat VulkanImage::ToVkFormat(const EOS::Format format)
+{
+    switch (format)
+    {
+        case EOS::Format::Invalid:      return VK_FORMAT_UNDEFINED;
+        case EOS::Format::R_UN8:        return VK_FORMAT_R8_UNORM;
+        case EOS::Format::RG_UN8:       return VK_FORMAT_R8G8_UNORM;
+        case EOS::Format::RGBA_UN8:     return VK_FORMAT_R8G8B8A8_UNORM;
+        case EOS::Format::BGRA_UN8:     return VK_FORMAT_B8G8R8A8_UNORM;
+        case EOS::Format::RGBA_SRGB8:   return VK_FORMAT_R8G8B8A8_SRGB;
+        case EOS::Format::BGRA_SRGB8:   return VK_FORMAT_B8G8R8A8_SRGB;
+        case EOS::Format::R_F16:        return VK_FORMAT_R16_SFLOAT;
+        case EOS::Format::RG_F16:       return VK_FORMAT_R16G16_SFLOAT;
+        case EOS::Format::RGBA_F16:     return VK_FORMAT_R16G16B16A16_SFLOAT;
+        case EOS::Format::R_F32:        return VK_FORMAT_R32_SFLOAT;
+        case EOS::Format::RG_F32:       return VK_FORMAT_R32G32_SFLOAT;
+        case EOS::Format::RGBA_F32:     return VK_FORMAT_R32G32B32A32_SFLOAT;
+        case EOS::Format::R_UI32:       return VK_FORMAT_R32_UINT;
+        case EOS::Format::RGB10_A2_UN:  return VK_FORMAT_A2B10G10R10_UNORM_PACK32;
+        case EOS::Format::Z_UN16:       return VK_FORMAT_D16_UNORM;
+        case EOS::Format::Z_UN24:       return VK_FORMAT_X8_D24_UNORM_PACK32;
+        case EOS::Format::Z_F32:        return VK_FORMAT_D32_SFLOAT;
+        case EOS::Format::Z_UN24_S_UI8: return VK_FORMAT_D24_UNORM_S8_UINT;
+        case EOS::Format::Z_F32_S_UI8:  return VK_FORMAT_D32_SFLOAT_S8_UINT;
+    }
+
+    return VK_FORMAT_UNDEFINED;
+}
+
+EOS::Format VulkanImage::ToFormat(const VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8_UNORM:                    return EOS::Format::R_UN8;
+        case VK_FORMAT_R8G8_UNORM:                  return EOS::Format::RG_UN8;
+        case VK_FORMAT_R8G8B8A8_UNORM:              return EOS::Format::RGBA_UN8;
+        case VK_FORMAT_B8G8R8A8_UNORM:              return EOS::Format::BGRA_UN8;
+        case VK_FORMAT_R8G8B8A8_SRGB:               return EOS::Format::RGBA_SRGB8;
+        case VK_FORMAT_B8G8R8A8_SRGB:               return EOS::Format::BGRA_SRGB8;
+        case VK_FORMAT_R16_SFLOAT:                  return EOS::Format::R_F16;
+        case VK_FORMAT_R16G16_SFLOAT:               return EOS::Format::RG_F16;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:         return EOS::Format::RGBA_F16;
+        case VK_FORMAT_R32_SFLOAT:                  return EOS::Format::R_F32;
+        case VK_FORMAT_R32G32_SFLOAT:               return EOS::Format::RG_F32;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:         return EOS::Format::RGBA_F32;
+        case VK_FORMAT_R32_UINT:                    return EOS::Format::R_UI32;
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:    return EOS::Format::RGB10_A2_UN;
+        case VK_FORMAT_D16_UNORM:                   return EOS::Format::Z_UN16;
+        case VK_FORMAT_X8_D24_UNORM_PACK32:         return EOS::Format::Z_UN24;
+        case VK_FORMAT_D32_SFLOAT:                  return EOS::Format::Z_F32;
+        case VK_FORMAT_D24_UNORM_S8_UINT:           return EOS::Format::Z_UN24_S_UI8;
+        case VK_FORMAT_D32_SFLOAT_S8_UINT:          return EOS::Format::Z_F32_S_UI8;
+        default:                                    return EOS::Format::Invalid;
+    }
+}
+
+bool VulkanImage::IsDepthFormat(const VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM || format == VK_FORMAT_X8_D24_UNORM_PACK32 || format == VK_FORMAT_D32_SFLOAT || HasStencil(format);
+}
+
+bool VulkanImage::HasStencil(const VkFormat format)
+{
+    return format == VK_FORMAT_D16_UNORM_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_S8_UINT;
+}
+
+bool VulkanImage::IsIntegerFormat(const VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8_UINT:
+        case VK_FORMAT_R8_SINT:
+        case VK_FORMAT_R8G8_UINT:
+        case VK_FORMAT_R8G8_SINT:
+        case VK_FORMAT_R8G8B8A8_UINT:
+        case VK_FORMAT_R8G8B8A8_SINT:
+        case VK_FORMAT_B8G8R8A8_UINT:
+        case VK_FORMAT_B8G8R8A8_SINT:
+        case VK_FORMAT_A2B10G10R10_UINT_PACK32:
+        case VK_FORMAT_A2R10G10B10_UINT_PACK32:
+        case VK_FORMAT_R16_UINT:
+        case VK_FORMAT_R16_SINT:
+        case VK_FORMAT_R16G16_UINT:
+        case VK_FORMAT_R16G16_SINT:
+        case VK_FORMAT_R16G16B16A16_UINT:
+        case VK_FORMAT_R16G16B16A16_SINT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_R32_SINT:
+        case VK_FORMAT_R32G32_UINT:
+        case VK_FORMAT_R32G32_SINT:
+        case VK_FORMAT_R32G32B32A32_UINT:
+        case VK_FORMAT_R32G32B32A32_SINT:
+        case VK_FORMAT_R64_UINT:
+        case VK_FORMAT_R64_SINT:
+        case VK_FORMAT_S8_UINT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+VkResolveModeFlagBits VulkanImage::GetResolveMode(const VkFormat format)
+{
+    return IsIntegerFormat(format) || IsDepthFormat(format) ? VK_RESOLVE_MODE_SAMPLE_ZERO_BIT : VK_RESOLVE_MODE_AVERAGE_BIT;
+}
+
+uint32_t VulkanImage::GetBytesPerTexel(const VkFormat format)
+{
+    switch (format)
+    {
+        case VK_FORMAT_R8_UNORM:
+            return 1;
+        case VK_FORMAT_R8G8_UNORM:
+        case VK_FORMAT_R16_SFLOAT:
+        case VK_FORMAT_D16_UNORM:
+            return 2;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+        case VK_FORMAT_X8_D24_UNORM_PACK32:
+        case VK_FORMAT_D32_SFLOAT:
+            return 4;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+        case VK_FORMAT_R32G32_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+void VulkanImage::CreateImageView(VkImageView& imageView, VkDevice device, VkImage image, const EOS::ImageType imageType,
+    const VkFormat &imageFormat, const uint32_t levels, const uint32_t layers, const char *debugName)
+{
+    //A view can only be sampled through 1 aspect, for depth stencil formats that is the depth
+    const VkImageAspectFlags aspectMask = IsDepthFormat(imageFormat) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+
+    const VkImageViewCreateInfo createInfo =
+   {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .image = image,
+        .viewType = ToImageViewType(imageType),
+        .format = imageFormat,
+        .components =  {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
+        .subresourceRange = {aspectMask, 0, levels , 0, layers},
+    };
+
+    VK_ASSERT(vkCreateImageView(device, &createInfo, nullptr, &imageView));
+    VK_ASSERT(VkDebug::SetDebugObjectName(device, VK_OBJECT_TYPE_IMAGE_VIEW, reinterpret_cast<uint64_t>(imageView), debugName));
+}
+
+
+VulkanSwapChain::VulkanSwapChain(const VulkanSwapChainCreationDescription& vulkanSwapChainDescription)
+: VkContext(vulkanSwapChainDescription.vulkanContext)
+, GraphicsQueue(vulkanSwapChainDescription.vulkanContext->VulkanDeviceQueues.Graphics.Queue)
+{
+    CHECK(VkContext, "VulkanContext is not valid.");
+    CHECK(GraphicsQueue, "GraphicsQueue is not valid.");
+
+
+    //Get details of what we support
+    const VulkanSwapChainSupportDetails supportDetails{*VkContext};
+
+    //Get the Surface Format (format and color space)
+    SurfaceFormat = GetSwapChainFormat(supportDetails.formats, VkContext->Configuration.DesiredSwapChainColorSpace);
+    VkPresentModeKHR presentMode {VK_PRESENT_MODE_FIFO_KHR};
+
+    // Try using Immediate mode presenting if we are running on a linux machine
+    // For Windows we try to use Mailbox mode
+    // If they are not available we use FIFO
+#if defined(EOS_PLATFORM_WAYLAND) || defined(EOS_PLATFORM_X11)
+    if (std::ranges::find(supportDetails.presentModes, VK_PRESENT_MODE_IMMEDIATE_KHR) != supportDetails.presentModes.cend())
+    {
+        presentMode = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    }
+#elif defined(EOS_PLATFORM_WIN32)
+    if (std::ranges::find(supportDetails.presentModes, VK_PRESENT_MODE_MAILBOX_KHR) != supportDetails.presentModes.cend())
+    {
+        presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    }
+#endif
+
+    // Check The surface and QueueFamilyIndex
+    VkBool32 queueFamilySupportsPresentation = VK_FALSE;
+    VK_ASSERT(vkGetPhysicalDeviceSurfaceSupportKHR(VkContext->VulkanPhysicalDevice, VkContext->VulkanDeviceQueues.Graphics.QueueFamilyIndex, VkContext->VulkanSurface, &queueFamilySupportsPresentation));
+    CHECK(queueFamilySupportsPresentation == VK_TRUE, "The queue family does not support presentation");
+
+    //Get the device format properties
+    VkFormatProperties properties{};
+    vkGetPhysicalDeviceFormatProperties(VkContext->VulkanPhysicalDevice, SurfaceFormat.format, &properties);
+
+    // Get the imageUsageFlags
+    VkImageUsageFlags usageFlags = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    const bool isStorageSupported = (supportDetails.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_STORAGE_BIT) > 0;
+    const bool isTilingOptimalSupported = (properties.optimalTilingFeatures & VK_IMAGE_USAGE_STORAGE_BIT > 0);
+
+    if (isStorageSupported && isTilingOptimalSupported) { usageFlags |= VK_IMAGE_USAGE_STORAGE_BIT; }
+
+    const bool isCompositeAlphaSupported = (supportDetails.capabilities.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) != 0;
+
+    //Create SwapChain
+    const VkSwapchainCreateInfoKHR createInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+        .surface = VkContext->VulkanSurface,
+        .minImageCount = supportDetails.capabilities.minImageCount,
+        .imageFormat = SurfaceFormat.format,
+        .imageColorSpace = SurfaceFormat.colorSpace,
+        .imageExtent = {.width = vulkanSwapChainDescription.width, .height = vulkanSwapChainDescription.height},
+        .imageArrayLayers = 1,
+        .imageUsage = usageFlags,
+        .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &VkContext->VulkanDeviceQueues.Graphics.QueueFamilyIndex,
+        .preTransform = supportDetails.capabilities.currentTransform,
+        .compositeAlpha = isCompositeAlphaSupported ? VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR : VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
+        .presentMode = presentMode,
+        .clipped = VK_TRUE,
+        .oldSwapchain = VK_NULL_HANDLE,
+    };
+    VK_ASSERT(vkCreateSwapchainKHR(VkContext->VulkanDevice, &createInfo, nullptr, &SwapChain);)
+
+    //Create SwapChain Images
+    VK_ASSERT(vkGetSwapchainImagesKHR(VkContext->VulkanDevice,SwapChain, &NumberOfSwapChainImages, nullptr);)
+    NumberOfSwapChainImages = std::min(NumberOfSwapChainImages, MAX_IMAGES);  //Make sure we don't go over our max defined SwapChain images
+    std::vector<VkImage> swapChainImages(NumberOfSwapChainImages);
+    VK_ASSERT(vkGetSwapchainImagesKHR(VkContext->VulkanDevice, SwapChain, &NumberOfSwapChainImages,swapChainImages.data()));
+    CHECK(NumberOfSwapChainImages >  0, "Number of SwapChain images is 0");
+    CHECK(!swapChainImages.empty(), "The SwapChain images didn't got created");
+
+    AcquireSemaphores.clear();
+    AcquireSemaphores.reserve(NumberOfSwapChainImages);
+
+    Textures.clear();
+    Textures.reserve(NumberOfSwapChainImages);
+
+    TimelineWaitValues.resize(NumberOfSwapChainImages);
+
+    ImageDescription swapChainImageDescription
+    {
+        .Image = {},
+        .UsageFlags = usageFlags,
+        .Extent = VkExtent3D{.width = vulkanSwapChainDescription.width, .height = vulkanSwapChainDescription.height, .depth = 1},
+        .ImageType = EOS::ImageType::SwapChain,
+        .ImageFormat = SurfaceFormat.format,
+        .Device = VkContext->VulkanDevice,
+    };
+
+    // create images, image views and framebuffers
+    for (uint32_t i{}; i < NumberOfSwapChainImages; ++i)
+    {
+        //Create our Acquire Semaphore for this swapChain image
+        AcquireSemaphores.emplace_back(VkSynchronization::CreateSemaphore(vulkanSwapChainDescription.vulkanContext->VulkanDevice, "SwapChain Acquire Semaphore: " + i));
+
+        //Create a image
+        swapChainImageDescription.Image = swapChainImages[i];
+        swapChainImageDescription.DebugName = fmt::format("SwapChain Image: {}", i).c_str();
+        VulkanImage swapChainImage{swapChainImageDescription};
+        swapChainImage.IsOwningImage = false;   // the images are owned by the swapchain
+
+        Textures.emplace_back(vulkanSwapChainDescription.vulkanContext->TexturePool.Create(std::move(swapChainImage)));
+    }
+}
+
+VulkanSwapChain::~VulkanSwapChain()
+{
+    CHECK(VkContext, "VkContext is no longer valid");
+    CHECK(SwapChain != VK_NULL_HANDLE, "The VkSwapChain is no longer valid");
+    CHECK(VkContext->VulkanDevice != VK_NULL_HANDLE, "The VulkanDevice is no longer valid");
+
+    for (EOS::TextureHandle handle : Textures)
+    {
+        VkContext->Destroy(handle);
+    }
+
+    vkDestroySwapchainKHR(VkContext->VulkanDevice, SwapChain, nullptr);
+
+    for (const VkSemaphore& semaphore : AcquireSemaphores)
+    {
+        vkDestroySemaphore(VkContext->VulkanDevice, semaphore, nullptr);
+    }
+}
+
+void VulkanSwapChain::Present(VkSemaphore waitSemaphore)
+{
+    const VkPresentInfoKHR presentInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &waitSemaphore,
+        .swapchainCount = 1,
+        .pSwapchains = &SwapChain,
+        .pImageIndices = &CurrentImageIndex,
+    };
+
+    const VkResult result = vkQueuePresentKHR(GraphicsQueue, &presentInfo);
+    CHECK(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR, "Couldn't present the SwapChain image");
+
+    GetNextImage = true;
+    ++CurrentFrame;
+}
+
+VkImage VulkanSwapChain::GetCurrentImage() const
+{
+    CHECK(CurrentImageIndex < NumberOfSwapChainImages, "The Current Image Index is bigger then the amount of SwapChain images we have");
+    return VkContext->TexturePool.Get(Textures[CurrentImageIndex])->Image;
+}
+
+VkImageView VulkanSwapChain::GetCurrentImageView() const
+{
+    CHECK(CurrentImageIndex < NumberOfSwapChainImages, "The Current Image Index is bigger then the amount of SwapChain images we have");
+    return VkContext->TexturePool.Get(Textures[CurrentImageIndex])->ImageView;
+}
+
+uint32_t VulkanSwapChain::GetNumSwapChainImages() const
+{
+    return NumberOfSwapChainImages;
+}
+
+const VkSurfaceFormatKHR& VulkanSwapChain::GetFormat() const
+{
+    return SurfaceFormat;
+}
+
+EOS::TextureHandle VulkanSwapChain::GetCurrentTexture()
 {
     GetAndWaitOnNextImage();
     CHECK(CurrentImageIndex < NumberOfSwapChainImages, "The Current Image Index is bigger then the amount of SwapChain images we have");
     return Textures[CurrentImageIndex];
 }
 
-void VulkanSwapChain::GetAndWaitOnNextImage()
-{
-    //Get The Next SwapChain Image
-    if (GetNextImage)
+void VulkanSwapChain::GetAndWaitOnNextImage()
+{
+    //Get The Next SwapChain Image
+    if (GetNextImage)
+    {
+        const VkSemaphoreWaitInfo waitInfo =
+        {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &VkContext->TimelineSemaphore,
+            .pValues = &TimelineWaitValues[CurrentImageIndex],
+        };
+
+        // when timeout is set to UINT64_MAX, we wait until the next image has been acquired
+        VK_ASSERT(vkWaitSemaphores(VkContext->VulkanDevice, &waitInfo, UINT64_MAX));
+
+        VkSemaphore& acquireSemaphore = AcquireSemaphores[CurrentImageIndex];
+        const VkResult result = vkAcquireNextImageKHR(VkContext->VulkanDevice, SwapChain, UINT64_MAX, acquireSemaphore, VK_NULL_HANDLE, &CurrentImageIndex);
+        CHECK(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR, "vkAcquireNextImageKHR Failed");
+
+        GetNextImage = false;
+        VkContext->VulkanCommandPool->WaitSemaphore(acquireSemaphore);
+    }
+}
+
+VkSurfaceFormatKHR VulkanSwapChain::GetSwapChainFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats, EOS::ColorSpace desiredColorSpace)
+{
+    //TODO: Look into VkSurfaceFormat2KHR -> this enables Compression of the swapChain image
+    //https://docs.vulkan.org/samples/latest/samples/performance/image_compression_control/README.html
+
+    //Non Linear is the default
+    VkSurfaceFormatKHR preferred{VK_FORMAT_R8G8B8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+    if (desiredColorSpace == EOS::ColorSpace::SRGB_Linear)
+    {
+        // VK_COLOR_SPACE_BT709_LINEAR_EXT is the closest space to linear
+        preferred  = VkSurfaceFormatKHR{VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_BT709_LINEAR_EXT};
+    }
+
+    //Check if we have a combination with our desired format & color space
+    for (const VkSurfaceFormatKHR& fmt : availableFormats)
+    {
+        if (fmt.format == preferred.format && fmt.colorSpace == preferred.colorSpace) { return fmt; }
+    }
+
+    // if we can't find a matching format and color space, fallback on matching only format
+    for (const VkSurfaceFormatKHR& fmt : availableFormats)
+    {
+        if (fmt.format == preferred.format) { return fmt; }
+    }
+
+    //If we still haven't found a format we just pick the first available option
+    return availableFormats[0];
+}
+
+
+VulkanSwapChainSupportDetails::VulkanSwapChainSupportDetails(const VulkanContext& vulkanContext)
+{
+    //Get Surface Capabilities
+    VK_ASSERT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &capabilities));
+
+    //Get the Surface Support
+    VK_ASSERT(vkGetPhysicalDeviceSurfaceSupportKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanDeviceQueues.Graphics.QueueFamilyIndex, vulkanContext.VulkanSurface, &queueFamilySupportsPresentation));
+
+    //Get the available Surface Formats
+    uint32_t formatCount;
+    VK_ASSERT(vkGetPhysicalDeviceSurfaceFormatsKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &formatCount, nullptr));
+    formats.resize(formatCount);
+    VK_ASSERT(vkGetPhysicalDeviceSurfaceFormatsKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &formatCount, formats.data()));
+
+    //Get the available Present Modes
+    uint32_t presentModeCount;
+    VK_ASSERT(vkGetPhysicalDeviceSurfacePresentModesKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &presentModeCount, nullptr));
+    presentModes.resize(presentModeCount);
+    VK_ASSERT(vkGetPhysicalDeviceSurfacePresentModesKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &presentModeCount, presentModes.data()));
+}
+
+void BarrierBatch::AddMemoryBarrier(const VkMemoryBarrier2& barrier)
+{
+    //Global memory barriers can always be folded into 1, the union of both scopes covers both dependencies.
+    PendingMemoryBarrier.srcStageMask  |= barrier.srcStageMask;
+    PendingMemoryBarrier.srcAccessMask |= barrier.srcAccessMask;
+    PendingMemoryBarrier.dstStageMask  |= barrier.dstStageMask;
+    PendingMemoryBarrier.dstAccessMask |= barrier.dstAccessMask;
+    HasMemoryBarrier = true;
+}
+
+void BarrierBatch::AddImageBarrier(VkCommandBuffer commandBuffer, const VkImageMemoryBarrier2& barrier)
+{
+    if (IsRedundant(barrier)) { return; }
+
+    for (uint32_t i{}; i < NumImageBarriers; ++i)
+    {
+        VkImageMemoryBarrier2& pending = ImageBarriers[i];
+        if (pending.image != barrier.image || !Overlaps(pending.subresourceRange, barrier.subresourceRange)) { continue; }
+
+        const bool isSameRange = pending.subresourceRange.baseMipLevel == barrier.subresourceRange.baseMipLevel && pending.subresourceRange.levelCount == barrier.subresourceRange.levelCount &&
+                                 pending.subresourceRange.baseArrayLayer == barrier.subresourceRange.baseArrayLayer && pending.subresourceRange.layerCount == barrier.subresourceRange.layerCount;
+
+        //No work has been recorded between both barriers, so a transition A -> B followed by B -> C can be recorded as A -> C.
+        if (isSameRange && pending.newLayout == barrier.oldLayout)
+        {
+            pending.dstStageMask    = barrier.dstStageMask;
+            pending.dstAccessMask   = barrier.dstAccessMask;
+            pending.newLayout       = barrier.newLayout;
+            pending.subresourceRange.aspectMask |= barrier.subresourceRange.aspectMask;
+            return;
+        }
+
+        //The barriers can't be merged, record what we have so the order of both transitions is kept.
+        Flush(commandBuffer);
+        break;
+    }
+
+    if (NumImageBarriers == MaxImageBarriers)
+    {
+        Flush(commandBuffer);
+    }
+
+    ImageBarriers[NumImageBarriers++] = barrier;
+}
+
+void BarrierBatch::AddBufferBarrier(VkCommandBuffer commandBuffer, const VkBufferMemoryBarrier2& barrier)
+{
+    for (uint32_t i{}; i < NumBufferBarriers; ++i)
+    {
+        VkBufferMemoryBarrier2& pending = BufferBarriers[i];
+        if (pending.buffer != barrier.buffer || !Overlaps(pending, barrier)) { continue; }
+
+        //Buffers have no layout, so the union of both ranges and both scopes covers both dependencies.
+        const VkDeviceSize pendingEnd = pending.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : pending.offset + pending.size;
+        const VkDeviceSize barrierEnd = barrier.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : barrier.offset + barrier.size;
+        pending.offset = std::min(pending.offset, barrier.offset);
+        pending.size = (pendingEnd == VK_WHOLE_SIZE || barrierEnd == VK_WHOLE_SIZE) ? VK_WHOLE_SIZE : std::max(pendingEnd, barrierEnd) - pending.offset;
+        pending.srcStageMask    |= barrier.srcStageMask;
+        pending.srcAccessMask   |= barrier.srcAccessMask;
+        pending.dstStageMask    |= barrier.dstStageMask;
+        pending.dstAccessMask   |= barrier.dstAccessMask;
+        return;
+    }
+
+    if (NumBufferBarriers == MaxBufferBarriers)
+    {
+        Flush(commandBuffer);
+    }
+
+    BufferBarriers[NumBufferBarriers++] = barrier;
+}
+
+void BarrierBatch::Flush(VkCommandBuffer commandBuffer)
+{
+    if (Empty()) { return; }
+
+    const VkDependencyInfo dependencyInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+        .pNext = nullptr,
+        .dependencyFlags = 0,
+        .memoryBarrierCount = HasMemoryBarrier ? 1u : 0u,
+        .pMemoryBarriers = &PendingMemoryBarrier,
+        .bufferMemoryBarrierCount = NumBufferBarriers,
+        .pBufferMemoryBarriers = BufferBarriers.data(),
+        .imageMemoryBarrierCount = NumImageBarriers,
+        .pImageMemoryBarriers = ImageBarriers.data()
+    };
+
+    vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+    NumImageBarriers = 0;
+    NumBufferBarriers = 0;
+    HasMemoryBarrier = false;
+    PendingMemoryBarrier = { .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+}
+
+bool BarrierBatch::Empty() const
+{
+    return NumImageBarriers == 0 && NumBufferBarriers == 0 && !HasMemoryBarrier;
+}
+
+bool BarrierBatch::IsRedundant(const VkImageMemoryBarrier2& barrier)
+{
+    constexpr VkAccessFlags2 writeAccess = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                           VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT |
+                                           VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+
+    //A read to read transition that keeps the layout and only waits on stages and accesses it already covers is a no-op.
+    const bool isReadToRead = ((barrier.srcAccessMask | barrier.dstAccessMask) & writeAccess) == 0;
+    const bool keepsLayout = barrier.oldLayout == barrier.newLayout && barrier.oldLayout != VK_IMAGE_LAYOUT_UNDEFINED;
+    const bool coversStages = (barrier.dstStageMask & ~barrier.srcStageMask) == 0;
+    const bool coversAccess = (barrier.dstAccessMask & ~barrier.srcAccessMask) == 0;
+
+    return isReadToRead && keepsLayout && coversStages && coversAccess;
+}
+
+bool BarrierBatch::Overlaps(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b)
+{
+    //Widen to 64 bit so the VK_REMAINING_* counts can't wrap around
+    auto overlaps = [](const uint64_t baseA, const uint32_t countA, const uint64_t baseB, const uint32_t countB)
+    {
+        const uint64_t endA = countA == VK_REMAINING_MIP_LEVELS ? UINT64_MAX : baseA + countA;
+        const uint64_t endB = countB == VK_REMAINING_MIP_LEVELS ? UINT64_MAX : baseB + countB;
+        return baseA < endB && baseB < endA;
+    };
+
+    return (a.aspectMask & b.aspectMask) != 0 &&
+           overlaps(a.baseMipLevel, a.levelCount, b.baseMipLevel, b.levelCount) &&
+           overlaps(a.baseArrayLayer, a.layerCount, b.baseArrayLayer, b.layerCount);
+}
+
+bool BarrierBatch::Overlaps(const VkBufferMemoryBarrier2& a, const VkBufferMemoryBarrier2& b)
+{
+    const VkDeviceSize endA = a.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : a.offset + a.size;
+    const VkDeviceSize endB = b.size == VK_WHOLE_SIZE ? VK_WHOLE_SIZE : b.offset + b.size;
+    return a.offset < endB && b.offset < endA;
+}
+
+CommandPool::CommandPool(const VkDevice &device, uint32_t queueIndex)
+    : Device(device)
+{
+    WaitSemaphores.reserve(2);
+    SignalSemaphores.reserve(2);
+
+    vkGetDeviceQueue(device, queueIndex, 0, &Queue); //Store a copy of the Queue
+
+    const VkCommandPoolCreateInfo createInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = queueIndex,
+    };
+
+    VK_ASSERT(vkCreateCommandPool(device, &createInfo, nullptr, &VulkanCommandPool));
+    VK_ASSERT(VkDebug::SetDebugObjectName(device, VK_OBJECT_TYPE_COMMAND_POOL, reinterpret_cast<uint64_t>(VulkanCommandPool), "CommandPool"));
+
+    const VkCommandBufferAllocateInfo allocateInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .commandPool = VulkanCommandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1,
+    };
+
+    //Allocate buffers for each buffer in our pool
+    for (uint32_t i{}; i < MaxCommandBuffers; ++i)
+    {
+        VK_ASSERT(vkAllocateCommandBuffers(device, &allocateInfo, &Buffers[i].VulkanCommandBufferAllocated));
+        Buffers[i].Semaphore = VkSynchronization::CreateSemaphore(device, fmt::format("Semaphore of CommandBuffer: {}", i).c_str());
+        Buffers[i].Fence = VkSynchronization::CreateFence(device, fmt::format("Fence of CommandBuffer: {}", i).c_str());
+        Buffers[i].Handle.BufferIndex = i;
+
+        ++NumberOfAvailableCommandBuffers;
+    }
+}
+
+CommandPool::~CommandPool()
+{
+    //Wait until everything is processed
+    WaitAll();
+
+    //Destroy all data of the buffers
+    for (CommandBufferData& buffer : Buffers)
+    {
+        vkDestroyFence(Device, buffer.Fence, nullptr);
+        vkDestroySemaphore(Device, buffer.Semaphore, nullptr);
+    }
+
+    //Destroy the internal pool itself
+    vkDestroyCommandPool(Device, VulkanCommandPool, nullptr);
+}
+
+void CommandPool::WaitSemaphore(const VkSemaphore& semaphore)
+{
+    CHECK(WaitOnSemaphore.semaphore == VK_NULL_HANDLE, "The wait Semaphore is not Empty");
+    WaitOnSemaphore.semaphore = semaphore;
+}
+
+void CommandPool::WaitAll()
+{
+    VkFence fences[MaxCommandBuffers];
+    uint32_t numFences = 0;
+
+    for (const CommandBufferData& buffer : Buffers)
+    {
+        if (buffer.VulkanCommandBuffer != VK_NULL_HANDLE && !buffer.isEncoding)
+        {
+            fences[numFences++] = buffer.Fence;
+        }
+    }
+
+    if (numFences)
+    {
+        VK_ASSERT(vkWaitForFences(Device, numFences, fences, VK_TRUE, UINT64_MAX));
+    }
+
+    TryResetCommandBuffers();
+}
+
+void CommandPool::Wait(const EOS::SubmitHandle handle)
+{
+    if (handle.Empty())
+    {
+        vkDeviceWaitIdle(Device);
+        return;
+    }
+
+    if (IsReady(handle))
+    {
+        return;
+    }
+
+    const bool isEncoding = Buffers[handle.BufferIndex].isEncoding;
+    CHECK(!isEncoding, "The buffer is not submitted yet, this should not be possible");
+    if (isEncoding)
+    {
+        //This buffer has never been submitted, this should not be possible at this point.
+        return;
+    }
+
+    VK_ASSERT(vkWaitForFences(Device, 1, &Buffers[handle.BufferIndex].Fence, VK_TRUE, UINT64_MAX));
+
+    TryResetCommandBuffers();
+}
+
+void CommandPool::Signal(const VkSemaphore& semaphore, const uint64_t& signalValue)
+{
+    CHECK(semaphore != VK_NULL_HANDLE, "The passed semaphore parameter is not valid.");
+    SignalSemaphore.semaphore = semaphore;
+    SignalSemaphore.value = signalValue;
+}
+
+bool CommandPool::IsReady(EOS::SubmitHandle handle, bool fastCheck) const
+{
+    //If its a empty handle then its "ready"
+    if (handle.Empty())
+    {
+        return true;
+    }
+
+    CHECK(handle.BufferIndex < MaxCommandBuffers, "The buffer index of the given handle is bigger then the MaxCommandBuffers.");
+
+    const CommandBufferData& buffer = Buffers[handle.BufferIndex];
+
+    //If the buffer is not in use.
+    if (buffer.VulkanCommandBuffer == VK_NULL_HANDLE)
+    {
+        return true;
+    }
+
+    //If the handle to the buffer is no longer in use by the command buffer is was created for
+    if (buffer.Handle.ID != handle.ID)
+    {
+        return true;
+    }
+
+    // Don't check the fence.
+    if (fastCheck)
+    {
+        return false;
+    }
+
+    return vkWaitForFences(Device, 1, &buffer.Fence, VK_TRUE, 0) == VK_SUCCESS;
+}
+
+VkSemaphore CommandPool::AcquireLastSubmitSemaphore()
+{
+    return std::exchange(LastSubmitSemaphore.semaphore, VK_NULL_HANDLE);;
+}
+
+EOS::SubmitHandle CommandPool::Submit(CommandBufferData& data)
+{
+    CHECK(data.isEncoding, "The buffer you want to submit is not recording.");
+
+    //Make sure barriers that have been added after the last command still end up in the commandbuffer
+    data.PendingBarriers.Flush(data.VulkanCommandBuffer);
+    VK_ASSERT(vkEndCommandBuffer(data.VulkanCommandBuffer));
+
+    //TODO instead of keeping members and them pushing them into vectors here.
+    //Just Emplace the objects directly into the vector and remove the WaitOn Last Submit members
+    WaitSemaphores.clear(); //TODO: double check clearing doesn't reduce memory
+    if (WaitOnSemaphore.semaphore)
+    {
+        WaitSemaphores.emplace_back(WaitOnSemaphore);
+    }
+    if (LastSubmitSemaphore.semaphore)
+    {
+        WaitSemaphores.emplace_back(LastSubmitSemaphore);
+    }
+
+    SignalSemaphores.clear();
+    SignalSemaphores.emplace_back(VkSemaphoreSubmitInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+        .semaphore = data.Semaphore,
+        .stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
+    });
+
+    if (SignalSemaphore.semaphore)
+    {
+        SignalSemaphores.emplace_back(SignalSemaphore);
+    }
+
+    const VkCommandBufferSubmitInfo bufferSubmitInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+        .commandBuffer = data.VulkanCommandBuffer,
+    };
+
+    const VkSubmitInfo2 submitInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+        .waitSemaphoreInfoCount = static_cast<uint32_t>(WaitSemaphores.size()),
+        .pWaitSemaphoreInfos = WaitSemaphores.data(),
+        .commandBufferInfoCount = 1,
+        .pCommandBufferInfos = &bufferSubmitInfo,
+        .signalSemaphoreInfoCount = static_cast<uint32_t>(SignalSemaphores.size()),
+        .pSignalSemaphoreInfos = SignalSemaphores.data(),
+    };
+
+    VK_ASSERT(vkQueueSubmit2(Queue, 1, &submitInfo, data.Fence));
+
+    LastSubmitSemaphore.semaphore = data.Semaphore;
+    LastSubmitHandle = data.Handle;
+    WaitOnSemaphore.semaphore = VK_NULL_HANDLE;
+    SignalSemaphore.semaphore = VK_NULL_HANDLE;
+
+    data.isEncoding = false;
+    ++SubmitCounter;
+
+    //An other commandbuffer can still be recording when this one was submitted in between, for example for an upload
+    for (const CommandBufferData& buffer : Buffers)
+    {
+        if (buffer.isEncoding)
+        {
+            NextSubmitHandle = buffer.Handle;
+            break;
+        }
+    }
+
+    // skip the 0 value when uint32_t wraps around.
+    if (!SubmitCounter) { ++SubmitCounter; }
+
+    return LastSubmitHandle;
+}
+
+EOS::SubmitHandle CommandPool::GetNextSubmitHandle() const
+{
+    return NextSubmitHandle;
+}
+
+CommandBufferData* CommandPool::AcquireCommandBuffer()
+{
+    //Try to free a command buffer of none are free
+    if (!NumberOfAvailableCommandBuffers)
+    {
+        TryResetCommandBuffers();
+    }
+
+    // if there is still no commandbuffer free in the pool, we will wait until one becomes available
+    while (!NumberOfAvailableCommandBuffers)
+    {
+        EOS::Logger->warn("Waiting for a command buffer that is free to use...");
+        TryResetCommandBuffers();
+    }
+
+    CommandBufferData* currentCommandBuffer = nullptr;
+
+    // we are ok with any available buffer
+    for (CommandBufferData& buffer : Buffers)
+    {
+        if (buffer.VulkanCommandBuffer == VK_NULL_HANDLE)
+        {
+            //TODO: This needs to be a copy, otherwise it will be moved out of the Buffers?
+            currentCommandBuffer = &buffer;
+            break;
+        }
+    }
+    CHECK(NumberOfAvailableCommandBuffers, "No command buffers where available");
+    CHECK(currentCommandBuffer, "No command buffers where available");
+    CHECK(currentCommandBuffer->VulkanCommandBufferAllocated != VK_NULL_HANDLE, "No command buffers where available");
+
+    currentCommandBuffer->Handle.ID = SubmitCounter;
+    NumberOfAvailableCommandBuffers--;
+
+    currentCommandBuffer->VulkanCommandBuffer = currentCommandBuffer->VulkanCommandBufferAllocated;
+    currentCommandBuffer->isEncoding = true;
+    currentCommandBuffer->IsBindlessBound = false;
+    currentCommandBuffer->IsRendering = false;
+
+    constexpr VkCommandBufferBeginInfo beginInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+    };
+
+    VK_ASSERT(vkBeginCommandBuffer(currentCommandBuffer->VulkanCommandBuffer, &beginInfo));
+
+    NextSubmitHandle = currentCommandBuffer->Handle;
+
+    return currentCommandBuffer;
+}
+
+void CommandPool::TryResetCommandBuffers()
+{
+    for (CommandBufferData& buffer : Buffers)
+    {
+        if (buffer.VulkanCommandBuffer == VK_NULL_HANDLE || buffer.isEncoding)
+        {
+            continue;
+        }
+
+        const VkResult result = vkWaitForFences(Device, 1, &buffer.Fence, VK_TRUE, 0);
+
+        if (result == VK_SUCCESS)
+        {
+            VK_ASSERT(vkResetCommandBuffer(buffer.VulkanCommandBuffer, VkCommandBufferResetFlags{0}));
+            VK_ASSERT(vkResetFences(Device, 1, &buffer.Fence));
+            buffer.VulkanCommandBuffer = VK_NULL_HANDLE;
+            ++NumberOfAvailableCommandBuffers;
+        }
+        else if (result != VK_TIMEOUT)
+        {
+            VK_ASSERT(result);
+        }
+    }
+}
+
+CommandBuffer::CommandBuffer(VulkanContext *vulkanContext)
+: CommandBufferImpl((vulkanContext->VulkanCommandPool->AcquireCommandBuffer()))
+, VkContext(vulkanContext)
+{
+}
+
+CommandBuffer & CommandBuffer::operator=(CommandBuffer &&other) noexcept
+{
+    if (this != &other)
+    {
+        VkContext = std::exchange(other.VkContext, nullptr);
+        CommandBufferImpl = std::exchange(other.CommandBufferImpl, {});
+        LastSubmitHandle = std::exchange(other.LastSubmitHandle, {});
+    }
+    return *this;
+}
+
+CommandBuffer::operator bool() const
+{
+    return VkContext != nullptr;
+}
+
+void CommandBuffer::FlushBarriers() const
+{
+    CommandBufferImpl->PendingBarriers.Flush(CommandBufferImpl->VulkanCommandBuffer);
+}
+
+void CommandBuffer::BindBindlessHeap() const
+{
+    if (CommandBufferImpl->IsBindlessBound) { return; }
+
+    const BindlessHeap& bindless = VkContext->GetBindlessHeap();
+    bindless.Bind(CommandBufferImpl->VulkanCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS);
+    bindless.Bind(CommandBufferImpl->VulkanCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE);
+    CommandBufferImpl->IsBindlessBound = true;
+}
+
+UploadRing::UploadRing(VulkanContext* vulkanContext, const uint32_t numFrames, const uint64_t frameSize)
+: VkContext(vulkanContext)
+, Buffer(vulkanContext->CreateBuffer(
+{
+    .Usage = EOS::BufferUsageFlags::Index | EOS::BufferUsageFlags::Vertex | EOS::BufferUsageFlags::Uniform | EOS::BufferUsageFlags::StorageBuffer | EOS::BufferUsageFlags::Indirect,
+    .Storage = EOS::StorageType::HostVisible,
+    .Size = frameSize * numFrames,
+    .DebugName = "Buffer: UploadRing",
+}, EOS::MemoryCategory::Staging))
+, MappedPtr(vulkanContext->GetMappedPtr(Buffer))
+, GPUAddress(vulkanContext->GetGPUAddress(Buffer))
+, FrameSize(frameSize)
+, FrameSubmits(numFrames)
+{
+    CHECK(numFrames > 0, "The upload ring needs at least 1 frame");
+    CHECK(MappedPtr, "The memory of the upload ring is not mapped");
+}
+
+EOS::UploadAllocation UploadRing::Allocate(const uint64_t size, const uint64_t alignment)
+{
+    CHECK(std::has_single_bit(alignment), "The alignment of an upload has to be a power of 2");
+
+    //The first allocation in a region has to wait until the GPU is done with the last submit that used it
+    if (Head == 0 && !FrameSubmits[CurrentFrame].Empty())
+    {
+        VkContext->VulkanCommandPool->Wait(FrameSubmits[CurrentFrame]);
+        FrameSubmits[CurrentFrame] = {};
+    }
+
+    //The frame size doesn't have to be a multiple of the alignment, so the offset in the whole buffer gets aligned instead of the one in the region
+    const uint64_t regionBase = CurrentFrame * FrameSize;
+    const uint64_t bufferOffset = (regionBase + Head + alignment - 1) & ~(alignment - 1);
+    const uint64_t offset = bufferOffset - regionBase;
+    if (offset + size > FrameSize)
+    {
+        return {};
+    }
+    Head = offset + size;
+
+    return
+    {
+        .Data = MappedPtr + bufferOffset,
+        .GPUAddress = GPUAddress + bufferOffset,
+        .Buffer = EOS::BufferHandle(Buffer),
+        .Offset = bufferOffset,
+        .Size = size,
+    };
+}
+
+void UploadRing::Flush() const
+{
+    if (Head == 0) { return; }
+    VkContext->FlushMappedMemory(Buffer, CurrentFrame * FrameSize, Head);
+}
+
+void UploadRing::EndFrame(const EOS::SubmitHandle handle)
+{
+    //Nothing was allocated, so the region can stay in use
+    if (Head == 0) { return; }
+
+    FrameSubmits[CurrentFrame] = handle;
+    CurrentFrame = (CurrentFrame + 1) % static_cast<uint32_t>(FrameSubmits.size());
+    Head = 0;
+}
+
+MemoryBudgetTracker::MemoryBudgetTracker(VmaAllocator allocator, const float threshold)
+: Vma(allocator)
+, Threshold(threshold)
+{
+    CHECK(threshold > 0.0f && threshold <= 1.0f, "The memory budget threshold has to be in (0, 1]");
+}
+
+void MemoryBudgetTracker::Track(const EOS::MemoryCategory category, VmaAllocation allocation)
+{
+    VmaAllocationInfo allocationInfo{};
+    vmaGetAllocationInfo(Vma, allocation, &allocationInfo);
+    CategoryUsage[static_cast<size_t>(category)] += allocationInfo.size;
+}
+
+MemoryBudgetTracker::PendingRelease MemoryBudgetTracker::Untrack(const EOS::MemoryCategory category, VmaAllocation allocation)
+{
+    VmaAllocationInfo allocationInfo{};
+    vmaGetAllocationInfo(Vma, allocation, &allocationInfo);
+
+    uint64_t& usage = CategoryUsage[static_cast<size_t>(category)];
+    CHECK(usage >= allocationInfo.size, "More memory is untracked than was tracked");
+    usage -= std::min(usage, allocationInfo.size);
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(Vma, &memoryProperties);
+
+    const PendingRelease release{ .HeapIndex = memoryProperties->memoryTypes[allocationInfo.memoryType].heapIndex, .Size = allocationInfo.size };
+    PendingReleaseBytes[release.HeapIndex] += release.Size;
+    return release;
+}
+
+void MemoryBudgetTracker::Release(const PendingRelease& release)
+{
+    uint64_t& pending = PendingReleaseBytes[release.HeapIndex];
+    CHECK(pending >= release.Size, "More memory is released than was pending");
+    pending -= std::min(pending, release.Size);
+}
+
+void MemoryBudgetTracker::Update(const uint32_t frameIndex)
+{
+    //With VK_EXT_memory_budget VMA queries the budget from the driver every few frames, without it the budget is estimated
+    vmaSetCurrentFrameIndex(Vma, frameIndex);
+    vmaGetHeapBudgets(Vma, HeapBudgets.data());
+
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(Vma, &memoryProperties);
+
+    //Take the heap that is the furthest over its threshold
+    //Memory that was evicted in an earlier frame is still in the usage until the GPU is done with it, so it isn't asked for again
+    uint64_t bytesToFree = 0;
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i)
+    {
+        if (!(memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)) { continue; }
+
+        const uint64_t thresholdBytes = static_cast<uint64_t>(static_cast<double>(HeapBudgets[i].budget) * Threshold);
+        const uint64_t usage = HeapBudgets[i].usage - std::min(HeapBudgets[i].usage, PendingReleaseBytes[i]);
+        if (usage > thresholdBytes)
+        {
+            bytesToFree = std::max(bytesToFree, usage - thresholdBytes);
+        }
+    }
+
+    if (bytesToFree == 0)
+    {
+        IsOverBudget = false;
+        return;
+    }
+
+    uint64_t bytesFreed = 0;
+    for (const EvictionCallbackEntry& entry : EvictionCallbacks)
+    {
+        if (bytesFreed >= bytesToFree) { break; }
+        bytesFreed += entry.Callback(bytesToFree - bytesFreed);
+    }
+
+    //Only warn when we go over the budget, not every frame we stay over it
+    if (bytesFreed < bytesToFree && !IsOverBudget)
+    {
+        EOS::Logger->warn("Device memory is over its budget threshold, {} bytes could not be freed", bytesToFree - bytesFreed);
+    }
+    IsOverBudget = bytesFreed < bytesToFree;
+}
+
+EOS::MemoryStatistics MemoryBudgetTracker::GetStatistics() const
+{
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(Vma, &memoryProperties);
+
+    EOS::MemoryStatistics statistics{ .CategoryUsage = CategoryUsage };
+    statistics.Heaps.reserve(memoryProperties->memoryHeapCount);
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i)
+    {
+        statistics.Heaps.emplace_back(EOS::MemoryHeapStatistics
+        {
+            .Usage = HeapBudgets[i].usage,
+            .Budget = HeapBudgets[i].budget,
+            .IsDeviceLocal = (memoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) > 0,
+        });
+    }
+
+    return statistics;
+}
+
+uint32_t MemoryBudgetTracker::AddEvictionCallback(EOS::EvictionCallback callback)
+{
+    const uint32_t id = NextCallbackId++;
+    EvictionCallbacks.emplace_back(EvictionCallbackEntry{ .Id = id, .Callback = std::move(callback) });
+    return id;
+}
+
+void MemoryBudgetTracker::RemoveEvictionCallback(const uint32_t id)
+{
+    std::erase_if(EvictionCallbacks, [id](const EvictionCallbackEntry& entry) { return entry.Id == id; });
+}
+
+BindlessHeap::BindlessHeap(VkDevice device, VkPhysicalDevice physicalDevice, VmaAllocator allocator, const EOS::ContextConfiguration& configuration, const DeviceCapabilities& capabilities)
+: Device(device)
+, HasNullDescriptor(capabilities.NullDescriptor)
+, UsesDescriptorBuffer(capabilities.DescriptorBuffer && configuration.PreferDescriptorBuffer)
+, Vma(allocator)
+{
+    VkPhysicalDeviceVulkan12Properties properties12{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES };
+    VkPhysicalDeviceProperties2 properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &properties12 };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+    const VkPhysicalDeviceLimits& limits = properties.properties.limits;
+
+    //All bindings are visible to every stage, so the per stage limits apply to the whole set
+    Capacity[Textures]          = std::min({configuration.MaxBindlessTextures, properties12.maxDescriptorSetUpdateAfterBindSampledImages, properties12.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    Capacity[Samplers]          = std::min({configuration.MaxBindlessSamplers, properties12.maxDescriptorSetUpdateAfterBindSamplers, properties12.maxPerStageDescriptorUpdateAfterBindSamplers});
+    Capacity[StorageImages]     = std::min({configuration.MaxBindlessTextures, properties12.maxDescriptorSetUpdateAfterBindStorageImages, properties12.maxPerStageDescriptorUpdateAfterBindStorageImages});
+    Capacity[StorageBuffers]    = std::min({configuration.MaxBindlessBuffers, properties12.maxDescriptorSetUpdateAfterBindStorageBuffers, properties12.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+
+    //A descriptor buffer layout can't be updated after bind, so the regular limits apply to it
+    if (UsesDescriptorBuffer)
+    {
+        Capacity[Textures]          = std::min({Capacity[Textures], limits.maxDescriptorSetSampledImages, limits.maxPerStageDescriptorSampledImages});
+        Capacity[Samplers]          = std::min({Capacity[Samplers], limits.maxDescriptorSetSamplers, limits.maxPerStageDescriptorSamplers});
+        Capacity[StorageImages]     = std::min({Capacity[StorageImages], limits.maxDescriptorSetStorageImages, limits.maxPerStageDescriptorStorageImages});
+        Capacity[StorageBuffers]    = std::min({Capacity[StorageBuffers], limits.maxDescriptorSetStorageBuffers, limits.maxPerStageDescriptorStorageBuffers});
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, NumBindings> bindings{};
+    std::array<VkDescriptorBindingFlags, NumBindings> bindingFlags{};
+    for (uint32_t binding = 0; binding < NumBindings; ++binding)
+    {
+        bindings[binding] = VkDescriptorSetLayoutBinding{ .binding = binding, .descriptorType = DescriptorTypes[binding], .descriptorCount = Capacity[binding], .stageFlags = VK_SHADER_STAGE_ALL };
+        bindingFlags[binding] = UsesDescriptorBuffer ? VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT : VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+    }
+
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = NumBindings,
+        .pBindingFlags = bindingFlags.data(),
+    };
+
+    const VkDescriptorSetLayoutCreateInfo setLayoutCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &bindingFlagsCreateInfo,
+        .flags = UsesDescriptorBuffer ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = NumBindings,
+        .pBindings = bindings.data(),
+    };
+    VK_ASSERT(vkCreateDescriptorSetLayout(Device, &setLayoutCreateInfo, nullptr, &SetLayout));
+    VK_ASSERT(VkDebug::SetDebugObjectName(Device, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, reinterpret_cast<uint64_t>(SetLayout), "Descriptor Set Layout: Bindless"));
+
+    if (UsesDescriptorBuffer)
+    {
+        CreateDescriptorBuffer(physicalDevice);
+    }
+    else
+    {
+        CreateDescriptorSet();
+    }
+
+    //Every pipeline shares this layout, so binding the set once stays valid across pipeline changes
+    PushConstantsSize = std::min(limits.maxPushConstantsSize, 256u);
+    const VkPushConstantRange pushConstantRange{ .stageFlags = VK_SHADER_STAGE_ALL, .offset = 0, .size = PushConstantsSize };
+    const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &SetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
+    };
+    VK_ASSERT(vkCreatePipelineLayout(Device, &pipelineLayoutCreateInfo, nullptr, &PipelineLayout));
+    VK_ASSERT(VkDebug::SetDebugObjectName(Device, VK_OBJECT_TYPE_PIPELINE_LAYOUT, reinterpret_cast<uint64_t>(PipelineLayout), "Pipeline Layout: Bindless"));
+
+    EOS::Logger->info("Bindless {} with {} textures, {} samplers and {} buffers", UsesDescriptorBuffer ? "descriptor buffer" : "descriptor set", Capacity[Textures], Capacity[Samplers], Capacity[StorageBuffers]);
+}
+
+BindlessHeap::~BindlessHeap()
+{
+    vkDestroyPipelineLayout(Device, PipelineLayout, nullptr);
+    if (DescriptorBuffer != VK_NULL_HANDLE)
+    {
+        vmaDestroyBuffer(Vma, DescriptorBuffer, DescriptorBufferAllocation);
+    }
+    vkDestroyDescriptorPool(Device, DescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(Device, SetLayout, nullptr);
+}
+
+void BindlessHeap::CreateDescriptorSet()
+{
+    std::array<VkDescriptorPoolSize, NumBindings> poolSizes{};
+    for (uint32_t binding = 0; binding < NumBindings; ++binding)
+    {
+        poolSizes[binding] = VkDescriptorPoolSize{ .type = DescriptorTypes[binding], .descriptorCount = Capacity[binding] };
+    }
+
+    const VkDescriptorPoolCreateInfo poolCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1,
+        .poolSizeCount = NumBindings,
+        .pPoolSizes = poolSizes.data(),
+    };
+    VK_ASSERT(vkCreateDescriptorPool(Device, &poolCreateInfo, nullptr, &DescriptorPool));
+
+    const VkDescriptorSetAllocateInfo allocateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = DescriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &SetLayout,
+    };
+    VK_ASSERT(vkAllocateDescriptorSets(Device, &allocateInfo, &DescriptorSet));
+    VK_ASSERT(VkDebug::SetDebugObjectName(Device, VK_OBJECT_TYPE_DESCRIPTOR_SET, reinterpret_cast<uint64_t>(DescriptorSet), "Descriptor Set: Bindless"));
+}
+
+void BindlessHeap::CreateDescriptorBuffer(VkPhysicalDevice physicalDevice)
+{
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptorBufferProperties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT };
+    VkPhysicalDeviceProperties2 properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &descriptorBufferProperties };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    DescriptorSizes[Textures]       = descriptorBufferProperties.sampledImageDescriptorSize;
+    DescriptorSizes[Samplers]       = descriptorBufferProperties.samplerDescriptorSize;
+    DescriptorSizes[StorageImages]  = descriptorBufferProperties.storageImageDescriptorSize;
+    DescriptorSizes[StorageBuffers] = descriptorBufferProperties.storageBufferDescriptorSize;
+
+    for (uint32_t binding = 0; binding < NumBindings; ++binding)
+    {
+        vkGetDescriptorSetLayoutBindingOffsetEXT(Device, SetLayout, binding, &BindingOffsets[binding]);
+    }
+
+    VkDeviceSize size = 0;
+    vkGetDescriptorSetLayoutSizeEXT(Device, SetLayout, &size);
+    CHECK(size <= descriptorBufferProperties.maxResourceDescriptorBufferRange && size <= descriptorBufferProperties.maxSamplerDescriptorBufferRange, "The bindless descriptor buffer of {} bytes is bigger than the device can address", size);
+
+    const VkBufferCreateInfo bufferCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
+
+    //Descriptors are written by the CPU and read by the GPU, so prefer device local memory the CPU can write to
+    const VmaAllocationCreateInfo allocationCreateInfo
+    {
+        .flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
+        .usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+    };
+
+    VmaAllocationInfo allocationInfo{};
+    VK_ASSERT(vmaCreateBuffer(Vma, &bufferCreateInfo, &allocationCreateInfo, &DescriptorBuffer, &DescriptorBufferAllocation, &allocationInfo));
+    vmaSetAllocationName(Vma, DescriptorBufferAllocation, "Descriptor Buffer: Bindless");
+    VK_ASSERT(VkDebug::SetDebugObjectName(Device, VK_OBJECT_TYPE_BUFFER, reinterpret_cast<uint64_t>(DescriptorBuffer), "Descriptor Buffer: Bindless"));
+    DescriptorBufferPtr = static_cast<uint8_t*>(allocationInfo.pMappedData);
+
+    const VkBufferDeviceAddressInfo addressInfo{ .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO, .buffer = DescriptorBuffer };
+    DescriptorBufferAddress = vkGetBufferDeviceAddress(Device, &addressInfo);
+}
+
+void BindlessHeap::SetTexture(const uint32_t index, const VulkanImage& image)
+{
+    if (VulkanImage::IsSampledImage(image))
+    {
+        SetImageInfo(Textures, index, VkDescriptorImageInfo{ .imageView = image.ImageView, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL });
+    }
+
+    if (VulkanImage::IsStorageImage(image))
+    {
+        SetImageInfo(StorageImages, index, VkDescriptorImageInfo{ .imageView = image.ImageViewStorage ? image.ImageViewStorage : image.ImageView, .imageLayout = VK_IMAGE_LAYOUT_GENERAL });
+    }
+}
+
+void BindlessHeap::SetSampler(const uint32_t index, VkSampler sampler)
+{
+    SetImageInfo(Samplers, index, VkDescriptorImageInfo{ .sampler = sampler });
+}
+
+void BindlessHeap::SetBuffer(const uint32_t index, const VulkanBuffer& buffer)
+{
+    if (!(buffer.UsageFlags & VK_BUFFER_USAGE_STORAGE_BUFFER_BIT)) { return; }
+
+    CHECK(index < Capacity[StorageBuffers], "The bindless heap is full, it can hold {} buffers", Capacity[StorageBuffers]);
+    if (index >= Capacity[StorageBuffers]) { return; }
+
+    if (index >= BufferInfos.size())
+    {
+        BufferInfos.resize(index + 1);
+        BufferAddresses.resize(index + 1);
+    }
+    BufferInfos[index] = VkDescriptorBufferInfo{ .buffer = buffer.Buffer, .offset = 0, .range = buffer.Size };
+    BufferAddresses[index] = buffer.DeviceAddress;
+    MarkDirty(StorageBuffers, index);
+}
+
+void BindlessHeap::ClearTexture(const uint32_t index, VkImageView imageView)
+{
+    if (!HasNullDescriptor) { return; }
+
+    for (const Binding binding : {Textures, StorageImages})
+    {
+        if (index < ImageInfos[binding].size() && ImageInfos[binding][index].imageView == imageView)
+        {
+            ImageInfos[binding][index].imageView = VK_NULL_HANDLE;
+            MarkDirty(binding, index);
+        }
+    }
+}
+
+void BindlessHeap::ClearSampler(const uint32_t index, VkSampler sampler)
+{
+    //There is no null sampler, so the slot falls back to the default sampler
+    std::vector<VkDescriptorImageInfo>& samplers = ImageInfos[Samplers];
+    if (index == 0 || index >= samplers.size() || samplers[index].sampler != sampler) { return; }
+
+    samplers[index].sampler = samplers[0].sampler;
+    MarkDirty(Samplers, index);
+}
+
+void BindlessHeap::ClearBuffer(const uint32_t index, VkBuffer buffer)
+{
+    if (!HasNullDescriptor || index >= BufferInfos.size() || BufferInfos[index].buffer != buffer) { return; }
+
+    BufferInfos[index].buffer = VK_NULL_HANDLE;
+    MarkDirty(StorageBuffers, index);
+}
+
+void BindlessHeap::Flush()
+{
+    if (UsesDescriptorBuffer)
+    {
+        UpdateDescriptorBuffer();
+    }
+    else
+    {
+        UpdateDescriptorSet();
+    }
+
+    for (uint32_t binding = 0; binding < NumBindings; ++binding)
+    {
+        for (const uint32_t slot : DirtySlots[binding]) { IsDirty[binding][slot] = false; }
+        DirtySlots[binding].clear();
+    }
+}
+
+void BindlessHeap::Bind(VkCommandBuffer commandBuffer, const VkPipelineBindPoint bindPoint) const
+{
+    if (UsesDescriptorBuffer)
+    {
+        const VkDescriptorBufferBindingInfoEXT bindingInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+            .address = DescriptorBufferAddress,
+            .usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT,
+        };
+        vkCmdBindDescriptorBuffersEXT(commandBuffer, 1, &bindingInfo);
+
+        constexpr uint32_t bufferIndex = 0;
+        constexpr VkDeviceSize offset = 0;
+        vkCmdSetDescriptorBufferOffsetsEXT(commandBuffer, bindPoint, PipelineLayout, 0, 1, &bufferIndex, &offset);
+        return;
+    }
+
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, PipelineLayout, 0, 1, &DescriptorSet, 0, nullptr);
+}
+
+void BindlessHeap::UpdateDescriptorSet()
+{
+    Writes.clear();
+
+    for (uint32_t binding = 0; binding < NumBindings; ++binding)
+    {
+        std::vector<uint32_t>& dirtySlots = DirtySlots[binding];
+        if (dirtySlots.empty()) { continue; }
+
+        //Sorted slots make every run of contiguous slots 1 write
+        std::ranges::sort(dirtySlots);
+        for (size_t first = 0; first < dirtySlots.size();)
+        {
+            size_t last = first;
+            while (last + 1 < dirtySlots.size() && dirtySlots[last + 1] == dirtySlots[last] + 1) { ++last; }
+
+            const uint32_t firstSlot = dirtySlots[first];
+            Writes.emplace_back(VkWriteDescriptorSet
+            {
+                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                .dstSet = DescriptorSet,
+                .dstBinding = binding,
+                .dstArrayElement = firstSlot,
+                .descriptorCount = static_cast<uint32_t>(last - first + 1),
+                .descriptorType = DescriptorTypes[binding],
+                .pImageInfo = binding == StorageBuffers ? nullptr : &ImageInfos[binding][firstSlot],
+                .pBufferInfo = binding == StorageBuffers ? &BufferInfos[firstSlot] : nullptr,
+            });
+
+            first = last + 1;
+        }
+    }
+
+    if (Writes.empty()) { return; }
+    vkUpdateDescriptorSets(Device, static_cast<uint32_t>(Writes.size()), Writes.data(), 0, nullptr);
+}
+
+void BindlessHeap::UpdateDescriptorBuffer()
+{
+    //The GPU can be reading other slots of the buffer right now, which is fine because none of the frames in flight read a dirty slot, see SetTexture
+    VkDeviceSize firstByte = std::numeric_limits<VkDeviceSize>::max();
+    VkDeviceSize lastByte = 0;
+
+    for (uint32_t binding = 0; binding < NumBindings; ++binding)
+    {
+        for (const uint32_t slot : DirtySlots[binding])
+        {
+            //A null resource gives a null descriptor, which is only possible with VK_EXT_robustness2
+            VkDescriptorGetInfoEXT getInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT, .type = DescriptorTypes[binding] };
+            VkDescriptorAddressInfoEXT addressInfo{ .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT };
+            switch (binding)
+            {
+                case Textures:
+                    getInfo.data.pSampledImage = ImageInfos[binding][slot].imageView ? &ImageInfos[binding][slot] : nullptr;
+                    break;
+                case Samplers:
+                    getInfo.data.pSampler = &ImageInfos[binding][slot].sampler;
+                    break;
+                case StorageImages:
+                    getInfo.data.pStorageImage = ImageInfos[binding][slot].imageView ? &ImageInfos[binding][slot] : nullptr;
+                    break;
+                default:
+                    addressInfo.address = BufferAddresses[slot];
+                    addressInfo.range = BufferInfos[slot].range;
+                    getInfo.data.pStorageBuffer = BufferInfos[slot].buffer ? &addressInfo : nullptr;
+                    break;
+            }
+
+            const VkDeviceSize offset = BindingOffsets[binding] + slot * DescriptorSizes[binding];
+            vkGetDescriptorEXT(Device, &getInfo, DescriptorSizes[binding], DescriptorBufferPtr + offset);
+            firstByte = std::min(firstByte, offset);
+            lastByte = std::max(lastByte, offset + DescriptorSizes[binding]);
+        }
+    }
+
+    //Only needed when the memory isn't host coherent
+    if (firstByte < lastByte)
+    {
+        VK_ASSERT(vmaFlushAllocation(Vma, DescriptorBufferAllocation, firstByte, lastByte - firstByte));
+    }
+}
+
+void BindlessHeap::SetImageInfo(const Binding binding, const uint32_t index, const VkDescriptorImageInfo& imageInfo)
+{
+    CHECK(index < Capacity[binding], "The bindless heap is full, binding {} can hold {} descriptors", static_cast<uint32_t>(binding), Capacity[binding]);
+    if (index >= Capacity[binding]) { return; }
+
+    std::vector<VkDescriptorImageInfo>& imageInfos = ImageInfos[binding];
+    if (index >= imageInfos.size()) { imageInfos.resize(index + 1); }
+    imageInfos[index] = imageInfo;
+    MarkDirty(binding, index);
+}
+
+void BindlessHeap::MarkDirty(const Binding binding, const uint32_t index)
+{
+    std::vector<bool>& isDirty = IsDirty[binding];
+    if (index >= isDirty.size()) { isDirty.resize(index + 1, false); }
+    if (isDirty[index]) { return; }
+
+    isDirty[index] = true;
+    DirtySlots[binding].emplace_back(index);
+}
+
+PersistentPipelineCache::PersistentPipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const char* path, const uint32_t saveInterval)
+: Device(device)
+, Path(path)
+, SaveInterval(saveInterval)
+, LastSaveTime(std::chrono::steady_clock::now())
+{
+    VkPhysicalDeviceVulkan11Properties properties11{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES };
+    VkPhysicalDeviceProperties2 properties{ .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &properties11 };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+
+    ExpectedHeader.VendorID = properties.properties.vendorID;
+    ExpectedHeader.DeviceID = properties.properties.deviceID;
+    ExpectedHeader.DriverVersion = properties.properties.driverVersion;
+    std::memcpy(ExpectedHeader.DriverUUID, properties11.driverUUID, VK_UUID_SIZE);
+    std::memcpy(ExpectedHeader.PipelineCacheUUID, properties.properties.pipelineCacheUUID, VK_UUID_SIZE);
+
+    const std::vector<uint8_t> data = Load();
+    const VkPipelineCacheCreateInfo createInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .initialDataSize = data.size(),
+        .pInitialData = data.empty() ? nullptr : data.data(),
+    };
+    VK_ASSERT(vkCreatePipelineCache(Device, &createInfo, nullptr, &Cache));
+    VK_ASSERT(VkDebug::SetDebugObjectName(Device, VK_OBJECT_TYPE_PIPELINE_CACHE, reinterpret_cast<uint64_t>(Cache), "Pipeline Cache: Persistent"));
+
+    LastSavedSize = data.size();
+    EOS::Logger->info("Pipeline cache loaded {} bytes from {}", data.size(), Path.string());
+}
+
+PersistentPipelineCache::~PersistentPipelineCache()
+{
+    if (PendingSave.valid()) { PendingSave.wait(); }
+    Save();
+    vkDestroyPipelineCache(Device, Cache, nullptr);
+}
+
+void PersistentPipelineCache::Update()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - LastSaveTime < SaveInterval) { return; }
+
+    //Writing the file takes too long to do in a frame, the last save has to be done before the next one starts
+    if (PendingSave.valid())
+    {
+        if (PendingSave.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return; }
+        PendingSave.get();
+    }
+    LastSaveTime = now;
+
+    //The size only grows when pipelines have been added
+    size_t size = 0;
+    VK_ASSERT(vkGetPipelineCacheData(Device, Cache, &size, nullptr));
+    if (size != LastSavedSize)
+    {
+        //The pipeline cache is internally synchronized, so the worker can read it while pipelines are being compiled
+        PendingSave = SaveWorker.Enqueue([this]() { Save(); });
+    }
+}
+
+void PersistentPipelineCache::Save()
+{
+    size_t size = 0;
+    VK_ASSERT(vkGetPipelineCacheData(Device, Cache, &size, nullptr));
+    std::vector<uint8_t> data(size);
+    if (size == 0 || vkGetPipelineCacheData(Device, Cache, &size, data.data()) != VK_SUCCESS) { return; }
+    data.resize(size);
+
+    FileHeader header = ExpectedHeader;
+    header.DataSize = size;
+    header.DataHash = HashData(data);
+
+    //Written next to the file and renamed over it, so a crash while saving never leaves a broken cache behind
+    std::error_code error;
+    std::filesystem::create_directories(Path.parent_path(), error);
+    std::filesystem::path temporaryPath = Path;
+    temporaryPath += ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            EOS::Logger->warn("Can't write the pipeline cache to {}", temporaryPath.string());
+            return;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file.good()) { return; }
+    }
+
+    std::filesystem::rename(temporaryPath, Path, error);
+    if (error)
+    {
+        EOS::Logger->warn("Can't replace the pipeline cache {}: {}", Path.string(), error.message());
+        return;
+    }
+
+    LastSavedSize = size;
+}
+
+std::vector<uint8_t> PersistentPipelineCache::Load() const
+{
+    std::ifstream file(Path, std::ios::in | std::ios::binary);
+    if (!file.is_open()) { return {}; }
+
+    std::error_code error;
+    const uintmax_t fileSize = std::filesystem::file_size(Path, error);
+
+    FileHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    const bool isSameDevice = file.good() && header.Magic == FileHeader::CurrentMagic
+        && header.VendorID == ExpectedHeader.VendorID && header.DeviceID == ExpectedHeader.DeviceID && header.DriverVersion == ExpectedHeader.DriverVersion
+        && std::memcmp(header.DriverUUID, ExpectedHeader.DriverUUID, VK_UUID_SIZE) == 0
+        && std::memcmp(header.PipelineCacheUUID, ExpectedHeader.PipelineCacheUUID, VK_UUID_SIZE) == 0;
+    if (!isSameDevice)
+    {
+        EOS::Logger->info("The pipeline cache {} was written by an other device or driver, it will be rebuilt", Path.string());
+        return {};
+    }
+
+    //The size comes from the file, so it is checked before anything gets allocated for it
+    if (error || fileSize < sizeof(header) || header.DataSize != fileSize - sizeof(header))
+    {
+        EOS::Logger->warn("The pipeline cache {} is corrupt, it will be rebuilt", Path.string());
+        return {};
+    }
+
+    std::vector<uint8_t> data(header.DataSize);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file.good() || HashData(data) != header.DataHash)
+    {
+        EOS::Logger->warn("The pipeline cache {} is corrupt, it will be rebuilt", Path.string());
+        return {};
+    }
+
+    return data;
+}
+
+uint64_t PersistentPipelineCache::HashData(const std::vector<uint8_t>& data)
+{
+    uint64_t hash = EOS::HashSeed;
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= data.size(); offset += sizeof(uint64_t))
+    {
+        uint64_t value = 0;
+        std::memcpy(&value, data.data() + offset, sizeof(uint64_t));
+        EOS::HashCombine(hash, value);
+    }
+    for (; offset < data.size(); ++offset)
+    {
+        EOS::HashCombine(hash, data[offset]);
+    }
+    return hash;
+}
+
+VulkanContext::VulkanContext(const EOS::ContextCreationDescription& contextDescription)
+: Configuration(contextDescription.config)
+{
+    CHECK(volkInitialize() == VK_SUCCESS, "Failed to Initialize VOLK");
+
+    CreateVulkanInstance(contextDescription.applicationName);
+    SetupDebugMessenger();
+
+    //A headless context has no window to present to
+    if (contextDescription.window)
+    {
+        CreateSurface(contextDescription.window, contextDescription.display);
+    }
+
+    //Select the Physical Device
+    std::vector<EOS::HardwareDeviceDescription> hardwareDevices;
+    GetHardwareDevice(contextDescription.preferredHardwareType, hardwareDevices);
+    VkContext::SelectHardwareDevice(hardwareDevices, VulkanPhysicalDevice);
+
+    //Create our Vulkan Device
+    VkContext::CreateVulkanDevice(VulkanDevice, VulkanPhysicalDevice, VulkanDeviceQueues, Capabilities);
+
+    //Create the allocator all our GPU memory comes from
+    CreateAllocator();
+    Budget = std::make_unique<MemoryBudgetTracker>(Vma, Configuration.MemoryBudgetThreshold);
+
+    //Create the descriptor set all resources are accessed through, the default sampler takes slot 0
+    Bindless = std::make_unique<BindlessHeap>(VulkanDevice, VulkanPhysicalDevice, Vma, Configuration, Capabilities);
+    DefaultSampler = AcquireSampler(EOS::SamplerDescription{ .DebugName = "Sampler: Default" });
+
+    //Unified memory and ReBAR devices can write device local memory directly, all others need to copy through staging memory
+    Uploads = (IsHostVisibleMemorySingleHeap() || IsDeviceLocalMemoryHostVisible()) ? UploadStrategy::Direct : UploadStrategy::Staging;
+    EOS::Logger->info("Uploads are done {}", Uploads == UploadStrategy::Direct ? "directly into device memory" : "through staging memory");
+
+    //Create SwapChain
+    //TODO: will it need a description struct?
+    if (VulkanSurface != VK_NULL_HANDLE)
+    {
+        VulkanSwapChainCreationDescription desc
+        {
+            .vulkanContext = this,
+            .width = 100,
+            .height = 80,
+        };
+
+        SwapChain = std::make_unique<VulkanSwapChain>(desc);
+    }
+
+
+    //Create our Timeline Semaphore
+    TimelineSemaphore = VkSynchronization::CreateSemaphoreTimeline(VulkanDevice, HasSwapChain() ? SwapChain->GetNumSwapChainImages() - 1 : 0, "Semaphore: TimelineSemaphore");
+
+    //Create our CommandPool
+    VulkanCommandPool = std::make_unique<CommandPool>(VulkanDevice, VulkanDeviceQueues.Graphics.QueueFamilyIndex);
+
+
+    //Create the ring all per frame uploads come from
+    FrameUploadRing = std::make_unique<UploadRing>(this, Configuration.NumFramesInFlight, Configuration.UploadRingFrameSize);
+
+    //Pipelines that were compiled in an earlier run come out of the cache
+    if (Configuration.PipelineCachePath)
+    {
+        PipelineCache = std::make_unique<PersistentPipelineCache>(VulkanDevice, VulkanPhysicalDevice, Configuration.PipelineCachePath, Configuration.PipelineCacheSaveInterval);
+    }
+
+    //TODO: Staging Device
+}
+
+VulkanContext::~VulkanContext()
+{
+    //Wait unit all work has been done
+    VK_ASSERT(vkDeviceWaitIdle(VulkanDevice));
+
+    //Finish the uploads that are still being copied by the host
+    UploadWorkers.reset(nullptr);
+    PipelineWorkers.reset(nullptr);
+    StopDefragmentation();
+    SwapChain.reset(nullptr);
+    FrameUploadRing.reset(nullptr);
+    PipelineCache.reset(nullptr);
+
+    vkDestroySemaphore(VulkanDevice, TimelineSemaphore, nullptr);
+
+    if (TexturePool.NumObjects())
+    {
+        EOS::Logger->error("{} Leaked textures", TexturePool.NumObjects());
+    }
+
+    //Their views and images are destroyed together with the other deferred tasks, before the allocator goes
+    TexturePool.ForEach([this](EOS::TextureHandle handle, const VulkanImage&) { Destroy(handle); });
+
+    if (ShaderModulePool.NumObjects())
+    {
+        EOS::Logger->error("{} Leaked Shader Modules", ShaderModulePool.NumObjects());
+    }
+    ShaderModulePool.ForEach([this](EOS::ShaderModuleHandle handle, const VulkanShaderModuleState&) { Destroy(handle); });
+    ShaderModulePool.Clear();
+
+    if (BufferPool.NumObjects())
+    {
+        EOS::Logger->error("{} Leaked buffers", BufferPool.NumObjects());
+    }
+    BufferPool.ForEach([this](EOS::BufferHandle handle, const VulkanBuffer&) { Destroy(handle); });
+
+    if (TransientMemoryPool.NumObjects())
+    {
+        EOS::Logger->error("{} Leaked transient memory blocks", TransientMemoryPool.NumObjects());
+    }
+
+    //The textures placed in them are destroyed above, their memory is freed together with the other deferred tasks
+    TransientMemoryPool.ForEach([this](EOS::TransientMemoryHandle handle, const VulkanTransientMemory&) { Destroy(handle); });
+    TransientMemoryPool.Clear();
+
+    if (ComputePipelinePool.NumObjects() || RenderPipelinePool.NumObjects())
+    {
+        EOS::Logger->error("{} Leaked compute pipelines, {} Leaked render pipelines", ComputePipelinePool.NumObjects(), RenderPipelinePool.NumObjects());
+    }
+
+    //The workers are stopped, so every compilation is done and Destroy takes the pipelines without waiting
+    ComputePipelinePool.ForEach([this](EOS::ComputePipelineHandle handle, const VulkanPipeline&) { Destroy(handle); });
+    RenderPipelinePool.ForEach([this](EOS::RenderPipelineHandle handle, const VulkanPipeline&) { Destroy(handle); });
+
+    for (const auto& [hash, library] : PipelineLibraries)
+    {
+        vkDestroyPipeline(VulkanDevice, library.Library, nullptr);
+    }
+    PipelineLibraries.clear();
+
+    Destroy(DefaultSampler);
+    if (!SamplerCache.empty())
+    {
+        EOS::Logger->error("{} Leaked samplers", SamplerCache.size());
+    }
+    for (const auto& [description, handle] : SamplerCache)
+    {
+        vkDestroySampler(VulkanDevice, SamplerPool.Get(handle)->Sampler, nullptr);
+    }
+    SamplerCache.clear();
+    SamplerPool.Clear();
+
+    if (SplitBarrierPool.NumObjects())
+    {
+        EOS::Logger->error("{} Split barriers were signaled but never waited on", SplitBarrierPool.NumObjects());
+    }
+
+    //The events of barriers that were never waited on never went back to the free list
+    SplitBarrierPool.ForEach([this](EOS::SplitBarrierHandle, const VulkanSplitBarrier& barrier)
+    {
+        vkDestroyEvent(VulkanDevice, barrier.Event, nullptr);
+    });
+    SplitBarrierPool.Clear();
+
+    WaitOnDeferredTasks();
+
+    //All deferred tasks are done, so every event that is still used by a split barrier is back in the pool now
+    for (const VkEvent event : FreeEvents)
+    {
+        vkDestroyEvent(VulkanDevice, event, nullptr);
+    }
+    FreeEvents.clear();
+
+    VulkanCommandPool.reset(nullptr);
+    Bindless.reset(nullptr);
+
+    vkDestroySurfaceKHR(VulkanInstance, VulkanSurface, nullptr);
+
+    vmaDestroyAllocator(Vma);
+
+    vkDestroyDevice(VulkanDevice, nullptr);
+    vkDestroyDebugUtilsMessengerEXT(VulkanInstance, VulkanDebugMessenger, nullptr);
+    vkDestroyInstance(VulkanInstance, nullptr);
+}
+
+EOS::ICommandBuffer& VulkanContext::AcquireCommandBuffer()
+{
+    CHECK(!CurrentCommandBuffer, "Another CommandBuffer has been acquired this frame");
+    CurrentCommandBuffer = std::move(CommandBuffer{this});
+    return CurrentCommandBuffer;
+}
+
+EOS::SubmitHandle VulkanContext::Submit(EOS::ICommandBuffer &commandBuffer, EOS::TextureHandle present)
+{
+    CommandBuffer* vkCmdBuffer = dynamic_cast<CommandBuffer*>(&commandBuffer);
+    CHECK(vkCmdBuffer, "The command buffer is not valid");
+    CHECK(!vkCmdBuffer->CommandBufferImpl->IsRendering, "The command buffer is submitted without ending its rendering, call cmdEndRendering first");
+
+#if defined(EOS_DEBUG)
+    if (present)
+    {
+        const VulkanImage& swapChainTextures = *TexturePool.Get(present);
+        CHECK(VulkanImage::IsSwapChainImage(swapChainTextures), "The passed present texture handle is not from a SwapChain");
+    }
+#endif
+
+    const bool shouldPresent = HasSwapChain() && present;
+
+    //If we a presenting a SwapChain image, signal our timeline semaphore
+    if (shouldPresent)
+    {
+        //Create a unique Signal Value
+        const uint64_t signalValue = SwapChain->CurrentFrame + SwapChain->NumberOfSwapChainImages;
+
+        //Wait for this value next time we want to acquire this SwapChain image
+        SwapChain->TimelineWaitValues[SwapChain->CurrentImageIndex] = signalValue;
+        VulkanCommandPool->Signal(TimelineSemaphore, signalValue);
+    }
+
+    FrameUploadRing->Flush();
+    Bindless->Flush();
+    vkCmdBuffer->LastSubmitHandle = VulkanCommandPool->Submit(*vkCmdBuffer->CommandBufferImpl);
+    FrameUploadRing->EndFrame(vkCmdBuffer->LastSubmitHandle);
+
+    if (shouldPresent)
+    {
+        SwapChain->Present(VulkanCommandPool->AcquireLastSubmitSemaphore());
+    }
+
+    ProcessDeferredTasks();
+
+    const EOS::SubmitHandle handle = vkCmdBuffer->LastSubmitHandle;
+    Budget->Update(handle.ID);
+    ProcessDefragmentation();
+    UpdatePipelineCompilations(false);
+    if (PipelineCache) { PipelineCache->Update(); }
+
+    //Reset the Command Buffer
+    CurrentCommandBuffer = {};
+
+    return handle;
+}
+
+void VulkanContext::Wait(const EOS::SubmitHandle handle)
+{
+    VulkanCommandPool->Wait(handle);
+
+    //The tasks that waited on this submission can run now
+    ProcessDeferredTasks();
+}
+
+EOS::TextureHandle VulkanContext::GetSwapChainTexture()
+{
+    CHECK(HasSwapChain(), "You dont have a SwapChain");
+    if (!HasSwapChain())
+    {
+       EOS::Logger->error("No SwapChain Found");
+    }
+
+    EOS::TextureHandle swapChainTexture = SwapChain->GetCurrentTexture();
+    CHECK(swapChainTexture.Valid(), "The SwapChain texture is not valid.");
+    CHECK(TexturePool.Get(swapChainTexture)->ImageFormat != VK_FORMAT_UNDEFINED, "Invalid image format");
+
+    return swapChainTexture;
+}
+
+EOS::Holder<EOS::ShaderModuleHandle> VulkanContext::CreateShaderModule(const EOS::ShaderInfo &shaderInfo)
+{
+    VkShaderModule vkShaderModule = VK_NULL_HANDLE;
+
+    const VkShaderModuleCreateInfo createInfo =
+    {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = shaderInfo.spirv.size() * sizeof(uint32_t),
+        .pCode = shaderInfo.spirv.data(),
+    };
+
+    VK_ASSERT(vkCreateShaderModule(VulkanDevice, &createInfo, nullptr, &vkShaderModule);)
+    CHECK(vkShaderModule != VK_NULL_HANDLE, "Failed to create shader module from ShaderInfo");
+
+    VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_SHADER_MODULE, reinterpret_cast<uint64_t>(vkShaderModule), shaderInfo.debugName));
+
+    VulkanShaderModuleState state
+    {
+        .ShaderModule = vkShaderModule,
+        .PushConstantsSize = shaderInfo.pushConstantSize
+    };
+
+    //The shader object is created from the same SPIR-V, with the same layout as the pipelines
+    if (HasShaderObjects())
     {
-        const VkSemaphoreWaitInfo waitInfo =
+        constexpr auto toShaderStage = [](const EOS::ShaderStage shaderStage) -> VkShaderStageFlagBits
         {
-            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
-            .semaphoreCount = 1,
-            .pSemaphores = &VkContext->TimelineSemaphore,
-            .pValues = &TimelineWaitValues[CurrentImageIndex],
+            switch (shaderStage)
+            {
+                case EOS::ShaderStage::Vertex:      return VK_SHADER_STAGE_VERTEX_BIT;
+                case EOS::ShaderStage::Hull:        return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+                case EOS::ShaderStage::Domain:      return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+                case EOS::ShaderStage::Geometry:    return VK_SHADER_STAGE_GEOMETRY_BIT;
+                case EOS::ShaderStage::Fragment:    return VK_SHADER_STAGE_FRAGMENT_BIT;
+                case EOS::ShaderStage::Compute:     return VK_SHADER_STAGE_COMPUTE_BIT;
+                default:                            return static_cast<VkShaderStageFlagBits>(0);
+            }
         };
 
-        // when timeout is set to UINT64_MAX, we wait until the next image has been acquired
-        VK_ASSERT(vkWaitSemaphores(VkContext->VulkanDevice, &waitInfo, UINT64_MAX));
+        //The stages that can follow this one, limited to the stages the device has enabled
+        const auto toNextStages = [this](const VkShaderStageFlagBits shaderStage) -> VkShaderStageFlags
+        {
+            const VkShaderStageFlags tessellationStage = Capabilities.TessellationShader ? VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT : 0u;
+            const VkShaderStageFlags geometryStage = Capabilities.GeometryShader ? VK_SHADER_STAGE_GEOMETRY_BIT : 0u;
+            switch (shaderStage)
+            {
+                case VK_SHADER_STAGE_VERTEX_BIT:                    return tessellationStage | geometryStage | VK_SHADER_STAGE_FRAGMENT_BIT;
+                case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT:      return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+                case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT:   return geometryStage | VK_SHADER_STAGE_FRAGMENT_BIT;
+                case VK_SHADER_STAGE_GEOMETRY_BIT:                  return VK_SHADER_STAGE_FRAGMENT_BIT;
+                default:                                            return 0u;
+            }
+        };
 
-        VkSemaphore& acquireSemaphore = AcquireSemaphores[CurrentImageIndex];
-        const VkResult result = vkAcquireNextImageKHR(VkContext->VulkanDevice, SwapChain, UINT64_MAX, acquireSemaphore, VK_NULL_HANDLE, &CurrentImageIndex);
-        CHECK(result == VK_SUCCESS || result == VK_SUBOPTIMAL_KHR || result == VK_ERROR_OUT_OF_DATE_KHR, "vkAcquireNextImageKHR Failed");
+        const VkShaderStageFlagBits stage = toShaderStage(shaderInfo.shaderStage);
+        const VkDescriptorSetLayout setLayout = Bindless->GetSetLayout();
+        const VkPushConstantRange pushConstantRange{ .stageFlags = VK_SHADER_STAGE_ALL, .offset = 0, .size = Bindless->GetPushConstantsSize() };
+        const VkShaderCreateInfoEXT shaderCreateInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT,
+            .stage = stage,
+            .nextStage = toNextStages(stage),
+            .codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT,
+            .codeSize = createInfo.codeSize,
+            .pCode = createInfo.pCode,
+            .pName = "main",
+            .setLayoutCount = 1,
+            .pSetLayouts = &setLayout,
+            .pushConstantRangeCount = 1,
+            .pPushConstantRanges = &pushConstantRange,
+        };
 
-        GetNextImage = false;
-        VkContext->VulkanCommandPool->WaitSemaphore(acquireSemaphore);
+        if (stage != 0)
+        {
+            VK_ASSERT(vkCreateShadersEXT(VulkanDevice, 1, &shaderCreateInfo, nullptr, &state.ShaderObject));
+            VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_SHADER_EXT, reinterpret_cast<uint64_t>(state.ShaderObject), shaderInfo.debugName));
+        }
     }
+
+    return {this, ShaderModulePool.Create(std::move(state))};
 }
 
-VkSurfaceFormatKHR VulkanSwapChain::GetSwapChainFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats, EOS::ColorSpace desiredColorSpace)
+EOS::Holder<EOS::SamplerHandle> VulkanContext::CreateSampler(const EOS::SamplerDescription& samplerDescription)
 {
-    //TODO: Look into VkSurfaceFormat2KHR -> this enables Compression of the swapChain image
-    //https://docs.vulkan.org/samples/latest/samples/performance/image_compression_control/README.html
+    return {this, AcquireSampler(samplerDescription)};
+}
 
-    //Non Linear is the default
-    VkSurfaceFormatKHR preferred{VK_FORMAT_R8G8B8A8_SRGB, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
-    if (desiredColorSpace == EOS::ColorSpace::SRGB_Linear)
+EOS::SamplerHandle VulkanContext::AcquireSampler(const EOS::SamplerDescription& samplerDescription)
+{
+    if (const auto cached = SamplerCache.find(samplerDescription); cached != SamplerCache.end())
     {
-        // VK_COLOR_SPACE_BT709_LINEAR_EXT is the closest space to linear
-        preferred  = VkSurfaceFormatKHR{VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_BT709_LINEAR_EXT};
+        ++SamplerPool.Get(cached->second)->NumReferences;
+        return cached->second;
     }
 
-    //Check if we have a combination with our desired format & color space
-    for (const VkSurfaceFormatKHR& fmt : availableFormats)
+    constexpr auto toFilter = [](const EOS::SamplerFilter filter) { return filter == EOS::SamplerFilter::Linear ? VK_FILTER_LINEAR : VK_FILTER_NEAREST; };
+    constexpr auto toAddressMode = [](const EOS::SamplerWrap wrap)
     {
-        if (fmt.format == preferred.format && fmt.colorSpace == preferred.colorSpace) { return fmt; }
-    }
+        switch (wrap)
+        {
+            case EOS::SamplerWrap::Clamp:           return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+            case EOS::SamplerWrap::MirrorRepeat:    return VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+            case EOS::SamplerWrap::ClampToBorder:   return VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+            default:                                return VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        }
+    };
 
-    // if we can't find a matching format and color space, fallback on matching only format
-    for (const VkSurfaceFormatKHR& fmt : availableFormats)
+    //The overrides of the configuration are applied here, so every sampler gets them
+    const float maxAnisotropy = std::min({samplerDescription.MaxAnisotropy, Configuration.MaxSamplerAnisotropy, Capabilities.MaxSamplerAnisotropy});
+    const bool isMipMapped = samplerDescription.MipMap != EOS::SamplerMipMap::Disabled;
+    const VkSamplerCreateInfo samplerCreateInfo
     {
-        if (fmt.format == preferred.format) { return fmt; }
-    }
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .magFilter = toFilter(samplerDescription.MagFilter),
+        .minFilter = toFilter(samplerDescription.MinFilter),
+        .mipmapMode = samplerDescription.MipMap == EOS::SamplerMipMap::Linear ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = toAddressMode(samplerDescription.WrapU),
+        .addressModeV = toAddressMode(samplerDescription.WrapV),
+        .addressModeW = toAddressMode(samplerDescription.WrapW),
+        .mipLodBias = samplerDescription.MipLodBias + Configuration.SamplerMipLodBias,
+        .anisotropyEnable = maxAnisotropy > 1.0f ? VK_TRUE : VK_FALSE,
+        .maxAnisotropy = maxAnisotropy,
+        .compareEnable = samplerDescription.DepthCompareEnabled ? VK_TRUE : VK_FALSE,
+        .compareOp = static_cast<VkCompareOp>(samplerDescription.DepthCompareOp),
+        .minLod = isMipMapped ? samplerDescription.MipLodMin : 0.0f,
+        .maxLod = isMipMapped ? samplerDescription.MipLodMax : 0.25f,    //Only samples the first mip level, the spec recommends 0.25 for this
+        .borderColor = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK,
+    };
 
-    //If we still haven't found a format we just pick the first available option
-    return availableFormats[0];
-}
+    VkSampler vkSampler = VK_NULL_HANDLE;
+    VK_ASSERT(vkCreateSampler(VulkanDevice, &samplerCreateInfo, nullptr, &vkSampler));
+    VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_SAMPLER, reinterpret_cast<uint64_t>(vkSampler), samplerDescription.DebugName));
 
+    const EOS::SamplerHandle handle = SamplerPool.Create(VulkanSampler{ .Sampler = vkSampler, .Description = samplerDescription, .NumReferences = 1 });
+    Bindless->SetSampler(handle.Index(), vkSampler);
+    SamplerCache.emplace(samplerDescription, handle);
 
-VulkanSwapChainSupportDetails::VulkanSwapChainSupportDetails(const VulkanContext& vulkanContext)
-{
-    //Get Surface Capabilities
-    VK_ASSERT(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &capabilities));
+    return handle;
+}
 
-    //Get the Surface Support
-    VK_ASSERT(vkGetPhysicalDeviceSurfaceSupportKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanDeviceQueues.Graphics.QueueFamilyIndex, vulkanContext.VulkanSurface, &queueFamilySupportsPresentation));
+size_t SamplerDescriptionHash::operator()(const EOS::SamplerDescription& description) const
+{
+    uint64_t hash = EOS::HashSeed;
+    EOS::HashCombine(hash, static_cast<uint64_t>(description.MinFilter) | static_cast<uint64_t>(description.MagFilter) << 8 | static_cast<uint64_t>(description.MipMap) << 16 | static_cast<uint64_t>(description.DepthCompareOp) << 24);
+    EOS::HashCombine(hash, static_cast<uint64_t>(description.WrapU) | static_cast<uint64_t>(description.WrapV) << 8 | static_cast<uint64_t>(description.WrapW) << 16 | static_cast<uint64_t>(description.DepthCompareEnabled) << 24);
+    EOS::HashCombine(hash, static_cast<uint64_t>(std::bit_cast<uint32_t>(description.MipLodMin)) | static_cast<uint64_t>(std::bit_cast<uint32_t>(description.MipLodMax)) << 32);
+    EOS::HashCombine(hash, static_cast<uint64_t>(std::bit_cast<uint32_t>(description.MipLodBias)) | static_cast<uint64_t>(std::bit_cast<uint32_t>(description.MaxAnisotropy)) << 32);
+    return static_cast<size_t>(hash);
+}
 
-    //Get the available Surface Formats
-    uint32_t formatCount;
-    VK_ASSERT(vkGetPhysicalDeviceSurfaceFormatsKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &formatCount, nullptr));
-    formats.resize(formatCount);
-    VK_ASSERT(vkGetPhysicalDeviceSurfaceFormatsKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &formatCount, formats.data()));
+bool VulkanPipeline::Resolve(const bool wait)
+{
+    if (!Compilation.valid()) { return !HasFailed; }
+    if (!wait && Compilation.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return false; }
 
-    //Get the available Present Modes
-    uint32_t presentModeCount;
-    VK_ASSERT(vkGetPhysicalDeviceSurfacePresentModesKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &presentModeCount, nullptr));
-    presentModes.resize(presentModeCount);
-    VK_ASSERT(vkGetPhysicalDeviceSurfacePresentModesKHR(vulkanContext.VulkanPhysicalDevice, vulkanContext.VulkanSurface, &presentModeCount, presentModes.data()));
+    Pipeline = Compilation.get();
+    HasFailed = Pipeline == VK_NULL_HANDLE;
+    return !HasFailed;
 }
 
-CommandPool::CommandPool(const VkDevice &device, uint32_t queueIndex)
-    : Device(device)
+EOS::Holder<EOS::ComputePipelineHandle> VulkanContext::CreateComputePipeline(const EOS::ComputePipelineDescription& computePipelineDescription)
 {
-    WaitSemaphores.reserve(2);
-    SignalSemaphores.reserve(2);
+    const VulkanShaderModuleState* computeShader = ShaderModulePool.Get(computePipelineDescription.ComputeShader);
+    CHECK(computeShader, "Trying to create the compute pipeline {} without a compute shader", computePipelineDescription.DebugName);
+    if (!computeShader) { return {}; }
 
-    vkGetDeviceQueue(device, queueIndex, 0, &Queue); //Store a copy of the Queue
+    //Every pipeline shares the layout of the bindless heap, the push constants the reflection found in the shader have to fit in it
+    CHECK(computeShader->PushConstantsSize <= Bindless->GetPushConstantsSize(), "The {} bytes of push constants of {} don't fit in the {} bytes of the pipeline layout", computeShader->PushConstantsSize, computePipelineDescription.DebugName, Bindless->GetPushConstantsSize());
 
-    const VkCommandPoolCreateInfo createInfo =
+    //The specialization is copied, the pipeline might get built on a worker thread after the caller's data is gone
+    const EOS::SpecializationInfo& specialization = computePipelineDescription.Specialization;
+    ComputePipelineState state{ .ComputeShader = computeShader->ShaderModule, .DebugName = computePipelineDescription.DebugName };
+    for (const EOS::SpecializationConstant& constant : specialization.Constants)
     {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
-        .queueFamilyIndex = queueIndex,
-    };
+        CHECK(constant.Offset + constant.Size <= specialization.DataSize, "The specialization constant {} of {} reads past its data", constant.ID, computePipelineDescription.DebugName);
+        state.SpecializationEntries.push_back({ .constantID = constant.ID, .offset = constant.Offset, .size = constant.Size });
+    }
+    if (specialization.Data)
+    {
+        const uint8_t* data = static_cast<const uint8_t*>(specialization.Data);
+        state.SpecializationData.assign(data, data + specialization.DataSize);
+    }
 
-    VK_ASSERT(vkCreateCommandPool(device, &createInfo, nullptr, &VulkanCommandPool));
-    VK_ASSERT(VkDebug::SetDebugObjectName(device, VK_OBJECT_TYPE_COMMAND_POOL, reinterpret_cast<uint64_t>(VulkanCommandPool), "CommandPool"));
+    VulkanPipeline pipeline = CompilePipeline([this, state](const VkPipelineCreateFlags flags, VkPipeline& outPipeline) { return BuildComputePipeline(state, flags, outPipeline); });
+    pipeline.Shaders = { state.ComputeShader };
 
-    const VkCommandBufferAllocateInfo allocateInfo =
+    const bool isCompiling = pipeline.Compilation.valid();
+    const EOS::ComputePipelineHandle handle = ComputePipelinePool.Create(std::move(pipeline));
+    if (isCompiling) { CompilingComputePipelines.push_back(handle); }
+
+    return {this, handle};
+}
+
+EOS::Holder<EOS::RenderPipelineHandle> VulkanContext::CreateRenderPipeline(const EOS::RenderPipelineDescription& renderPipelineDescription)
+{
+    const VulkanShaderModuleState* vertexShader = ShaderModulePool.Get(renderPipelineDescription.VertexShader);
+    CHECK(vertexShader, "Trying to create the render pipeline {} without a vertex shader", renderPipelineDescription.DebugName);
+    if (!vertexShader) { return {}; }
+
+    //Without a fragment shader the pipeline only writes depth
+    const VulkanShaderModuleState* fragmentShader = ShaderModulePool.Get(renderPipelineDescription.FragmentShader);
+
+    const uint32_t pushConstantsSize = std::max(vertexShader->PushConstantsSize, fragmentShader ? fragmentShader->PushConstantsSize : 0u);
+    CHECK(pushConstantsSize <= Bindless->GetPushConstantsSize(), "The {} bytes of push constants of {} don't fit in the {} bytes of the pipeline layout", pushConstantsSize, renderPipelineDescription.DebugName, Bindless->GetPushConstantsSize());
+
+    const RenderPipelineState state
     {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .commandPool = VulkanCommandPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = 1,
+        .Description = renderPipelineDescription,
+        .VertexShader = vertexShader->ShaderModule,
+        .FragmentShader = fragmentShader ? fragmentShader->ShaderModule : VK_NULL_HANDLE,
+        .DebugName = renderPipelineDescription.DebugName,
     };
 
-    //Allocate buffers for each buffer in our pool
-    for (uint32_t i{}; i < MaxCommandBuffers; ++i)
+    VulkanPipeline pipeline{};
+    if (!Capabilities.GraphicsPipelineLibrary)
     {
-        VK_ASSERT(vkAllocateCommandBuffers(device, &allocateInfo, &Buffers[i].VulkanCommandBufferAllocated));
-        Buffers[i].Semaphore = VkSynchronization::CreateSemaphore(device, fmt::format("Semaphore of CommandBuffer: {}", i).c_str());
-        Buffers[i].Fence = VkSynchronization::CreateFence(device, fmt::format("Fence of CommandBuffer: {}", i).c_str());
-        Buffers[i].Handle.BufferIndex = i;
+        pipeline = CompilePipeline([this, state](const VkPipelineCreateFlags flags, VkPipeline& outPipeline) { return BuildRenderPipeline(state, flags, outPipeline); });
+    }
+    //The optimized link might already be in the pipeline cache, otherwise a fast link of the parts is used until the optimized link is done
+    else if (LinkRenderPipeline(state, VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT, true, pipeline.Pipeline) != VK_SUCCESS)
+    {
+        pipeline.Pipeline = VK_NULL_HANDLE;
+        auto fastLink = [this, state](const VkPipelineCreateFlags flags, VkPipeline& outPipeline) { return LinkRenderPipeline(state, flags, false, outPipeline); };
+        auto optimizedLink = [this, state](const VkPipelineCreateFlags flags, VkPipeline& outPipeline) { return LinkRenderPipeline(state, flags, true, outPipeline); };
 
-        ++NumberOfAvailableCommandBuffers;
+        //The optimized link comes after the fast link on the same worker, so it finds the parts the fast link compiled instead of compiling them again
+        if (fastLink(VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT, pipeline.Pipeline) == VK_SUCCESS)
+        {
+            pipeline.Optimization = std::move(CompileOnWorker({optimizedLink}).front());
+        }
+        else
+        {
+            pipeline.Pipeline = VK_NULL_HANDLE;
+            std::vector<std::future<VkPipeline>> links = CompileOnWorker({fastLink, optimizedLink});
+            pipeline.Compilation = std::move(links[0]);
+            pipeline.Optimization = std::move(links[1]);
+        }
     }
+    pipeline.Shaders = { state.VertexShader, state.FragmentShader };
+
+    const bool isCompiling = pipeline.Compilation.valid() || pipeline.Optimization.valid();
+    const EOS::RenderPipelineHandle handle = RenderPipelinePool.Create(std::move(pipeline));
+    if (isCompiling) { CompilingRenderPipelines.push_back(handle); }
+
+    return {this, handle};
 }
 
-CommandPool::~CommandPool()
+EOS::Holder<EOS::RenderPipelineHandle> VulkanContext::CreateRenderPipeline(const EOS::RenderPipelineDescription& renderPipelineDescription, const EOS::Framebuffer& framebuffer)
 {
-    //Wait until everything is processed
-    WaitAll();
+    EOS::RenderPipelineDescription description = renderPipelineDescription;
+    description.DepthFormat = EOS::Format::Invalid;
+    description.NumSamples = 1;
 
-    //Destroy all data of the buffers
-    for (CommandBufferData& buffer : Buffers)
+    for (EOS::ColorAttachmentDescription& colorAttachment : description.ColorAttachments)
     {
-        vkDestroyFence(Device, buffer.Fence, nullptr);
-        vkDestroySemaphore(Device, buffer.Semaphore, nullptr);
+        colorAttachment.ColorFormat = EOS::Format::Invalid;
     }
 
-    //Destroy the internal pool itself
-    vkDestroyCommandPool(Device, VulkanCommandPool, nullptr);
+    for (uint32_t i{}; i < EOS::MaxColorAttachments; ++i)
+    {
+        const VulkanImage* image = TexturePool.Get(framebuffer.ColorAttachments[i].Texture);
+        if (!image) { break; }
+
+        description.ColorAttachments[i].ColorFormat = VulkanImage::ToFormat(image->ImageFormat);
+        CHECK(description.ColorAttachments[i].ColorFormat != EOS::Format::Invalid, "The format of color attachment {} of {} has no EOS::Format", i, renderPipelineDescription.DebugName);
+        description.NumSamples = static_cast<uint32_t>(image->Samples);
+    }
+
+    if (const VulkanImage* depthImage = TexturePool.Get(framebuffer.Depth.Texture))
+    {
+        description.DepthFormat = VulkanImage::ToFormat(depthImage->ImageFormat);
+        description.NumSamples = static_cast<uint32_t>(depthImage->Samples);
+    }
+
+    return CreateRenderPipeline(description);
 }
 
-void CommandPool::WaitSemaphore(const VkSemaphore& semaphore)
+bool VulkanContext::IsPipelineReady(const EOS::ComputePipelineHandle handle)
 {
-    CHECK(WaitOnSemaphore.semaphore == VK_NULL_HANDLE, "The wait Semaphore is not Empty");
-    WaitOnSemaphore.semaphore = semaphore;
+    VulkanPipeline* pipeline = ComputePipelinePool.Get(handle);
+    return pipeline && pipeline->Resolve(false);
 }
 
-void CommandPool::WaitAll()
+bool VulkanContext::IsPipelineReady(const EOS::RenderPipelineHandle handle)
 {
-    VkFence fences[MaxCommandBuffers];
-    uint32_t numFences = 0;
+    VulkanPipeline* pipeline = RenderPipelinePool.Get(handle);
+    return pipeline && pipeline->Resolve(false);
+}
 
-    for (const CommandBufferData& buffer : Buffers)
-    {
-        if (buffer.VulkanCommandBuffer != VK_NULL_HANDLE && !buffer.isEncoding)
-        {
-            fences[numFences++] = buffer.Fence;
-        }
-    }
+bool VulkanContext::HasShaderObjects() const
+{
+    return Capabilities.ShaderObject && Configuration.UseShaderObjects;
+}
 
-    if (numFences)
+VulkanPipeline VulkanContext::CompilePipeline(std::function<VkResult(VkPipelineCreateFlags flags, VkPipeline& outPipeline)> build)
+{
+    VulkanPipeline pipeline{};
+
+    //Getting a pipeline out of the cache is cheap, only when it would have to be compiled it is handed to a worker thread
+    const VkResult probeResult = build(VK_PIPELINE_CREATE_FAIL_ON_PIPELINE_COMPILE_REQUIRED_BIT, pipeline.Pipeline);
+    if (probeResult == VK_SUCCESS) { return pipeline; }
+    CHECK(probeResult == VK_PIPELINE_COMPILE_REQUIRED, "Failed to create a pipeline");
+    if (probeResult != VK_PIPELINE_COMPILE_REQUIRED)
     {
-        VK_ASSERT(vkWaitForFences(Device, numFences, fences, VK_TRUE, UINT64_MAX));
+        pipeline.Pipeline = VK_NULL_HANDLE;
+        pipeline.HasFailed = true;
+        return pipeline;
     }
 
-    TryResetCommandBuffers();
+    pipeline.Compilation = std::move(CompileOnWorker({std::move(build)}).front());
+    return pipeline;
 }
 
-void CommandPool::Wait(const EOS::SubmitHandle handle)
+std::vector<std::future<VkPipeline>> VulkanContext::CompileOnWorker(std::vector<std::function<VkResult(VkPipelineCreateFlags flags, VkPipeline& outPipeline)>> builds)
 {
-    if (handle.Empty())
+    if (!PipelineWorkers)
     {
-        vkDeviceWaitIdle(Device);
-        return;
+        PipelineWorkers = std::make_unique<EOS::ThreadPool>();
     }
 
-    if (IsReady(handle))
+    auto compiled = std::make_shared<std::vector<std::promise<VkPipeline>>>(builds.size());
+    std::vector<std::future<VkPipeline>> futures;
+    futures.reserve(builds.size());
+    for (std::promise<VkPipeline>& promise : *compiled)
     {
-        return;
+        futures.emplace_back(promise.get_future());
     }
 
-    const bool isEncoding = Buffers[handle.BufferIndex].isEncoding;
-    CHECK(!isEncoding, "The buffer is not submitted yet, this should not be possible");
-    if (isEncoding)
+    PipelineWorkers->Enqueue([compiled, builds = std::move(builds)]()
     {
-        //This buffer has never been submitted, this should not be possible at this point.
-        return;
-    }
-
-    VK_ASSERT(vkWaitForFences(Device, 1, &Buffers[handle.BufferIndex].Fence, VK_TRUE, UINT64_MAX));
+        for (size_t i{}; i < builds.size(); ++i)
+        {
+            VkPipeline vkPipeline = VK_NULL_HANDLE;
+            const VkResult buildResult = builds[i](0, vkPipeline);
+            if (buildResult != VK_SUCCESS)
+            {
+                EOS::Logger->error("Failed to compile a pipeline on a worker thread, VkResult: {}", static_cast<int32_t>(buildResult));
+                vkPipeline = VK_NULL_HANDLE;
+            }
+            (*compiled)[i].set_value(vkPipeline);
+        }
+    });
 
-    TryResetCommandBuffers();
+    return futures;
 }
 
-void CommandPool::Signal(const VkSemaphore& semaphore, const uint64_t& signalValue)
+VkResult VulkanContext::BuildComputePipeline(const ComputePipelineState& state, const VkPipelineCreateFlags flags, VkPipeline& outPipeline) const
 {
-    CHECK(semaphore != VK_NULL_HANDLE, "The passed semaphore parameter is not valid.");
-    SignalSemaphore.semaphore = semaphore;
-    SignalSemaphore.value = signalValue;
-}
+    const VkSpecializationInfo specializationInfo
+    {
+        .mapEntryCount = static_cast<uint32_t>(state.SpecializationEntries.size()),
+        .pMapEntries = state.SpecializationEntries.data(),
+        .dataSize = state.SpecializationData.size(),
+        .pData = state.SpecializationData.data(),
+    };
 
-bool CommandPool::IsReady(EOS::SubmitHandle handle, bool fastCheck) const
-{
-    //If its a empty handle then its "ready"
-    if (handle.Empty())
+    const VkComputePipelineCreateInfo createInfo
     {
-        return true;
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .flags = flags | Bindless->GetPipelineCreateFlags(),
+        .stage =
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = state.ComputeShader,
+            .pName = "main",
+            .pSpecializationInfo = state.SpecializationEntries.empty() ? nullptr : &specializationInfo,
+        },
+        .layout = Bindless->GetPipelineLayout(),
+    };
+
+    const VkResult createResult = vkCreateComputePipelines(VulkanDevice, PipelineCache ? PipelineCache->Get() : VK_NULL_HANDLE, 1, &createInfo, nullptr, &outPipeline);
+    if (createResult == VK_SUCCESS)
+    {
+        VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(outPipeline), state.DebugName.c_str()));
     }
 
-    CHECK(handle.BufferIndex < MaxCommandBuffers, "The buffer index of the given handle is bigger then the MaxCommandBuffers.");
+    return createResult;
+}
 
-    const CommandBufferData& buffer = Buffers[handle.BufferIndex];
+GraphicsPipelineStates::GraphicsPipelineStates(const RenderPipelineState& state)
+{
+    const EOS::RenderPipelineDescription& description = state.Description;
 
-    //If the buffer is not in use.
-    if (buffer.VulkanCommandBuffer == VK_NULL_HANDLE)
+    constexpr auto toBlendState = [](const EOS::BlendMode blendMode)
     {
-        return true;
-    }
+        VkPipelineColorBlendAttachmentState blendState
+        {
+            .blendEnable = blendMode != EOS::BlendMode::Opaque ? VK_TRUE : VK_FALSE,
+            .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+            .dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+            .colorBlendOp = VK_BLEND_OP_ADD,
+            .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+            .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+            .alphaBlendOp = VK_BLEND_OP_ADD,
+            .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT,
+        };
+        if (blendMode == EOS::BlendMode::AlphaBlend)
+        {
+            blendState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        }
+        else if (blendMode == EOS::BlendMode::Additive)
+        {
+            blendState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+            blendState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        }
+        return blendState;
+    };
 
-    //If the handle to the buffer is no longer in use by the command buffer is was created for
-    if (buffer.Handle.ID != handle.ID)
+    uint32_t numColorAttachments = 0;
+    for (; numColorAttachments < EOS::MaxColorAttachments && description.ColorAttachments[numColorAttachments].ColorFormat != EOS::Format::Invalid; ++numColorAttachments)
     {
-        return true;
+        ColorFormats[numColorAttachments] = VulkanImage::ToVkFormat(description.ColorAttachments[numColorAttachments].ColorFormat);
+        BlendStates[numColorAttachments] = toBlendState(description.ColorAttachments[numColorAttachments].Blending);
     }
 
-    // Don't check the fence.
-    if (fastCheck)
+    const VkFormat depthFormat = VulkanImage::ToVkFormat(description.DepthFormat);
+    Rendering =
     {
-        return false;
-    }
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+        .colorAttachmentCount = numColorAttachments,
+        .pColorAttachmentFormats = ColorFormats.data(),
+        .depthAttachmentFormat = depthFormat,
+        .stencilAttachmentFormat = VulkanImage::HasStencil(depthFormat) ? depthFormat : VK_FORMAT_UNDEFINED,
+    };
 
-    return vkWaitForFences(Device, 1, &buffer.Fence, VK_TRUE, 0) == VK_SUCCESS;
+    Stages[0] = { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .stage = VK_SHADER_STAGE_VERTEX_BIT, .module = state.VertexShader, .pName = "main" };
+    Stages[1] = { .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .module = state.FragmentShader, .pName = "main" };
+    NumStages = state.FragmentShader != VK_NULL_HANDLE ? 2 : 1;
+
+    //The enums of the description are cast straight to their Vulkan values
+    static_assert(static_cast<VkPrimitiveTopology>(EOS::Topology::Point) == VK_PRIMITIVE_TOPOLOGY_POINT_LIST);
+    static_assert(static_cast<VkPrimitiveTopology>(EOS::Topology::Line) == VK_PRIMITIVE_TOPOLOGY_LINE_LIST);
+    static_assert(static_cast<VkPrimitiveTopology>(EOS::Topology::LineStrip) == VK_PRIMITIVE_TOPOLOGY_LINE_STRIP);
+    static_assert(static_cast<VkPrimitiveTopology>(EOS::Topology::Triangle) == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    static_assert(static_cast<VkPrimitiveTopology>(EOS::Topology::TriangleStrip) == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP);
+    static_assert(static_cast<VkPolygonMode>(EOS::PolygonMode::Fill) == VK_POLYGON_MODE_FILL);
+    static_assert(static_cast<VkPolygonMode>(EOS::PolygonMode::Line) == VK_POLYGON_MODE_LINE);
+    static_assert(static_cast<VkCullModeFlags>(EOS::CullMode::None) == VK_CULL_MODE_NONE);
+    static_assert(static_cast<VkCullModeFlags>(EOS::CullMode::Front) == VK_CULL_MODE_FRONT_BIT);
+    static_assert(static_cast<VkCullModeFlags>(EOS::CullMode::Back) == VK_CULL_MODE_BACK_BIT);
+    static_assert(static_cast<VkFrontFace>(EOS::WindingMode::CounterClockWise) == VK_FRONT_FACE_COUNTER_CLOCKWISE);
+    static_assert(static_cast<VkFrontFace>(EOS::WindingMode::ClockWise) == VK_FRONT_FACE_CLOCKWISE);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::Never) == VK_COMPARE_OP_NEVER);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::Less) == VK_COMPARE_OP_LESS);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::Equal) == VK_COMPARE_OP_EQUAL);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::LessEqual) == VK_COMPARE_OP_LESS_OR_EQUAL);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::Greater) == VK_COMPARE_OP_GREATER);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::NotEqual) == VK_COMPARE_OP_NOT_EQUAL);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::GreaterEqual) == VK_COMPARE_OP_GREATER_OR_EQUAL);
+    static_assert(static_cast<VkCompareOp>(EOS::CompareOp::AlwaysPass) == VK_COMPARE_OP_ALWAYS);
+
+    //Vertices are pulled from buffers through their GPU address, so there is no vertex input
+    VertexInput = { .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO };
+    InputAssembly =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = static_cast<VkPrimitiveTopology>(description.PrimitiveTopology),
+    };
+    Viewport = { .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO };     // the counts are dynamic as well
+    Rasterization =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .polygonMode = static_cast<VkPolygonMode>(description.Polygon),
+        .cullMode = static_cast<VkCullModeFlags>(description.Culling),
+        .frontFace = static_cast<VkFrontFace>(description.FrontFace),
+        .lineWidth = 1.0f,
+    };
+    Multisample =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = static_cast<VkSampleCountFlagBits>(description.NumSamples),
+    };
+    DepthStencil =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = depthFormat != VK_FORMAT_UNDEFINED ? VK_TRUE : VK_FALSE,
+        .depthWriteEnable = description.DepthWriteEnabled ? VK_TRUE : VK_FALSE,
+        .depthCompareOp = static_cast<VkCompareOp>(description.DepthCompareOp),
+    };
+    ColorBlend =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .attachmentCount = numColorAttachments,
+        .pAttachments = BlendStates.data(),
+    };
+    Dynamic =
+    {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .dynamicStateCount = static_cast<uint32_t>(DynamicStates.size()),
+        .pDynamicStates = DynamicStates.data(),
+    };
 }
 
-VkSemaphore CommandPool::AcquireLastSubmitSemaphore()
+VkResult VulkanContext::BuildRenderPipeline(const RenderPipelineState& state, const VkPipelineCreateFlags flags, VkPipeline& outPipeline) const
 {
-    return std::exchange(LastSubmitSemaphore.semaphore, VK_NULL_HANDLE);;
+    const GraphicsPipelineStates states(state);
+    const VkGraphicsPipelineCreateInfo createInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &states.Rendering,
+        .flags = flags | Bindless->GetPipelineCreateFlags(),
+        .stageCount = states.NumStages,
+        .pStages = states.Stages.data(),
+        .pVertexInputState = &states.VertexInput,
+        .pInputAssemblyState = &states.InputAssembly,
+        .pViewportState = &states.Viewport,
+        .pRasterizationState = &states.Rasterization,
+        .pMultisampleState = &states.Multisample,
+        .pDepthStencilState = &states.DepthStencil,
+        .pColorBlendState = &states.ColorBlend,
+        .pDynamicState = &states.Dynamic,
+        .layout = Bindless->GetPipelineLayout(),
+    };
+
+    const VkResult createResult = vkCreateGraphicsPipelines(VulkanDevice, PipelineCache ? PipelineCache->Get() : VK_NULL_HANDLE, 1, &createInfo, nullptr, &outPipeline);
+    if (createResult == VK_SUCCESS)
+    {
+        VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(outPipeline), state.DebugName.c_str()));
+    }
+
+    return createResult;
 }
 
-EOS::SubmitHandle CommandPool::Submit(CommandBufferData& data)
+VkResult VulkanContext::GetPipelineLibrary(const RenderPipelineState& state, const VkGraphicsPipelineLibraryFlagBitsEXT part, const VkPipelineCreateFlags flags, VkPipeline& outLibrary)
 {
-    CHECK(data.isEncoding, "The buffer you want to submit is not recording.");
-    VK_ASSERT(vkEndCommandBuffer(data.VulkanCommandBuffer));
+    const uint64_t hash = HashPipelineLibrary(state, part);
+    {
+        std::scoped_lock lock(PipelineLibrariesMutex);
+        if (const auto cached = PipelineLibraries.find(hash); cached != PipelineLibraries.end())
+        {
+            outLibrary = cached->second.Library;
+            return VK_SUCCESS;
+        }
+    }
 
-    //TODO instead of keeping members and them pushing them into vectors here.
-    //Just Emplace the objects directly into the vector and remove the WaitOn Last Submit members
-    WaitSemaphores.clear(); //TODO: double check clearing doesn't reduce memory
-    if (WaitOnSemaphore.semaphore)
+    //Every part gets the states it needs, the others are ignored
+    const GraphicsPipelineStates states(state);
+    const VkGraphicsPipelineLibraryCreateInfoEXT libraryCreateInfo
     {
-        WaitSemaphores.emplace_back(WaitOnSemaphore);
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT,
+        .pNext = &states.Rendering,
+        .flags = static_cast<VkGraphicsPipelineLibraryFlagsEXT>(part),
+    };
+    VkGraphicsPipelineCreateInfo createInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &libraryCreateInfo,
+        .flags = flags | VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT | Bindless->GetPipelineCreateFlags(),
+    };
+
+    VkShaderModule shader = VK_NULL_HANDLE;
+    switch (part)
+    {
+        case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+            createInfo.pVertexInputState = &states.VertexInput;
+            createInfo.pInputAssemblyState = &states.InputAssembly;
+            break;
+        case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+            shader = state.VertexShader;
+            createInfo.stageCount = 1;
+            createInfo.pStages = &states.Stages[0];
+            createInfo.pViewportState = &states.Viewport;
+            createInfo.pRasterizationState = &states.Rasterization;
+            createInfo.pDynamicState = &states.Dynamic;
+            createInfo.layout = Bindless->GetPipelineLayout();
+            break;
+        case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+            shader = state.FragmentShader;
+            createInfo.stageCount = states.NumStages - 1;
+            createInfo.pStages = &states.Stages[1];
+            createInfo.pMultisampleState = &states.Multisample;
+            createInfo.pDepthStencilState = &states.DepthStencil;
+            createInfo.layout = Bindless->GetPipelineLayout();
+            break;
+        default:
+            createInfo.pMultisampleState = &states.Multisample;
+            createInfo.pColorBlendState = &states.ColorBlend;
+            break;
     }
-    if (LastSubmitSemaphore.semaphore)
+
+    VkPipeline library = VK_NULL_HANDLE;
+    const VkResult createResult = vkCreateGraphicsPipelines(VulkanDevice, PipelineCache ? PipelineCache->Get() : VK_NULL_HANDLE, 1, &createInfo, nullptr, &library);
+    if (createResult != VK_SUCCESS) { return createResult; }
+
+    std::scoped_lock lock(PipelineLibrariesMutex);
+    const auto [entry, isInserted] = PipelineLibraries.try_emplace(hash, PipelineLibrary{ .Library = library, .Shader = shader });
+    if (!isInserted)
     {
-        WaitSemaphores.emplace_back(LastSubmitSemaphore);
+        //An other worker thread created the same part in the meantime
+        vkDestroyPipeline(VulkanDevice, library, nullptr);
     }
+    outLibrary = entry->second.Library;
 
-    SignalSemaphores.clear();
-    SignalSemaphores.emplace_back(VkSemaphoreSubmitInfo
+    return VK_SUCCESS;
+}
+
+VkResult VulkanContext::LinkRenderPipeline(const RenderPipelineState& state, const VkPipelineCreateFlags flags, const bool optimize, VkPipeline& outPipeline)
+{
+    constexpr std::array<VkGraphicsPipelineLibraryFlagBitsEXT, 4> parts
     {
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
-        .semaphore = data.Semaphore,
-        .stageMask = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT
-    });
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+    };
 
-    if (SignalSemaphore.semaphore)
+    std::array<VkPipeline, parts.size()> libraries{};
+    for (size_t i{}; i < parts.size(); ++i)
     {
-        SignalSemaphores.emplace_back(SignalSemaphore);
+        if (const VkResult libraryResult = GetPipelineLibrary(state, parts[i], flags, libraries[i]); libraryResult != VK_SUCCESS)
+        {
+            return libraryResult;
+        }
     }
 
-    const VkCommandBufferSubmitInfo bufferSubmitInfo =
+    const VkPipelineLibraryCreateInfoKHR linkCreateInfo
     {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
-        .commandBuffer = data.VulkanCommandBuffer,
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR,
+        .libraryCount = static_cast<uint32_t>(libraries.size()),
+        .pLibraries = libraries.data(),
     };
-
-    const VkSubmitInfo2 submitInfo =
+    const VkGraphicsPipelineCreateInfo createInfo
     {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
-        .waitSemaphoreInfoCount = static_cast<uint32_t>(WaitSemaphores.size()),
-        .pWaitSemaphoreInfos = WaitSemaphores.data(),
-        .commandBufferInfoCount = 1,
-        .pCommandBufferInfos = &bufferSubmitInfo,
-        .signalSemaphoreInfoCount = static_cast<uint32_t>(SignalSemaphores.size()),
-        .pSignalSemaphoreInfos = SignalSemaphores.data(),
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = &linkCreateInfo,
+        .flags = flags | (optimize ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0u) | Bindless->GetPipelineCreateFlags(),
+        .layout = Bindless->GetPipelineLayout(),
     };
 
-    VK_ASSERT(vkQueueSubmit2(Queue, 1, &submitInfo, data.Fence));
+    const VkResult createResult = vkCreateGraphicsPipelines(VulkanDevice, PipelineCache ? PipelineCache->Get() : VK_NULL_HANDLE, 1, &createInfo, nullptr, &outPipeline);
+    if (createResult == VK_SUCCESS)
+    {
+        VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_PIPELINE, reinterpret_cast<uint64_t>(outPipeline), state.DebugName.c_str()));
+    }
 
-    LastSubmitSemaphore.semaphore = data.Semaphore;
-    LastSubmitHandle = data.Handle;
-    WaitOnSemaphore.semaphore = VK_NULL_HANDLE;
-    SignalSemaphore.semaphore = VK_NULL_HANDLE;
+    return createResult;
+}
 
-    data.isEncoding = false;
-    ++SubmitCounter;
+uint64_t VulkanContext::HashPipelineLibrary(const RenderPipelineState& state, const VkGraphicsPipelineLibraryFlagBitsEXT part)
+{
+    const EOS::RenderPipelineDescription& description = state.Description;
 
-    // skip the 0 value when uint32_t wraps around.
-    if (!SubmitCounter) { ++SubmitCounter; }
+    //Shader modules are part of the hash by their handle, the parts of a shader module are removed from the cache when it is destroyed
+    uint64_t hash = EOS::HashSeed;
+    EOS::HashCombine(hash, part);
+    switch (part)
+    {
+        case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+            EOS::HashCombine(hash, static_cast<uint64_t>(description.PrimitiveTopology));
+            break;
+        case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+            EOS::HashCombine(hash, reinterpret_cast<uint64_t>(state.VertexShader));
+            EOS::HashCombine(hash, static_cast<uint64_t>(description.Polygon) | static_cast<uint64_t>(description.Culling) << 8 | static_cast<uint64_t>(description.FrontFace) << 16);
+            break;
+        case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+            EOS::HashCombine(hash, reinterpret_cast<uint64_t>(state.FragmentShader));
+            EOS::HashCombine(hash, static_cast<uint64_t>(description.DepthFormat) | static_cast<uint64_t>(description.DepthCompareOp) << 8 | static_cast<uint64_t>(description.DepthWriteEnabled) << 16 | static_cast<uint64_t>(description.NumSamples) << 32);
+            break;
+        default:
+            for (const EOS::ColorAttachmentDescription& colorAttachment : description.ColorAttachments)
+            {
+                EOS::HashCombine(hash, static_cast<uint64_t>(colorAttachment.ColorFormat) | static_cast<uint64_t>(colorAttachment.Blending) << 8);
+            }
+            EOS::HashCombine(hash, static_cast<uint64_t>(description.DepthFormat) | static_cast<uint64_t>(description.NumSamples) << 32);
+            break;
+    }
 
-    return LastSubmitHandle;
+    return hash;
 }
 
-EOS::SubmitHandle CommandPool::GetNextSubmitHandle() const
+void VulkanContext::UpdatePipelineCompilations(const bool waitForAll, VkShaderModule waitForShader)
 {
-    return NextSubmitHandle;
+    //A pipeline is done once it can be used, or failed, and its optimized link, when it has one, replaced it
+    const auto isDone = [this, waitForAll, waitForShader](VulkanPipeline& pipeline)
+    {
+        const bool wait = waitForAll || (waitForShader != VK_NULL_HANDLE && pipeline.UsesShader(waitForShader));
+        if (!pipeline.Resolve(wait) && !pipeline.HasFailed) { return false; }
+        if (!pipeline.Optimization.valid()) { return true; }
+        if (!wait && pipeline.Optimization.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return false; }
+
+        //When the optimized link failed the fast link stays in use
+        const VkPipeline optimized = pipeline.Optimization.get();
+        if (optimized == VK_NULL_HANDLE) { return true; }
+
+        Defer(std::packaged_task<void()>([device = VulkanDevice, vkPipeline = pipeline.Pipeline]() { vkDestroyPipeline(device, vkPipeline, nullptr); }));
+        pipeline.Pipeline = optimized;
+        pipeline.HasFailed = false;
+        return true;
+    };
+
+    std::erase_if(CompilingComputePipelines, [this, &isDone](const EOS::ComputePipelineHandle handle) { return isDone(*ComputePipelinePool.Get(handle)); });
+    std::erase_if(CompilingRenderPipelines, [this, &isDone](const EOS::RenderPipelineHandle handle) { return isDone(*RenderPipelinePool.Get(handle)); });
 }
 
-CommandBufferData* CommandPool::AcquireCommandBuffer()
+EOS::Holder<EOS::TextureHandle> VulkanContext::CreateTexture(const EOS::TextureDescription& textureDescription)
 {
-    //Try to free a command buffer of none are free
-    if (!NumberOfAvailableCommandBuffers)
+    const VkImageCreateInfo imageCreateInfo = GetImageCreateInfo(textureDescription);
+    //Host visible textures that can't be linear fell back to optimal tiling, those live in device memory and get staged like any other texture
+    const bool isHostVisible = imageCreateInfo.tiling == VK_IMAGE_TILING_LINEAR;
+    const bool isMemoryless = textureDescription.Storage == EOS::StorageType::Memoryless;
+
+    //VMA sub-allocates from big blocks, resources that the driver prefers to have their own memory (like big render targets) get a dedicated allocation.
+    VmaAllocationCreateInfo allocationCreateInfo
     {
-        TryResetCommandBuffers();
-    }
+        .flags = isHostVisible ? VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT : 0u,
+        .usage = isHostVisible ? VMA_MEMORY_USAGE_AUTO : VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+    };
 
-    // if there is still no commandbuffer free in the pool, we will wait until one becomes available
-    while (!NumberOfAvailableCommandBuffers)
+    //Tiled GPUs keep memoryless attachments in tile memory, lazily allocated memory only gets backed when the render pass can't avoid it
+    if (isMemoryless)
     {
-        EOS::Logger->warn("Waiting for a command buffer that is free to use...");
-        TryResetCommandBuffers();
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED;
     }
 
-    CommandBufferData* currentCommandBuffer = nullptr;
+    VkImage vkImage = VK_NULL_HANDLE;
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    VmaAllocationInfo allocationInfo{};
+    VkResult imageResult = vmaCreateImage(Vma, &imageCreateInfo, &allocationCreateInfo, &vkImage, &allocation, &allocationInfo);
 
-    // we are ok with any available buffer
-    for (CommandBufferData& buffer : Buffers)
+    //Most desktop GPUs don't have lazily allocated memory, the attachment then just lives in device memory
+    if (isMemoryless && imageResult != VK_SUCCESS)
     {
-        if (buffer.VulkanCommandBuffer == VK_NULL_HANDLE)
-        {
-            //TODO: This needs to be a copy, otherwise it will be moved out of the Buffers?
-            currentCommandBuffer = &buffer;
-            break;
-        }
+        allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+        imageResult = vmaCreateImage(Vma, &imageCreateInfo, &allocationCreateInfo, &vkImage, &allocation, &allocationInfo);
     }
-    CHECK(NumberOfAvailableCommandBuffers, "No command buffers where available");
-    CHECK(currentCommandBuffer, "No command buffers where available");
-    CHECK(currentCommandBuffer->VulkanCommandBufferAllocated != VK_NULL_HANDLE, "No command buffers where available");
+    VK_ASSERT(imageResult);
 
-    currentCommandBuffer->Handle.ID = SubmitCounter;
-    NumberOfAvailableCommandBuffers--;
+    vmaSetAllocationName(Vma, allocation, textureDescription.DebugName);
+    const EOS::MemoryCategory category = isMemoryless ? EOS::MemoryCategory::Transient : EOS::MemoryCategory::Texture;
+    Budget->Track(category, allocation);
 
-    currentCommandBuffer->VulkanCommandBuffer = currentCommandBuffer->VulkanCommandBufferAllocated;
-    currentCommandBuffer->isEncoding = true;
+    const EOS::TextureHandle handle = AddTexture(textureDescription, imageCreateInfo, vkImage, allocation, allocationInfo.pMappedData);
+    TexturePool.Get(handle)->Category = category;
 
-    constexpr VkCommandBufferBeginInfo beginInfo =
+    //Lets the defragmentation find the texture of an allocation, mapped textures are never moved since their pointer would change
+    if (!isHostVisible && !isMemoryless)
     {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-    };
-
-    VK_ASSERT(vkBeginCommandBuffer(currentCommandBuffer->VulkanCommandBuffer, &beginInfo));
-
-    NextSubmitHandle = currentCommandBuffer->Handle;
+        vmaSetAllocationUserData(Vma, allocation, reinterpret_cast<void*>(static_cast<uintptr_t>(handle.Index()) + 1));
+    }
 
-    return currentCommandBuffer;
+    return {this, handle};
 }
 
-void CommandPool::TryResetCommandBuffers()
+EOS::Holder<EOS::TextureHandle> VulkanContext::CreateAliasedTexture(const EOS::TextureDescription& textureDescription, const EOS::TransientMemoryHandle memory, const uint64_t offset)
 {
-    for (CommandBufferData& buffer : Buffers)
+    CHECK(textureDescription.Storage == EOS::StorageType::Device, "Only device textures can be placed in transient memory, {} isn't one", textureDescription.DebugName);
+    const VulkanTransientMemory* transientMemory = TransientMemoryPool.Get(memory);
+    CHECK(transientMemory, "Trying to place the texture {} in transient memory that doesn't exist", textureDescription.DebugName);
+    if (!transientMemory)
     {
-        if (buffer.VulkanCommandBuffer == VK_NULL_HANDLE || buffer.isEncoding)
-        {
-            continue;
-        }
+        return {};
+    }
 
-        const VkResult result = vkWaitForFences(Device, 1, &buffer.Fence, VK_TRUE, 0);
+    const VkImageCreateInfo imageCreateInfo = GetImageCreateInfo(textureDescription);
+    const EOS::MemoryRequirements requirements = GetMemoryRequirements(textureDescription);
 
-        if (result == VK_SUCCESS)
-        {
-            VK_ASSERT(vkResetCommandBuffer(buffer.VulkanCommandBuffer, VkCommandBufferResetFlags{0}));
-            VK_ASSERT(vkResetFences(Device, 1, &buffer.Fence));
-            buffer.VulkanCommandBuffer = VK_NULL_HANDLE;
-            ++NumberOfAvailableCommandBuffers;
-        }
-        else if (result != VK_TIMEOUT)
-        {
-            VK_ASSERT(result);
-        }
+    VmaAllocationInfo allocationInfo{};
+    vmaGetAllocationInfo(Vma, transientMemory->Allocation, &allocationInfo);
+    const bool fits = offset % requirements.Alignment == 0 && offset + requirements.Size <= transientMemory->Size && (requirements.MemoryTypeBits & (1u << allocationInfo.memoryType));
+    CHECK(fits, "The texture {} can't be placed at offset {} of the transient memory, it has to be aligned to {}, fit and match the memory type", textureDescription.DebugName, offset, requirements.Alignment);
+    if (!fits)
+    {
+        return {};
     }
-}
 
-CommandBuffer::CommandBuffer(VulkanContext *vulkanContext)
-: CommandBufferImpl((vulkanContext->VulkanCommandPool->AcquireCommandBuffer()))
-, VkContext(vulkanContext)
-{
+    VkImage vkImage = VK_NULL_HANDLE;
+    VK_ASSERT(vmaCreateAliasingImage2(Vma, transientMemory->Allocation, offset, &imageCreateInfo, &vkImage));
+
+    //The image doesn't own its memory, it is tracked once for the whole transient memory
+    const EOS::TextureHandle handle = AddTexture(textureDescription, imageCreateInfo, vkImage, VK_NULL_HANDLE, nullptr);
+    TexturePool.Get(handle)->Category = EOS::MemoryCategory::Transient;
+
+    return {this, handle};
 }
 
-CommandBuffer & CommandBuffer::operator=(CommandBuffer &&other) noexcept
+EOS::MemoryRequirements VulkanContext::GetMemoryRequirements(const EOS::TextureDescription& textureDescription) const
 {
-    if (this != &other)
+    const VkImageCreateInfo imageCreateInfo = GetImageCreateInfo(textureDescription);
+    const VkDeviceImageMemoryRequirements imageMemoryRequirements{ .sType = VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS, .pCreateInfo = &imageCreateInfo };
+    VkMemoryRequirements2 memoryRequirements{ .sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2 };
+    vkGetDeviceImageMemoryRequirements(VulkanDevice, &imageMemoryRequirements, &memoryRequirements);
+
+    return
     {
-        VkContext = std::exchange(other.VkContext, nullptr);
-        CommandBufferImpl = std::exchange(other.CommandBufferImpl, {});
-        LastSubmitHandle = std::exchange(other.LastSubmitHandle, {});
-    }
-    return *this;
+        .Size = memoryRequirements.memoryRequirements.size,
+        .Alignment = memoryRequirements.memoryRequirements.alignment,
+        .MemoryTypeBits = memoryRequirements.memoryRequirements.memoryTypeBits,
+    };
 }
 
-CommandBuffer::operator bool() const
+EOS::Holder<EOS::TransientMemoryHandle> VulkanContext::CreateTransientMemory(const EOS::MemoryRequirements& requirements, const char* debugName)
 {
-    return VkContext != nullptr;
-}
+    CHECK(requirements.Size > 0, "Trying to create the transient memory {} without a size", debugName);
 
-VulkanContext::VulkanContext(const EOS::ContextCreationDescription& contextDescription)
-: Configuration(contextDescription.config)
-{
-    CHECK(volkInitialize() == VK_SUCCESS, "Failed to Initialize VOLK");
+    const VkMemoryRequirements memoryRequirements
+    {
+        .size = requirements.Size,
+        .alignment = requirements.Alignment,
+        .memoryTypeBits = requirements.MemoryTypeBits,
+    };
 
-    CreateVulkanInstance(contextDescription.applicationName);
-    SetupDebugMessenger();
-    CreateSurface(contextDescription.window, contextDescription.display);
+    //Textures get placed in it at any offset, so it always needs its own memory that VMA never hands out to anything else
+    const VmaAllocationCreateInfo allocationCreateInfo
+    {
+        .flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT | VMA_ALLOCATION_CREATE_CAN_ALIAS_BIT,
+        .usage = VMA_MEMORY_USAGE_UNKNOWN,
+        .requiredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+    };
 
-    //Select the Physical Device
-    std::vector<EOS::HardwareDeviceDescription> hardwareDevices;
-    GetHardwareDevice(contextDescription.preferredHardwareType, hardwareDevices);
-    VkContext::SelectHardwareDevice(hardwareDevices, VulkanPhysicalDevice);
+    VmaAllocation allocation = VK_NULL_HANDLE;
+    VK_ASSERT(vmaAllocateMemory(Vma, &memoryRequirements, &allocationCreateInfo, &allocation, nullptr));
+    vmaSetAllocationName(Vma, allocation, debugName);
+    Budget->Track(EOS::MemoryCategory::Transient, allocation);
 
-    //Create our Vulkan Device
-    VkContext::CreateVulkanDevice(VulkanDevice, VulkanPhysicalDevice, VulkanDeviceQueues);
+    return {this, TransientMemoryPool.Create(VulkanTransientMemory{ .Allocation = allocation, .Size = requirements.Size })};
+}
 
-    //Create SwapChain
-    //TODO: will it need a description struct?
-    VulkanSwapChainCreationDescription desc
+VkImageCreateInfo VulkanContext::GetImageCreateInfo(const EOS::TextureDescription& textureDescription) const
+{
+    const VkFormat format = VulkanImage::ToVkFormat(textureDescription.TextureFormat);
+    CHECK(format != VK_FORMAT_UNDEFINED, "Trying to create the texture {} without a format", textureDescription.DebugName);
+    CHECK(textureDescription.Type != EOS::ImageType::SwapChain, "SwapChain textures can only be created by the SwapChain");
+    CHECK(textureDescription.NumMipLevels <= VulkanImage::MaxMipLevels || !(textureDescription.Usage & EOS::TextureUsageFlags::Attachment), "Attachments can have at most {} mip levels", VulkanImage::MaxMipLevels);
+
+    const bool isDepth = VulkanImage::IsDepthFormat(format);
+    const bool isCubeMap = textureDescription.Type == EOS::ImageType::CubeMap || textureDescription.Type == EOS::ImageType::CubeMap_Array;
+    const bool isHostVisible = textureDescription.Storage == EOS::StorageType::HostVisible;
+    const bool isMemoryless = textureDescription.Storage == EOS::StorageType::Memoryless;
+    const uint32_t numLayers = isCubeMap ? textureDescription.NumLayers * 6 : textureDescription.NumLayers;
+
+    //The content of a memoryless attachment never leaves the render pass, so it can't be copied, sampled or stored to
+    CHECK(!isMemoryless || textureDescription.Usage == EOS::TextureUsageFlags::Attachment, "The memoryless texture {} can only be used as an attachment", textureDescription.DebugName);
+
+    VkImageUsageFlags usageFlags = isMemoryless ? VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (textureDescription.Usage & EOS::TextureUsageFlags::Sampled)     { usageFlags |= VK_IMAGE_USAGE_SAMPLED_BIT; }
+    if (textureDescription.Usage & EOS::TextureUsageFlags::Storage)     { usageFlags |= VK_IMAGE_USAGE_STORAGE_BIT; }
+    if (textureDescription.Usage & EOS::TextureUsageFlags::Attachment)  { usageFlags |= isDepth ? VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT : VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT; }
+
+    VkImageCreateInfo imageCreateInfo
     {
-        .vulkanContext = this,
-        .width = 100,
-        .height = 80,
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .flags = isCubeMap ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0u,
+        .imageType = VulkanImage::ToImageType(textureDescription.Type),
+        .format = format,
+        .extent = { .width = textureDescription.Width, .height = textureDescription.Height, .depth = textureDescription.Depth },
+        .mipLevels = textureDescription.NumMipLevels,
+        .arrayLayers = numLayers,
+        .samples = static_cast<VkSampleCountFlagBits>(textureDescription.NumSamples),
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usageFlags,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
     };
 
-    SwapChain = std::make_unique<VulkanSwapChain>(desc);
-
+    //Only the host can read and write a mapped image, which needs linear tiling
+    if (isHostVisible)
+    {
+        if (CanUseLinearTiling(imageCreateInfo))
+        {
+            imageCreateInfo.tiling = VK_IMAGE_TILING_LINEAR;
+        }
+        else
+        {
+            EOS::Logger->warn("The host visible texture {} doesn't support linear tiling, it uses optimal tiling and staging uploads instead", textureDescription.DebugName);
+        }
+    }
 
-    //Create our Timeline Semaphore
-    TimelineSemaphore = VkSynchronization::CreateSemaphoreTimeline(VulkanDevice, SwapChain->GetNumSwapChainImages() - 1, "Semaphore: TimelineSemaphore");
+    //Sampled textures can be uploaded by the host directly, as long as that doesn't make them slower to access on the device
+    if (Capabilities.HostImageCopy && imageCreateInfo.tiling == VK_IMAGE_TILING_OPTIMAL && !isDepth && (usageFlags & VK_IMAGE_USAGE_SAMPLED_BIT) && CanUseHostImageCopy(imageCreateInfo))
+    {
+        imageCreateInfo.usage |= VK_IMAGE_USAGE_HOST_TRANSFER_BIT;
+    }
 
-    //Create our CommandPool
-    VulkanCommandPool = std::make_unique<CommandPool>(VulkanDevice, VulkanDeviceQueues.Graphics.QueueFamilyIndex);
+    return imageCreateInfo;
+}
 
+EOS::TextureHandle VulkanContext::AddTexture(const EOS::TextureDescription& textureDescription, const VkImageCreateInfo& imageCreateInfo, VkImage vkImage, VmaAllocation allocation, void* mappedPtr)
+{
+    VulkanImage image
+    {
+        ImageDescription
+        {
+            .Image = vkImage,
+            .UsageFlags = imageCreateInfo.usage,
+            .Extent = imageCreateInfo.extent,
+            .ImageType = textureDescription.Type,
+            .ImageFormat = imageCreateInfo.format,
+            .Levels = imageCreateInfo.mipLevels,
+            .Layers = imageCreateInfo.arrayLayers,
+            .DebugName = textureDescription.DebugName,
+            .Device = VulkanDevice,
+        }
+    };
+    image.Allocation = allocation;
+    image.MappedPtr = mappedPtr;
+    image.Samples = imageCreateInfo.samples;
 
-    //TODO: pipeline cache
+    const EOS::TextureHandle handle = TexturePool.Create(std::move(image));
+    Bindless->SetTexture(handle.Index(), *TexturePool.Get(handle));
 
-    //TODO: VMA init
+    return handle;
+}
 
-    //TODO: Staging Device
+EOS::Holder<EOS::BufferHandle> VulkanContext::CreateBuffer(const EOS::BufferDescription& bufferDescription)
+{
+    return CreateBuffer(bufferDescription, EOS::MemoryCategory::Buffer);
 }
 
-VulkanContext::~VulkanContext()
+EOS::Holder<EOS::BufferHandle> VulkanContext::CreateBuffer(const EOS::BufferDescription& bufferDescription, const EOS::MemoryCategory category)
 {
-    //Wait unit all work has been done
-    VK_ASSERT(vkDeviceWaitIdle(VulkanDevice));
+    CHECK(bufferDescription.Size > 0, "Trying to create the buffer {} without a size", bufferDescription.DebugName);
 
-    SwapChain.reset(nullptr);
+    //Every buffer can be reached through its device address, and can be the source or destination of copies
+    VkBufferUsageFlags usageFlags = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    if (bufferDescription.Usage & EOS::BufferUsageFlags::Index)          { usageFlags |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT; }
+    if (bufferDescription.Usage & EOS::BufferUsageFlags::Vertex)         { usageFlags |= VK_BUFFER_USAGE_VERTEX_BUFFER_BIT; }
+    if (bufferDescription.Usage & EOS::BufferUsageFlags::Uniform)        { usageFlags |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT; }
+    if (bufferDescription.Usage & EOS::BufferUsageFlags::StorageBuffer)  { usageFlags |= VK_BUFFER_USAGE_STORAGE_BUFFER_BIT; }
+    if (bufferDescription.Usage & EOS::BufferUsageFlags::Indirect)       { usageFlags |= VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT; }
 
-    vkDestroySemaphore(VulkanDevice, TimelineSemaphore, nullptr);
+    const VkBufferCreateInfo bufferCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = bufferDescription.Size,
+        .usage = usageFlags,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+    };
 
-    if (TexturePool.NumObjects())
+    const bool isHostVisible = bufferDescription.Storage == EOS::StorageType::HostVisible;
+    VmaAllocationCreateInfo allocationCreateInfo
     {
-        EOS::Logger->error("{} Leaked textures", TexturePool.NumObjects());
-    }
-    TexturePool.Clear();
+        .flags = isHostVisible ? VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT : 0u,
+        .usage = isHostVisible ? VMA_MEMORY_USAGE_AUTO : VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE,
+    };
 
-    if (ShaderModulePool.NumObjects())
+    //Device buffers get mapped when their device local memory is host visible, uploads then skip the staging copy.
+    //VMA can still fall back to memory that is not host visible, in that case the buffer simply is not mapped.
+    if (!isHostVisible && Uploads == UploadStrategy::Direct)
     {
-        EOS::Logger->error("{} Leaked Shader Modules", ShaderModulePool.NumObjects());
+        allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
     }
-    ShaderModulePool.Clear();
 
-    WaitOnDeferredTasks();
+    VulkanBuffer buffer
+    {
+        .Size = bufferDescription.Size,
+        .UsageFlags = usageFlags,
+        .Category = category,
+    };
 
-    VulkanCommandPool.reset(nullptr);
+    VmaAllocationInfo allocationInfo{};
+    VK_ASSERT(vmaCreateBuffer(Vma, &bufferCreateInfo, &allocationCreateInfo, &buffer.Buffer, &buffer.Allocation, &allocationInfo));
+    vmaSetAllocationName(Vma, buffer.Allocation, bufferDescription.DebugName);
+    Budget->Track(category, buffer.Allocation);
+    vmaGetAllocationMemoryProperties(Vma, buffer.Allocation, &buffer.MemoryFlags);
+    VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_BUFFER, reinterpret_cast<uint64_t>(buffer.Buffer), bufferDescription.DebugName));
 
-    vkDestroySurfaceKHR(VulkanInstance, VulkanSurface, nullptr);
+    buffer.MappedPtr = allocationInfo.pMappedData;
 
-    //vmaDestroyAllocator(Vma);
+    const VkBufferDeviceAddressInfo addressInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+        .buffer = buffer.Buffer,
+    };
+    buffer.DeviceAddress = vkGetBufferDeviceAddress(VulkanDevice, &addressInfo);
 
-    vkDestroyDevice(VulkanDevice, nullptr);
-    vkDestroyDebugUtilsMessengerEXT(VulkanInstance, VulkanDebugMessenger, nullptr);
-    vkDestroyInstance(VulkanInstance, nullptr);
+    EOS::Holder<EOS::BufferHandle> handle{this, BufferPool.Create(std::move(buffer))};
+    Bindless->SetBuffer(handle.Index(), *BufferPool.Get(handle));
+    if (bufferDescription.Data)
+    {
+        Upload(handle, bufferDescription.Data, bufferDescription.Size);
+    }
+
+    return handle;
 }
 
-EOS::ICommandBuffer& VulkanContext::AcquireCommandBuffer()
+uint8_t* VulkanContext::GetMappedPtr(const EOS::BufferHandle handle) const
 {
-    CHECK(!CurrentCommandBuffer, "Another CommandBuffer has been acquired this frame");
-    CurrentCommandBuffer = std::move(CommandBuffer{this});
-    return CurrentCommandBuffer;
+    const VulkanBuffer* buffer = BufferPool.Get(handle);
+    CHECK(buffer, "Trying to get the mapped pointer of a buffer that does not exist");
+    return buffer ? static_cast<uint8_t*>(buffer->MappedPtr) : nullptr;
 }
 
-EOS::SubmitHandle VulkanContext::Submit(EOS::ICommandBuffer &commandBuffer, EOS::TextureHandle present)
+uint64_t VulkanContext::GetGPUAddress(const EOS::BufferHandle handle) const
 {
-    CommandBuffer* vkCmdBuffer = dynamic_cast<CommandBuffer*>(&commandBuffer);
-    CHECK(vkCmdBuffer, "The command buffer is not valid");
+    const VulkanBuffer* buffer = BufferPool.Get(handle);
+    CHECK(buffer, "Trying to get the GPU address of a buffer that does not exist");
+    return buffer ? buffer->DeviceAddress : 0;
+}
 
-#if defined(EOS_DEBUG)
-    if (present)
+void VulkanContext::FlushMappedMemory(const EOS::BufferHandle handle, const size_t offset, const size_t size) const
+{
+    const VulkanBuffer* buffer = BufferPool.Get(handle);
+    CHECK_RETURN(buffer, "Trying to flush a buffer that does not exist");
+    CHECK_RETURN(buffer->IsMapped(), "Trying to flush a buffer that is not mapped");
+
+    if (buffer->IsCoherent()) { return; }
+    VK_ASSERT(vmaFlushAllocation(Vma, buffer->Allocation, offset, size));
+}
+
+EOS::UploadAllocation VulkanContext::AllocateUpload(const uint64_t size, const uint64_t alignment)
+{
+    EOS::UploadAllocation allocation = FrameUploadRing->Allocate(size, alignment);
+    if (!allocation.Valid())
     {
-        const VulkanImage& swapChainTextures = *TexturePool.Get(present);
-        CHECK(VulkanImage::IsSwapChainImage(swapChainTextures), "The passed present texture handle is not from a SwapChain");
+        EOS::Logger->error("The upload ring is out of memory for this frame, {} bytes were requested", size);
     }
-#endif
+    return allocation;
+}
 
-    const bool shouldPresent = HasSwapChain() && present;
+void VulkanContext::Upload(const EOS::BufferHandle handle, const void* data, const size_t size, const size_t offset)
+{
+    const VulkanBuffer* buffer = BufferPool.Get(handle);
+    CHECK_RETURN(buffer, "Trying to upload to a buffer that does not exist");
+    CHECK_RETURN(data && size > 0, "Trying to upload nothing to a buffer");
+    CHECK_RETURN(offset + size <= buffer->Size, "The upload of {} bytes at offset {} does not fit in the buffer", size, offset);
 
-    //If we a presenting a SwapChain image, signal our timeline semaphore
-    if (shouldPresent)
+    //The memory is host visible, so we can write to it directly
+    if (buffer->IsMapped())
     {
-        //Create a unique Signal Value
-        const uint64_t signalValue = SwapChain->CurrentFrame + SwapChain->NumberOfSwapChainImages;
-
-        //Wait for this value next time we want to acquire this SwapChain image
-        SwapChain->TimelineWaitValues[SwapChain->CurrentImageIndex] = signalValue;
-        VulkanCommandPool->Signal(TimelineSemaphore, signalValue);
+        memcpy(static_cast<uint8_t*>(buffer->MappedPtr) + offset, data, size);
+        if (!buffer->IsCoherent())
+        {
+            VK_ASSERT(vmaFlushAllocation(Vma, buffer->Allocation, offset, size));
+        }
+        return;
     }
 
-    vkCmdBuffer->LastSubmitHandle = VulkanCommandPool->Submit(*vkCmdBuffer->CommandBufferImpl);
+    const VkBuffer dstBuffer = buffer->Buffer;
+    SubmitStagingCopy(data, size, 16, [dstBuffer, size, offset](const CommandBuffer& commandBuffer, const VkBuffer stagingBuffer, const uint64_t stagingOffset)
+    {
+        const VkBufferCopy copy
+        {
+            .srcOffset = stagingOffset,
+            .dstOffset = offset,
+            .size = size,
+        };
+        vkCmdCopyBuffer(commandBuffer.CommandBufferImpl->VulkanCommandBuffer, stagingBuffer, dstBuffer, 1, &copy);
+    });
+}
 
-    if (shouldPresent)
+void VulkanContext::Upload(const EOS::TextureHandle handle, const void* data, const uint32_t mipLevel, const uint32_t arrayLayer)
+{
+    const VulkanImage* image = TexturePool.Get(handle);
+    CHECK_RETURN(image, "Trying to upload to a texture that does not exist");
+    CHECK_RETURN(data, "Trying to upload nothing to a texture");
+    CHECK_RETURN(mipLevel < image->Levels && arrayLayer < image->Layers, "The mip level {} or layer {} is not part of the texture", mipLevel, arrayLayer);
+    CHECK_RETURN(!VulkanImage::IsDepthFormat(image->ImageFormat), "Uploading to depth textures is not supported");
+
+    const uint32_t bytesPerTexel = VulkanImage::GetBytesPerTexel(image->ImageFormat);
+    CHECK_RETURN(bytesPerTexel, "Uploading to textures of this format is not supported");
+
+    const VkExtent3D extent = image->GetMipExtent(mipLevel);
+
+    //The CPU copies the texels into the texture itself, no staging memory or submit is needed
+    if (PrepareHostImageCopy(handle, mipLevel, arrayLayer))
     {
-        SwapChain->Present(VulkanCommandPool->AcquireLastSubmitSemaphore());
+        CopyMemoryToImage(image->Image, data, extent, mipLevel, arrayLayer);
+        return;
     }
 
-    ProcessDeferredTasks();
+    const uint64_t size = static_cast<uint64_t>(extent.width) * extent.height * extent.depth * bytesPerTexel;
+
+    const VkImage vkImage = image->Image;
+    const bool isSampled = VulkanImage::IsSampledImage(*image);
+    SubmitStagingCopy(data, size, 16, [handle, vkImage, isSampled, extent, mipLevel, arrayLayer](CommandBuffer& commandBuffer, const VkBuffer stagingBuffer, const uint64_t stagingOffset)
+    {
+        const EOS::SubresourceRange range{ .BaseMipLevel = mipLevel, .NumMipLevels = 1, .BaseArrayLayer = arrayLayer, .NumArrayLayers = 1 };
+        cmdTransition(commandBuffer, handle, EOS::ResourceState::CopyDest, range);
+        commandBuffer.FlushBarriers();
+
+        const VkBufferImageCopy copy
+        {
+            .bufferOffset = stagingOffset,
+            .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, arrayLayer, 1},
+            .imageExtent = extent,
+        };
+        vkCmdCopyBufferToImage(commandBuffer.CommandBufferImpl->VulkanCommandBuffer, stagingBuffer, vkImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+
+        if (isSampled)
+        {
+            cmdTransition(commandBuffer, handle, EOS::ResourceState::ShaderResource, range);
+        }
+    });
+}
 
-    const EOS::SubmitHandle handle = vkCmdBuffer->LastSubmitHandle;
+EOS::MemoryStatistics VulkanContext::GetMemoryStatistics() const
+{
+    return Budget->GetStatistics();
+}
 
-    //Reset the Command Buffer
-    CurrentCommandBuffer = {};
+uint32_t VulkanContext::AddEvictionCallback(EOS::EvictionCallback callback)
+{
+    return Budget->AddEvictionCallback(std::move(callback));
+}
 
-    return handle;
+void VulkanContext::RemoveEvictionCallback(const uint32_t id)
+{
+    Budget->RemoveEvictionCallback(id);
 }
 
-EOS::TextureHandle VulkanContext::GetSwapChainTexture()
+void VulkanContext::Destroy(EOS::BufferHandle handle)
 {
-    CHECK(HasSwapChain(), "You dont have a SwapChain");
-    if (!HasSwapChain())
+    const VulkanBuffer* buffer = BufferPool.Get(handle);
+    CHECK(buffer, "Trying to destroy a already destroyed vulkan buffer");
+    if (!buffer)
     {
-       EOS::Logger->error("No SwapChain Found");
+        return;
     }
 
-    EOS::TextureHandle swapChainTexture = SwapChain->GetCurrentTexture();
-    CHECK(swapChainTexture.Valid(), "The SwapChain texture is not valid.");
-    CHECK(TexturePool.Get(swapChainTexture)->ImageFormat != VK_FORMAT_UNDEFINED, "Invalid image format");
+    const MemoryBudgetTracker::PendingRelease release = Budget->Untrack(buffer->Category, buffer->Allocation);
 
-    return swapChainTexture;
+    //The slot can only point at nothing once the GPU is done with it
+    Defer(std::packaged_task<void()>([bindless = Bindless.get(), index = handle.Index(), vkBuffer = buffer->Buffer]() { bindless->ClearBuffer(index, vkBuffer); }));
+
+    //The mapped memory gets unmapped by VMA when the buffer is destroyed
+    Defer(std::packaged_task<void()>([vma = Vma, budget = Budget.get(), vkBuffer = buffer->Buffer, allocation = buffer->Allocation, release]()
+    {
+        vmaDestroyBuffer(vma, vkBuffer, allocation);
+        budget->Release(release);
+    }));
+
+    DeferRelease(BufferPool, handle);
 }
 
-EOS::Holder<EOS::ShaderModuleHandle> VulkanContext::CreateShaderModule(const EOS::ShaderInfo &shaderInfo)
+void VulkanContext::Destroy(EOS::TransientMemoryHandle handle)
 {
-    VkShaderModule vkShaderModule = VK_NULL_HANDLE;
-
-    const VkShaderModuleCreateInfo createInfo =
+    const VulkanTransientMemory* transientMemory = TransientMemoryPool.Get(handle);
+    CHECK(transientMemory, "Trying to destroy already destroyed transient memory");
+    if (!transientMemory)
     {
-        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-        .codeSize = shaderInfo.spirv.size() * sizeof(uint32_t),
-        .pCode = shaderInfo.spirv.data(),
-    };
-
-    VK_ASSERT(vkCreateShaderModule(VulkanDevice, &createInfo, nullptr, &vkShaderModule);)
-    CHECK(vkShaderModule != VK_NULL_HANDLE, "Failed to create shader module from ShaderInfo");
+        return;
+    }
 
-    VK_ASSERT(VkDebug::SetDebugObjectName(VulkanDevice, VK_OBJECT_TYPE_SHADER_MODULE, reinterpret_cast<uint64_t>(vkShaderModule), shaderInfo.debugName));
+    const MemoryBudgetTracker::PendingRelease release = Budget->Untrack(EOS::MemoryCategory::Transient, transientMemory->Allocation);
 
-    VulkanShaderModuleState state
+    //The textures that were placed in it are deferred as well, so they are all destroyed before the memory is freed
+    Defer(std::packaged_task<void()>([vma = Vma, budget = Budget.get(), allocation = transientMemory->Allocation, release]()
     {
-        .ShaderModule = vkShaderModule,
-        .PushConstantsSize = shaderInfo.pushConstantSize
-    };
+        vmaFreeMemory(vma, allocation);
+        budget->Release(release);
+    }));
 
-    return {this, ShaderModulePool.Create(std::move(state))};
+    TransientMemoryPool.Destroy(handle);
 }
 
 void VulkanContext::Destroy(EOS::TextureHandle handle)
@@ -905,6 +3770,8 @@ void VulkanContext::Destroy(EOS::TextureHandle handle)
         return;
     }
 
+    //The slots can only point at nothing once the GPU is done with them, the views are destroyed after that
+    Defer(std::packaged_task<void()>([bindless = Bindless.get(), index = handle.Index(), imageView = image->ImageView]() { bindless->ClearTexture(index, imageView); }));
     Defer(std::packaged_task<void()>([device = VulkanDevice, imageView = image->ImageView]() { vkDestroyImageView(device, imageView, nullptr); }));
 
     if (image->ImageViewStorage)
@@ -926,37 +3793,90 @@ void VulkanContext::Destroy(EOS::TextureHandle handle)
 
     if (!image->IsOwningImage)
     {
-        TexturePool.Destroy(handle);
+        DeferRelease(TexturePool, handle);
+        return;
+    }
+
+    //An aliased texture doesn't own its memory, it gets freed together with the transient memory it was placed in
+    if (image->Allocation == VK_NULL_HANDLE)
+    {
+        Defer(std::packaged_task<void()>([device = VulkanDevice, image = image->Image]() { vkDestroyImage(device, image, nullptr); }));
+        DeferRelease(TexturePool, handle);
+        return;
+    }
+
+    const MemoryBudgetTracker::PendingRelease release = Budget->Untrack(image->Category, image->Allocation);
+
+    //A texture that is being moved is freed by VMA when the pass ends, its new image is used by this frame so it has to outlive it
+    if (Defragmentation.IsPassActive)
+    {
+        const std::span<VmaDefragmentationMove> moves{Defragmentation.Pass.pMoves, Defragmentation.Pass.moveCount};
+        const auto move = std::ranges::find_if(moves, [allocation = image->Allocation](const VmaDefragmentationMove& m) { return m.srcAllocation == allocation && m.operation == VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY; });
+        if (move != moves.end())
+        {
+            move->operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+            Defragmentation.OldImages.emplace_back(image->Image);
+            Defragmentation.WaitHandle = VulkanCommandPool->GetNextSubmitHandle();
+            Defer(std::packaged_task<void()>([budget = Budget.get(), release]() { budget->Release(release); }), Defragmentation.WaitHandle);
+            DeferRelease(TexturePool, handle);
+            return;
+        }
+    }
+
+    //Persistently mapped memory gets unmapped by VMA when the image is destroyed, the GPU might still use it so we wait until it is done.
+    Defer(std::packaged_task<void()>([vma = Vma, budget = Budget.get(), image = image->Image, allocation = image->Allocation, release]()
+    {
+        vmaDestroyImage(vma, image, allocation);
+        budget->Release(release);
+    }));
+
+    DeferRelease(TexturePool, handle);
+}
+
+void VulkanContext::Destroy(EOS::SamplerHandle handle)
+{
+    VulkanSampler* sampler = SamplerPool.Get(handle);
+    CHECK(sampler, "Trying to destroy a already destroyed sampler");
+    if (!sampler || --sampler->NumReferences > 0)
+    {
         return;
     }
 
-    //TODO: Add once VMA is setup and image has allocations on the GPU
-    //if (image->MappedPtr)
-    //{
-    //    vmaUnmapMemory(static_cast<VmaAllocator>(GetVmaAllocator()), image->Allocation);
-    //}
+    SamplerCache.erase(sampler->Description);
+
+    //The slot falls back to the default sampler once the GPU is done with it, after that the sampler can go
+    Defer(std::packaged_task<void()>([bindless = Bindless.get(), index = handle.Index(), vkSampler = sampler->Sampler]() { bindless->ClearSampler(index, vkSampler); }));
+    Defer(std::packaged_task<void()>([device = VulkanDevice, vkSampler = sampler->Sampler]() { vkDestroySampler(device, vkSampler, nullptr); }));
+
+    DeferRelease(SamplerPool, handle);
+}
+
+void VulkanContext::Destroy(EOS::ComputePipelineHandle handle)
+{
+    VulkanPipeline* pipeline = ComputePipelinePool.Get(handle);
+    if (!pipeline) { return; }
+
+    std::erase(CompilingComputePipelines, handle);
+    pipeline->Resolve(true);
+    Defer(std::packaged_task<void()>([device = VulkanDevice, vkPipeline = pipeline->Pipeline]() { vkDestroyPipeline(device, vkPipeline, nullptr); }));
 
-    //Defer(std::packaged_task<void()>([vma = GetVmaAllocator(), image = image->Image, allocation = image->VmaAllocation]() {vmaDestroyImage(static_cast<VmaAllocator>(vma), image, allocation);}));
-    //Defer(std::packaged_task<void()>([device = VulkanDevice, image = image->Image, memory0 = image->VkMemory[0], memory1 = image->VkMemory[1], memory2 = image->VkMemory[2]]()
-    //{
-    //    vkDestroyImage(device, image, nullptr);
-    //    if (memory0 != VK_NULL_HANDLE)
-    //    {
-    //        vkFreeMemory(device, memory0, nullptr);
-    //    }
+    ComputePipelinePool.Destroy(handle);
+}
 
-    //    if (memory1 != VK_NULL_HANDLE)
-    //    {
-    //        vkFreeMemory(device, memory1, nullptr);
-    //    }
+void VulkanContext::Destroy(EOS::RenderPipelineHandle handle)
+{
+    VulkanPipeline* pipeline = RenderPipelinePool.Get(handle);
+    if (!pipeline) { return; }
 
-    //    if (memory2 != VK_NULL_HANDLE)
-    //    {
-    //        vkFreeMemory(device, memory2, nullptr);
-    //    }
-    //}));
+    std::erase(CompilingRenderPipelines, handle);
+    pipeline->Resolve(true);
+    Defer(std::packaged_task<void()>([device = VulkanDevice, vkPipeline = pipeline->Pipeline]() { vkDestroyPipeline(device, vkPipeline, nullptr); }));
+    if (pipeline->Optimization.valid())
+    {
+        Defer(std::packaged_task<void()>([device = VulkanDevice, vkPipeline = pipeline->Optimization.get()]() { vkDestroyPipeline(device, vkPipeline, nullptr); }));
+    }
 
-    TexturePool.Destroy(handle);
+    RenderPipelinePool.Destroy(handle);
 }
 
 void VulkanContext::Destroy(EOS::ShaderModuleHandle handle)
@@ -965,11 +3885,31 @@ void VulkanContext::Destroy(EOS::ShaderModuleHandle handle)
 
     if (!state) { return; }
 
+    //Pipelines that are still compiling might use the shader module, only those have to be waited on
+    UpdatePipelineCompilations(false, state->ShaderModule);
+
+    //Linked pipelines don't need their parts anymore, so the parts that were compiled with the shader can go right away
+    {
+        std::scoped_lock lock(PipelineLibrariesMutex);
+        std::erase_if(PipelineLibraries, [device = VulkanDevice, shader = state->ShaderModule](const auto& entry)
+        {
+            if (entry.second.Shader != shader) { return false; }
+            vkDestroyPipeline(device, entry.second.Library, nullptr);
+            return true;
+        });
+    }
+
     if (state->ShaderModule != VK_NULL_HANDLE)
     {
         vkDestroyShaderModule(VulkanDevice, state->ShaderModule, nullptr);
     }
 
+    //Unlike the shader module, the shader object is used by the commandbuffers it was bound in
+    if (state->ShaderObject != VK_NULL_HANDLE)
+    {
+        Defer(std::packaged_task<void()>([device = VulkanDevice, shaderObject = state->ShaderObject]() { vkDestroyShaderEXT(device, shaderObject, nullptr); }));
+    }
+
     ShaderModulePool.Destroy(handle);
 }
 
@@ -996,6 +3936,22 @@ void VulkanContext::Defer(std::packaged_task<void()>&& task, EOS::SubmitHandle h
     DeferredTasks.emplace_back(std::move(task), handle);
 }
 
+VkEvent VulkanContext::AcquireEvent()
+{
+    if (FreeEvents.empty())
+    {
+        return VkSynchronization::CreateDeviceEvent(VulkanDevice, "Event: SplitBarrier");
+    }
+
+    const VkEvent event = FreeEvents.back();
+    FreeEvents.pop_back();
+    return event;
+}
+
+void VulkanContext::ReleaseEvent(VkEvent event)
+{
+    Defer(std::packaged_task<void()>([this, event]() { FreeEvents.push_back(event); }));
+}
 
 bool VulkanContext::HasSwapChain() const noexcept
 {
@@ -1150,6 +4106,35 @@ void VulkanContext::CreateVulkanInstance(const char* applicationName)
     volkLoadInstance(VulkanInstance);
 }
 
+void VulkanContext::CreateAllocator()
+{
+    //VMA loads the rest of the functions it needs through these
+    const VmaVulkanFunctions vulkanFunctions
+    {
+        .vkGetInstanceProcAddr = vkGetInstanceProcAddr,
+        .vkGetDeviceProcAddr = vkGetDeviceProcAddr,
+    };
+
+    //Dedicated allocations are core since 1.1, so VMA uses them without a flag when the driver prefers or requires them.
+    VmaAllocatorCreateFlags flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT;
+    if (Capabilities.MemoryBudget)
+    {
+        flags |= VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT;
+    }
+
+    const VmaAllocatorCreateInfo createInfo
+    {
+        .flags = flags,
+        .physicalDevice = VulkanPhysicalDevice,
+        .device = VulkanDevice,
+        .pVulkanFunctions = &vulkanFunctions,
+        .instance = VulkanInstance,
+        .vulkanApiVersion = VK_API_VERSION_1_3,
+    };
+
+    VK_ASSERT(vmaCreateAllocator(&createInfo, &Vma));
+}
+
 void VulkanContext::SetupDebugMessenger()
 {
    const VkDebugUtilsMessengerCreateInfoEXT debugUtilMessengerCreateInfo =
@@ -1228,6 +4213,390 @@ void VulkanContext::WaitOnDeferredTasks()
     DeferredTasks.clear();
 }
 
+std::future<void> VulkanContext::UploadAsync(const EOS::TextureHandle handle, const void* data, const uint32_t mipLevel, const uint32_t arrayLayer)
+{
+    //Without host image copy the upload needs a submit, which can only be done from this thread
+    if (!data || !PrepareHostImageCopy(handle, mipLevel, arrayLayer))
+    {
+        Upload(handle, data, mipLevel, arrayLayer);
+        std::promise<void> uploaded;
+        uploaded.set_value();
+        return uploaded.get_future();
+    }
+
+    if (!UploadWorkers)
+    {
+        UploadWorkers = std::make_unique<EOS::ThreadPool>();
+    }
+
+    const VulkanImage* image = TexturePool.Get(handle);
+    return UploadWorkers->Enqueue([this, vkImage = image->Image, data, extent = image->GetMipExtent(mipLevel), mipLevel, arrayLayer]()
+    {
+        CopyMemoryToImage(vkImage, data, extent, mipLevel, arrayLayer);
+    });
+}
+
+bool VulkanContext::CanUseLinearTiling(const VkImageCreateInfo& imageCreateInfo) const
+{
+    //Linear tiling is only guaranteed for single sampled 2D color images with 1 mip and 1 layer, anything else is up to the device
+    const bool isSimpleImage = imageCreateInfo.imageType == VK_IMAGE_TYPE_2D && imageCreateInfo.mipLevels == 1 && imageCreateInfo.arrayLayers == 1 &&
+                               imageCreateInfo.samples == VK_SAMPLE_COUNT_1_BIT && !VulkanImage::IsDepthFormat(imageCreateInfo.format);
+    if (!isSimpleImage)
+    {
+        return false;
+    }
+
+    VkImageFormatProperties formatProperties{};
+    if (vkGetPhysicalDeviceImageFormatProperties(VulkanPhysicalDevice, imageCreateInfo.format, imageCreateInfo.imageType, VK_IMAGE_TILING_LINEAR, imageCreateInfo.usage, imageCreateInfo.flags, &formatProperties) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    return imageCreateInfo.extent.width <= formatProperties.maxExtent.width && imageCreateInfo.extent.height <= formatProperties.maxExtent.height;
+}
+
+bool VulkanContext::CanUseHostImageCopy(const VkImageCreateInfo& imageCreateInfo) const
+{
+    const VkPhysicalDeviceImageFormatInfo2 formatInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+        .format = imageCreateInfo.format,
+        .type = imageCreateInfo.imageType,
+        .tiling = imageCreateInfo.tiling,
+        .usage = imageCreateInfo.usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT,
+        .flags = imageCreateInfo.flags,
+    };
+
+    VkHostImageCopyDevicePerformanceQuery performanceQuery{ .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY };
+    VkImageFormatProperties2 formatProperties{ .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2, .pNext = &performanceQuery };
+
+    //Fails when the host can't copy into textures of this format
+    if (vkGetPhysicalDeviceImageFormatProperties2(VulkanPhysicalDevice, &formatInfo, &formatProperties) != VK_SUCCESS)
+    {
+        return false;
+    }
+
+    //Some devices lose compression on textures the host can copy into, those keep using the staging upload
+    return performanceQuery.optimalDeviceAccess == VK_TRUE;
+}
+
+bool VulkanContext::PrepareHostImageCopy(const EOS::TextureHandle handle, const uint32_t mipLevel, const uint32_t arrayLayer)
+{
+    VulkanImage* image = TexturePool.Get(handle);
+    if (!image || !(image->UsageFlags & VK_IMAGE_USAGE_HOST_TRANSFER_BIT)) { return false; }
+    if (mipLevel >= image->Levels || arrayLayer >= image->Layers) { return false; }
+
+    //The host copy doesn't wait on the GPU, so only subresources that no submit has used yet can take it.
+    //A subresource that was uploaded before might still be sampled by the frames in flight, it gets the staged upload which is ordered after them.
+    if (image->GetState(mipLevel, arrayLayer) != EOS::ResourceState::Undefined)
+    {
+        return false;
+    }
+
+    const EOS::SubresourceRange range{ .BaseMipLevel = mipLevel, .NumMipLevels = 1, .BaseArrayLayer = arrayLayer, .NumArrayLayers = 1 };
+    const VkHostImageLayoutTransitionInfo transitionInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO,
+        .image = image->Image,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = Capabilities.HostImageCopyLayout,
+        .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, 1, arrayLayer, 1},
+    };
+
+    //Host image copy is core in 1.4, before that it comes from VK_EXT_host_image_copy
+    const PFN_vkTransitionImageLayout transitionImageLayout = vkTransitionImageLayout ? vkTransitionImageLayout : vkTransitionImageLayoutEXT;
+    VK_ASSERT(transitionImageLayout(VulkanDevice, 1, &transitionInfo));
+
+    const bool isShaderReadOnly = Capabilities.HostImageCopyLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    image->SetState(range, isShaderReadOnly ? EOS::ResourceState::ShaderResource : EOS::ResourceState::Common);
+
+    return true;
+}
+
+//Only touches immutable state of the context, so it can be called from the upload workers
+void VulkanContext::CopyMemoryToImage(const VkImage image, const void* data, const VkExtent3D extent, const uint32_t mipLevel, const uint32_t arrayLayer) const
+{
+    const VkMemoryToImageCopy region
+    {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY,
+        .pHostPointer = data,
+        .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, mipLevel, arrayLayer, 1},
+        .imageExtent = extent,
+    };
+
+    const VkCopyMemoryToImageInfo copyInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO,
+        .dstImage = image,
+        .dstImageLayout = Capabilities.HostImageCopyLayout,
+        .regionCount = 1,
+        .pRegions = &region,
+    };
+
+    const PFN_vkCopyMemoryToImage copyMemoryToImage = vkCopyMemoryToImage ? vkCopyMemoryToImage : vkCopyMemoryToImageEXT;
+    VK_ASSERT(copyMemoryToImage(VulkanDevice, &copyInfo));
+}
+
+void VulkanContext::SubmitStagingCopy(const void* data, const uint64_t size, const uint64_t alignment, const std::function<void(CommandBuffer& commandBuffer, VkBuffer stagingBuffer, uint64_t stagingOffset)>& recordCopy)
+{
+    //Small uploads go through the upload ring, it gets reclaimed once the next submit is done which is ordered after this one
+    EOS::UploadAllocation allocation = FrameUploadRing->Allocate(size, alignment);
+
+    //The upload does not fit in the ring, so it gets a staging buffer of its own
+    EOS::Holder<EOS::BufferHandle> stagingBuffer;
+    if (!allocation.Valid())
+    {
+        stagingBuffer = CreateBuffer({ .Storage = EOS::StorageType::HostVisible, .Size = size, .DebugName = "Buffer: Staging" }, EOS::MemoryCategory::Staging);
+        allocation.Data = GetMappedPtr(stagingBuffer);
+        allocation.Buffer = EOS::BufferHandle(stagingBuffer);
+    }
+
+    memcpy(allocation.Data, data, size);
+    FlushMappedMemory(allocation.Buffer, allocation.Offset, size);
+
+    CommandBuffer uploadCommandBuffer{this};
+    recordCopy(uploadCommandBuffer, BufferPool.Get(allocation.Buffer)->Buffer, allocation.Offset);
+    const EOS::SubmitHandle handle = VulkanCommandPool->Submit(*uploadCommandBuffer.CommandBufferImpl);
+
+    //Uploads this large only happen while loading, waiting here keeps the staging buffer alive until the copy is done
+    if (stagingBuffer.Valid())
+    {
+        VulkanCommandPool->Wait(handle);
+    }
+}
+
+void VulkanContext::Defragment()
+{
+    if (Defragmentation.Context != VK_NULL_HANDLE) { return; }
+
+    const VmaDefragmentationInfo defragmentationInfo
+    {
+        .flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+        .maxBytesPerPass = Configuration.DefragmentationBytesPerFrame,
+        .maxAllocationsPerPass = Configuration.DefragmentationMovesPerFrame,
+    };
+
+    VK_ASSERT(vmaBeginDefragmentation(Vma, &defragmentationInfo, &Defragmentation.Context));
+}
+
+bool VulkanContext::IsDefragmenting() const
+{
+    return Defragmentation.Context != VK_NULL_HANDLE;
+}
+
+void VulkanContext::ProcessDefragmentation()
+{
+    if (Defragmentation.Context == VK_NULL_HANDLE) { return; }
+
+    //The copies of the last pass, and the frames that used the textures that were destroyed during it, need to be done first.
+    //The old images are also still read through the slots of the moved textures until those have been rewritten.
+    if (Defragmentation.IsPassActive)
+    {
+        if (!Defragmentation.AreSlotsRewritten || !VulkanCommandPool->IsReady(Defragmentation.WaitHandle)) { return; }
+
+        EndDefragmentationPass();
+        if (Defragmentation.Context == VK_NULL_HANDLE) { return; }
+    }
+
+    //VK_SUCCESS means there is nothing left to move
+    if (vmaBeginDefragmentationPass(Vma, Defragmentation.Context, &Defragmentation.Pass) == VK_SUCCESS)
+    {
+        StopDefragmentation();
+        return;
+    }
+
+    Defragmentation.IsPassActive = true;
+    Defragmentation.AreSlotsRewritten = false;
+
+    CommandBuffer defragmentationCommandBuffer{this};
+    for (uint32_t i = 0; i < Defragmentation.Pass.moveCount; ++i)
+    {
+        VmaDefragmentationMove& move = Defragmentation.Pass.pMoves[i];
+        if (!MoveTexture(defragmentationCommandBuffer, move))
+        {
+            move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+        }
+    }
+
+    Defragmentation.WaitHandle = VulkanCommandPool->Submit(*defragmentationCommandBuffer.CommandBufferImpl);
+
+    //A moved texture keeps its bindless slot, which frames in flight still read the old image through.
+    //The slots are rewritten once every submit up to the copies is done instead of waiting on the queue, the old images stay alive until the first frame that reads the new ones is done.
+    Defer(std::packaged_task<void()>([this]()
+    {
+        for (const EOS::TextureHandle handle : Defragmentation.MovedTextures)
+        {
+            //A texture that was destroyed in the meantime has its slot cleared by its own Destroy
+            if (!(TexturePool.GetHandle(handle.Index()) == handle)) { continue; }
+            Bindless->SetTexture(handle.Index(), *TexturePool.Get(handle));
+        }
+        Defragmentation.MovedTextures.clear();
+        Defragmentation.AreSlotsRewritten = true;
+        Defragmentation.WaitHandle = VulkanCommandPool->GetNextSubmitHandle();
+    }), Defragmentation.WaitHandle);
+}
+
+bool VulkanContext::MoveTexture(CommandBuffer& commandBuffer, const VmaDefragmentationMove& move)
+{
+    //Only textures have their handle in the user data. Buffers are never moved, their device addresses have been handed out.
+    VmaAllocationInfo allocationInfo{};
+    vmaGetAllocationInfo(Vma, move.srcAllocation, &allocationInfo);
+    const uintptr_t textureSlot = reinterpret_cast<uintptr_t>(allocationInfo.pUserData);
+    if (textureSlot == 0) { return false; }
+
+    VulkanImage* image = TexturePool.Get(TexturePool.GetHandle(static_cast<uint32_t>(textureSlot - 1)));
+    if (!image) { return false; }
+
+    //Textures the GPU writes to stay where they are, frames that sample the old image until the slot is rewritten would miss those writes
+    constexpr VkImageUsageFlags gpuWriteUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_STORAGE_BIT;
+    if (image->UsageFlags & gpuWriteUsage) { return false; }
+
+    //Textures with subresources in different states stay where they are, they would need a copy per state
+    const EOS::SubresourceRange wholeImage{ .BaseMipLevel = 0, .NumMipLevels = image->Levels, .BaseArrayLayer = 0, .NumArrayLayers = image->Layers };
+    const std::optional<EOS::ResourceState> state = image->GetState(wholeImage);
+    if (!state) { return false; }
+
+    const bool isCubeMap = image->ImageType == EOS::ImageType::CubeMap || image->ImageType == EOS::ImageType::CubeMap_Array;
+    const VkImageCreateInfo imageCreateInfo
+    {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .flags = isCubeMap ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0u,
+        .imageType = VulkanImage::ToImageType(image->ImageType),
+        .format = image->ImageFormat,
+        .extent = image->Extent,
+        .mipLevels = image->Levels,
+        .arrayLayers = image->Layers,
+        .samples = image->Samples,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = image->UsageFlags,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    VkImage newImage = VK_NULL_HANDLE;
+    VK_ASSERT(vkCreateImage(VulkanDevice, &imageCreateInfo, nullptr, &newImage));
+    VK_ASSERT(vmaBindImageMemory(Vma, move.dstTmpAllocation, newImage));
+
+    //Undefined content doesn't have to be copied
+    if (*state != EOS::ResourceState::Undefined)
+    {
+        const VkCommandBuffer vkCommandBuffer = commandBuffer.CommandBufferImpl->VulkanCommandBuffer;
+        BarrierBatch& barriers = commandBuffer.CommandBufferImpl->PendingBarriers;
+
+        VkImageMemoryBarrier2 newImageBarrier = VkSynchronization::CreateImageMemoryBarrier(*image, EOS::ResourceState::Undefined, EOS::ResourceState::CopyDest, wholeImage);
+        newImageBarrier.image = newImage;
+        barriers.AddImageBarrier(vkCommandBuffer, VkSynchronization::CreateImageMemoryBarrier(*image, *state, EOS::ResourceState::CopySource, wholeImage));
+        barriers.AddImageBarrier(vkCommandBuffer, newImageBarrier);
+        commandBuffer.FlushBarriers();
+
+        //A 32 bit extent has at most 32 mip levels
+        std::array<VkImageCopy, std::numeric_limits<uint32_t>::digits> regions{};
+        CHECK(image->Levels <= regions.size(), "The texture has more mip levels than an extent can have");
+        for (uint32_t mip = 0; mip < image->Levels; ++mip)
+        {
+            const VkImageSubresourceLayers subresource{ newImageBarrier.subresourceRange.aspectMask, mip, 0, image->Layers };
+            regions[mip] = VkImageCopy{ .srcSubresource = subresource, .dstSubresource = subresource, .extent = image->GetMipExtent(mip) };
+        }
+        vkCmdCopyImage(vkCommandBuffer, image->Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, newImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, image->Levels, regions.data());
+
+        //Leave the new image in the state the old one was in, so the tracked state stays correct
+        VkImageMemoryBarrier2 restoreBarrier = VkSynchronization::CreateImageMemoryBarrier(*image, EOS::ResourceState::CopyDest, *state, wholeImage);
+        restoreBarrier.image = newImage;
+        barriers.AddImageBarrier(vkCommandBuffer, restoreBarrier);
+    }
+
+    //Swap the image behind the handle, everything that uses the handle from now on uses the new image
+    Defragmentation.OldImages.emplace_back(image->Image);
+    Defragmentation.OldImageViews.emplace_back(image->ImageView);
+    image->Image = newImage;
+    VulkanImage::CreateImageView(image->ImageView, VulkanDevice, newImage, image->ImageType, image->ImageFormat, image->Levels, image->Layers, "Image View: Defragmented");
+
+    if (image->ImageViewStorage)
+    {
+        Defragmentation.OldImageViews.emplace_back(image->ImageViewStorage);
+        VulkanImage::CreateImageView(image->ImageViewStorage, VulkanDevice, newImage, image->ImageType, image->ImageFormat, image->Levels, image->Layers, "Image View: Defragmented Storage");
+    }
+
+    //The attachment views are created when they are first rendered to, so they only have to be forgotten
+    for (auto& mipViews : image->ImageViewForFramebuffer)
+    {
+        for (VkImageView& imageView : mipViews)
+        {
+            if (imageView != VK_NULL_HANDLE)
+            {
+                Defragmentation.OldImageViews.emplace_back(imageView);
+                imageView = VK_NULL_HANDLE;
+            }
+        }
+    }
+    Defragmentation.MovedTextures.emplace_back(TexturePool.GetHandle(static_cast<uint32_t>(textureSlot - 1)));
+
+    return true;
+}
+
+void VulkanContext::EndDefragmentationPass()
+{
+    //The old images are bound to the memory VMA frees in vmaEndDefragmentationPass
+    for (const VkImageView imageView : Defragmentation.OldImageViews)
+    {
+        vkDestroyImageView(VulkanDevice, imageView, nullptr);
+    }
+    for (const VkImage image : Defragmentation.OldImages)
+    {
+        vkDestroyImage(VulkanDevice, image, nullptr);
+    }
+    Defragmentation.OldImageViews.clear();
+    Defragmentation.OldImages.clear();
+    Defragmentation.MovedTextures.clear();
+
+    Defragmentation.IsPassActive = false;
+
+    //VK_SUCCESS means there is nothing left to move
+    if (vmaEndDefragmentationPass(Vma, Defragmentation.Context, &Defragmentation.Pass) == VK_SUCCESS)
+    {
+        StopDefragmentation();
+    }
+}
+
+void VulkanContext::StopDefragmentation()
+{
+    if (Defragmentation.Context == VK_NULL_HANDLE) { return; }
+
+    //Only called while the GPU is idle or when the last pass is done
+    if (Defragmentation.IsPassActive)
+    {
+        EndDefragmentationPass();
+        if (Defragmentation.Context == VK_NULL_HANDLE) { return; }
+    }
+
+    VmaDefragmentationStats stats{};
+    vmaEndDefragmentation(Vma, Defragmentation.Context, &stats);
+    Defragmentation.Context = VK_NULL_HANDLE;
+
+    EOS::Logger->info("Defragmentation moved {} bytes in {} allocations and freed {} bytes", stats.bytesMoved, stats.allocationsMoved, stats.bytesFreed);
+}
+
+bool VulkanContext::IsDeviceLocalMemoryHostVisible() const
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    vkGetPhysicalDeviceMemoryProperties(VulkanPhysicalDevice, &memoryProperties);
+
+    //Without resizable BAR only a 256MB window of the device local memory is host visible, that is too small to put our buffers in
+    constexpr VkDeviceSize barWindowSize = 256ull * 1024 * 1024;
+    constexpr uint32_t checkFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i)
+    {
+        const VkMemoryType& memoryType = memoryProperties.memoryTypes[i];
+        if ((memoryType.propertyFlags & checkFlags) == checkFlags && memoryProperties.memoryHeaps[memoryType.heapIndex].size > barWindowSize)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 bool VulkanContext::IsHostVisibleMemorySingleHeap() const
 {
     VkPhysicalDeviceMemoryProperties memoryProperties;
@@ -1,7 +1,16 @@
 ﻿#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <deque>
 #include <EOS.h>
+#include <filesystem>
+#include <functional>
 #include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <volk.h>
@@ -9,25 +18,143 @@
 
 #include "vkTools.h"
 #include "pool.h"
+#include "threadPool.h"
 
 
 //Forward Declares
 struct VulkanShaderModuleState;
 struct VulkanImage;
+struct VulkanSplitBarrier;
+struct VulkanBuffer;
+struct VulkanTransientMemory;
+struct VulkanSampler;
+struct VulkanPipeline;
 class VulkanContext;
 
 static constexpr const char* validationLayer {"VK_LAYER_KHRONOS_validation"};
 
 using VulkanShaderModulePool = EOS::Pool<EOS::ShaderModule, VulkanShaderModuleState>;
 using VulkanTexturePool = EOS::Pool<EOS::Texture, VulkanImage>;
+using VulkanSplitBarrierPool = EOS::Pool<EOS::SplitBarrier, VulkanSplitBarrier>;
+using VulkanBufferPool = EOS::Pool<EOS::Buffer, VulkanBuffer>;
+using VulkanTransientMemoryPool = EOS::Pool<EOS::TransientMemory, VulkanTransientMemory>;
+using VulkanSamplerPool = EOS::Pool<EOS::Sampler, VulkanSampler>;
+using VulkanComputePipelinePool = EOS::Pool<EOS::ComputePipeline, VulkanPipeline>;
+using VulkanRenderPipelinePool = EOS::Pool<EOS::RenderPipeline, VulkanPipeline>;
 
 //TODO: split up in hot and cold data for the pool
 struct VulkanShaderModuleState final
 {
     VkShaderModule ShaderModule = VK_NULL_HANDLE;
+    VkShaderEXT ShaderObject = VK_NULL_HANDLE;     // only created when the context has shader objects
     uint32_t PushConstantsSize = 0;
 };
 
+//TODO: split up in hot and cold data for the pool
+struct VulkanBuffer final
+{
+    [[nodiscard]] inline bool IsMapped() const { return MappedPtr != nullptr; }
+    [[nodiscard]] inline bool IsCoherent() const { return (MemoryFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) > 0; }
+
+    VkBuffer Buffer                     = VK_NULL_HANDLE;
+    VmaAllocation Allocation            = VK_NULL_HANDLE;
+    VkDeviceAddress DeviceAddress       = 0;            // cached, so we never have to ask the driver while recording
+    VkDeviceSize Size                   = 0;
+    VkBufferUsageFlags UsageFlags       = 0;
+    VkMemoryPropertyFlags MemoryFlags   = 0;
+    void* MappedPtr                     = nullptr;      // persistently mapped for the whole lifetime of the buffer
+    EOS::MemoryCategory Category        = EOS::MemoryCategory::Buffer;
+    EOS::ResourceState CurrentState     = EOS::ResourceState::Undefined;   // the state the last barrier over the whole buffer left it in
+};
+
+//A block of device memory that aliased textures get placed in, the textures don't own any of it.
+struct VulkanTransientMemory final
+{
+    VmaAllocation Allocation            = VK_NULL_HANDLE;
+    VkDeviceSize Size                   = 0;
+};
+
+//A sampler is shared by every Holder that asked for its description, it is destroyed when the last one releases it
+struct VulkanSampler final
+{
+    VkSampler Sampler = VK_NULL_HANDLE;
+    EOS::SamplerDescription Description{};
+    uint32_t NumReferences = 0;
+};
+
+//A pipeline that might still be compiling on a worker thread, it can only be used once Pipeline is set
+struct VulkanPipeline final
+{
+    //Takes the pipeline from the worker thread once it is compiled, returns whether the pipeline can be used
+    bool Resolve(bool wait);
+
+    [[nodiscard]] bool UsesShader(VkShaderModule shader) const { return std::ranges::find(Shaders, shader) != Shaders.end(); }
+
+    VkPipeline Pipeline = VK_NULL_HANDLE;
+    bool HasFailed = false;                    // the compilation failed, the pipeline can never be used
+    std::array<VkShaderModule, 2> Shaders{};   // the modules it is built from, destroying one of them waits until the compilation is done
+    std::future<VkPipeline> Compilation{};     // only valid while a worker thread compiles the pipeline, gives VK_NULL_HANDLE when it fails
+    std::future<VkPipeline> Optimization{};    // only valid while the link time optimized version of a pipeline library link is compiled, it replaces Pipeline once it is done
+};
+
+//Everything a worker thread needs to build a pipeline, the handles of the description are resolved when the pipeline is created
+struct ComputePipelineState final
+{
+    VkShaderModule ComputeShader = VK_NULL_HANDLE;
+    std::vector<VkSpecializationMapEntry> SpecializationEntries{};
+    std::vector<uint8_t> SpecializationData{};
+    std::string DebugName{};
+};
+
+struct RenderPipelineState final
+{
+    EOS::RenderPipelineDescription Description{};
+    VkShaderModule VertexShader = VK_NULL_HANDLE;
+    VkShaderModule FragmentShader = VK_NULL_HANDLE;
+    std::string DebugName{};
+};
+
+//The state of a render pipeline the way Vulkan wants it, monolithic pipelines and the parts of a pipeline library take the states they need from it
+struct GraphicsPipelineStates final
+{
+    explicit GraphicsPipelineStates(const RenderPipelineState& state);
+    DELETE_COPY_MOVE(GraphicsPipelineStates);   // the states point into the struct itself
+
+    std::array<VkFormat, EOS::MaxColorAttachments> ColorFormats{};
+    std::array<VkPipelineColorBlendAttachmentState, EOS::MaxColorAttachments> BlendStates{};
+    std::array<VkPipelineShaderStageCreateInfo, 2> Stages{};    // vertex, fragment
+    std::array<VkDynamicState, 2> DynamicStates{ VK_DYNAMIC_STATE_VIEWPORT_WITH_COUNT, VK_DYNAMIC_STATE_SCISSOR_WITH_COUNT };     // the same calls set them for pipelines and shader objects
+    uint32_t NumStages = 1;
+    VkPipelineRenderingCreateInfo Rendering{};
+    VkPipelineVertexInputStateCreateInfo VertexInput{};
+    VkPipelineInputAssemblyStateCreateInfo InputAssembly{};
+    VkPipelineViewportStateCreateInfo Viewport{};
+    VkPipelineRasterizationStateCreateInfo Rasterization{};
+    VkPipelineMultisampleStateCreateInfo Multisample{};
+    VkPipelineDepthStencilStateCreateInfo DepthStencil{};
+    VkPipelineColorBlendStateCreateInfo ColorBlend{};
+    VkPipelineDynamicStateCreateInfo Dynamic{};
+};
+
+//A part of a render pipeline, it is shared by every render pipeline that has the same state for that part
+struct PipelineLibrary final
+{
+    VkPipeline Library = VK_NULL_HANDLE;
+    VkShaderModule Shader = VK_NULL_HANDLE;     // the shader the part was compiled with, the part goes when the shader does
+};
+
+struct SamplerDescriptionHash final
+{
+    [[nodiscard]] size_t operator()(const EOS::SamplerDescription& description) const;
+};
+
+//A transition that has been signaled with vkCmdSetEvent2 but not yet waited on, the wait needs the exact same barrier.
+struct VulkanSplitBarrier final
+{
+    VkEvent Event = VK_NULL_HANDLE;
+    VkImageMemoryBarrier2 Barrier{};
+};
+
 struct ImageDescription final
 {
     VkImage Image{};
@@ -63,8 +190,29 @@ public:
     [[nodiscard]] static inline bool IsSwapChainImage(const VulkanImage& image) { return (image.ImageType == EOS::ImageType::SwapChain); }
     [[nodiscard]] static VkImageType ToImageType(EOS::ImageType imageType);
     [[nodiscard]] static VkImageViewType ToImageViewType(EOS::ImageType imageType);
+    [[nodiscard]] static VkFormat ToVkFormat(EOS::Format format);
+    [[nodiscard]] static EOS::Format ToFormat(VkFormat format);
+    [[nodiscard]] static bool IsDepthFormat(VkFormat format);
+    [[nodiscard]] static bool HasStencil(VkFormat format);
+    [[nodiscard]] static bool IsIntegerFormat(VkFormat format);
+    [[nodiscard]] static VkResolveModeFlagBits GetResolveMode(VkFormat format);    // integer and depth samples can't be averaged, sample 0 is always supported
+    [[nodiscard]] static uint32_t GetBytesPerTexel(VkFormat format);
 
     static void CreateImageView(VkImageView& imageView, VkDevice device, VkImage image, EOS::ImageType imageType, const VkFormat& imageFormat, uint32_t levels, uint32_t layers ,const char* debugName);
+
+    //Resolves the Remaining counts of the range against the size of this image
+    [[nodiscard]] EOS::SubresourceRange ResolveRange(const EOS::SubresourceRange& range) const;
+    [[nodiscard]] bool IsWholeImage(const EOS::SubresourceRange& range) const;
+    [[nodiscard]] VkExtent3D GetMipExtent(uint32_t mipLevel) const;
+
+    //A view of the first mip level and array layer with all aspects, it gets created the first time the image is rendered into when the default view doesn't fit
+    [[nodiscard]] VkImageView GetAttachmentView(VkDevice device);
+
+    [[nodiscard]] EOS::ResourceState GetState(uint32_t mipLevel, uint32_t arrayLayer) const;
+
+    //Returns the state of the range when all of its subresources are in the same state
+    [[nodiscard]] std::optional<EOS::ResourceState> GetState(const EOS::SubresourceRange& range) const;
+    void SetState(const EOS::SubresourceRange& range, EOS::ResourceState state);
 public:
     VkImage Image                           = VK_NULL_HANDLE;
     VkImageUsageFlags UsageFlags            = 0;
@@ -78,6 +226,13 @@ public:
     bool IsOwningImage                      = true;
     uint32_t Levels                         = 1;
     uint32_t Layers                         = 1;
+    EOS::ResourceState CurrentState         = EOS::ResourceState::Undefined;   // the state the last recorded barrier left the image in
+    EOS::MemoryCategory Category            = EOS::MemoryCategory::Texture;
+
+    // state per [layer * Levels + mip], allocated once when the image is created so tracking never allocates while recording
+    // it is only used while the subresources are in different states
+    std::vector<EOS::ResourceState> SubresourceStates{};
+    bool HasSubresourceStates               = false;
 
     // precached image views - owned by this VulkanImage
     VkImageView ImageView                                   = VK_NULL_HANDLE;       // default view with all mip-levels
@@ -124,6 +279,22 @@ struct DeviceQueues final
     DeviceQueueIndex Compute{};
 };
 
+//The optional features and extensions that got enabled on the device
+struct DeviceCapabilities final
+{
+    bool MemoryBudget = false;
+    bool HostImageCopy = false;
+    bool NullDescriptor = false;
+    bool DescriptorBuffer = false;
+    bool GraphicsPipelineLibrary = false;
+    bool ShaderObject = false;
+    bool GeometryShader = false;
+    bool TessellationShader = false;
+    bool LineRasterization = false;     // one of the line rasterization features is enabled, so shader objects need the line state set
+    float MaxSamplerAnisotropy = 1.0f;
+    VkImageLayout HostImageCopyLayout = VK_IMAGE_LAYOUT_GENERAL;   // the layout the host copies texels into
+};
+
 struct VulkanSwapChain final
 {
 public:
@@ -162,17 +333,60 @@ private:
     friend class VulkanContext;
 };
 
+//Gathers the barriers of a commandbuffer until the next command that depends on them.
+//Barriers on the same image or buffer range get merged and all memory barriers are folded into one, so we record fewer but bigger barriers.
+class BarrierBatch final
+{
+public:
+    static constexpr uint32_t MaxImageBarriers = 32;
+    static constexpr uint32_t MaxBufferBarriers = 32;
+
+    BarrierBatch() = default;
+    ~BarrierBatch() = default;
+    DELETE_COPY_MOVE(BarrierBatch);
+
+    void AddMemoryBarrier(const VkMemoryBarrier2& barrier);
+    void AddImageBarrier(VkCommandBuffer commandBuffer, const VkImageMemoryBarrier2& barrier);
+    void AddBufferBarrier(VkCommandBuffer commandBuffer, const VkBufferMemoryBarrier2& barrier);
+
+    //Records all pending barriers as 1 vkCmdPipelineBarrier2
+    void Flush(VkCommandBuffer commandBuffer);
+
+    [[nodiscard]] bool Empty() const;
+
+private:
+    //Returns true when the barrier doesn't add anything on top of the barriers that came before it.
+    //Only read to read barriers in the same layout whose destination stages and accesses are already in their source get dropped.
+    //A read to read barrier that adds a stage, like a compute read after a fragment read, is kept: the writes before the earlier barrier were only made visible to its stages.
+    //While the earlier barrier is still pending, the transition merge in AddImageBarrier folds both into 1, so only a flushed earlier barrier makes it record a second one.
+    [[nodiscard]] static bool IsRedundant(const VkImageMemoryBarrier2& barrier);
+    [[nodiscard]] static bool Overlaps(const VkImageSubresourceRange& a, const VkImageSubresourceRange& b);
+    [[nodiscard]] static bool Overlaps(const VkBufferMemoryBarrier2& a, const VkBufferMemoryBarrier2& b);
+
+    std::array<VkImageMemoryBarrier2, MaxImageBarriers> ImageBarriers{};
+    uint32_t NumImageBarriers{};
+
+    std::array<VkBufferMemoryBarrier2, MaxBufferBarriers> BufferBarriers{};
+    uint32_t NumBufferBarriers{};
+
+    VkMemoryBarrier2 PendingMemoryBarrier{ .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2 };
+    bool HasMemoryBarrier = false;
+};
+
 struct CommandBufferData
 {
     CommandBufferData() = default;
     DELETE_COPY_MOVE(CommandBufferData);
 
+    BarrierBatch PendingBarriers{};
     VkCommandBuffer VulkanCommandBuffer             = VK_NULL_HANDLE;
     VkCommandBuffer VulkanCommandBufferAllocated    = VK_NULL_HANDLE;
     VkFence Fence                                   = VK_NULL_HANDLE;
     VkSemaphore Semaphore                           = VK_NULL_HANDLE;
     EOS::SubmitHandle Handle                        = {};
     bool isEncoding                                 = false;
+    bool IsBindlessBound                            = false;    // the bindless heap is bound once per commandbuffer, for the graphics and compute bind points
+    bool IsRendering                                = false;    // between cmdBeginRendering and cmdEndRendering
 };
 
 //TODO: Command Recording should be done on multiple threads
@@ -237,11 +451,251 @@ public:
 
     explicit operator bool() const;
 
+    //Records the pending barriers, this needs to happen before every command that could depend on them (draw, dispatch, copy, render-pass begin).
+    void FlushBarriers() const;
+
+    //Binds the bindless heap the first time a command needs it
+    void BindBindlessHeap() const;
+
     EOS::SubmitHandle LastSubmitHandle{};
     CommandBufferData* CommandBufferImpl;
     VulkanContext* VkContext = nullptr;
 };
 
+//A persistently mapped buffer split up in 1 region per frame in flight, allocations are made linearly in the region of the current frame.
+//When a region is used again we first wait until the GPU has finished the submit that used it the last time.
+class UploadRing final
+{
+public:
+    UploadRing(VulkanContext* vulkanContext, uint32_t numFrames, uint64_t frameSize);
+    ~UploadRing() = default;
+    DELETE_COPY_MOVE(UploadRing);
+
+    [[nodiscard]] EOS::UploadAllocation Allocate(uint64_t size, uint64_t alignment);
+
+    //Makes the writes of the current frame visible to the GPU, needs to be called before the submit that reads them
+    void Flush() const;
+
+    //Hands the region of the current frame to the given submit and moves to the next region
+    void EndFrame(EOS::SubmitHandle handle);
+
+private:
+    VulkanContext* VkContext = nullptr;
+    EOS::Holder<EOS::BufferHandle> Buffer;
+    uint8_t* MappedPtr = nullptr;
+    uint64_t GPUAddress = 0;
+
+    uint64_t FrameSize = 0;
+    uint64_t Head = 0;                              // offset in the region of the current frame
+    uint32_t CurrentFrame = 0;
+    std::vector<EOS::SubmitHandle> FrameSubmits;    // the last submit that used each region
+};
+
+//A VkPipelineCache that is loaded from disk at startup and written back on shutdown and every so often while it grows.
+//The file is only used by the same device and driver that wrote it, after a driver update all pipelines are compiled again.
+class PersistentPipelineCache final
+{
+public:
+    PersistentPipelineCache(VkDevice device, VkPhysicalDevice physicalDevice, const char* path, uint32_t saveInterval);
+    ~PersistentPipelineCache();
+    DELETE_COPY_MOVE(PersistentPipelineCache);
+
+    //Saves the cache on a worker thread when the save interval has passed and pipelines have been added since the last save, called once per frame
+    void Update();
+    void Save();
+
+    [[nodiscard]] VkPipelineCache Get() const { return Cache; }
+
+private:
+    //Written in front of the data of the VkPipelineCache
+    struct FileHeader final
+    {
+        static constexpr uint32_t CurrentMagic = 0x454F5350;   // EOSP
+
+        uint32_t Magic = CurrentMagic;
+        uint32_t VendorID = 0;
+        uint32_t DeviceID = 0;
+        uint32_t DriverVersion = 0;
+        uint8_t DriverUUID[VK_UUID_SIZE]{};
+        uint8_t PipelineCacheUUID[VK_UUID_SIZE]{};
+        uint64_t DataSize = 0;
+        uint64_t DataHash = 0;  // catches files that were only partially written
+    };
+
+    //Returns the data of the file when it was written by this device and driver
+    [[nodiscard]] std::vector<uint8_t> Load() const;
+    [[nodiscard]] static uint64_t HashData(const std::vector<uint8_t>& data);
+
+    VkDevice Device = VK_NULL_HANDLE;
+    VkPipelineCache Cache = VK_NULL_HANDLE;
+    std::filesystem::path Path;
+    FileHeader ExpectedHeader{};
+    std::chrono::seconds SaveInterval{};
+    std::chrono::steady_clock::time_point LastSaveTime{};
+    size_t LastSavedSize = 0;           // only touched by the worker while a save is pending
+
+    EOS::ThreadPool SaveWorker{1};
+    std::future<void> PendingSave;
+};
+
+//Keeps track of how much memory every category uses, and calls the eviction callbacks when a device local heap gets close to its budget
+class MemoryBudgetTracker final
+{
+public:
+    MemoryBudgetTracker(VmaAllocator allocator, float threshold);
+    ~MemoryBudgetTracker() = default;
+    DELETE_COPY_MOVE(MemoryBudgetTracker);
+
+    //Memory that is no longer tracked, but still counts towards the heap usage until the deferred task that frees it has run
+    struct PendingRelease final
+    {
+        uint32_t HeapIndex;
+        uint64_t Size;
+    };
+
+    void Track(EOS::MemoryCategory category, VmaAllocation allocation);
+    [[nodiscard]] PendingRelease Untrack(EOS::MemoryCategory category, VmaAllocation allocation);
+
+    //Called by the deferred task once the memory of an untracked allocation has been freed
+    void Release(const PendingRelease& release);
+
+    //Queries the heap budgets and calls the eviction callbacks when needed, should be called once per frame
+    void Update(uint32_t frameIndex);
+
+    [[nodiscard]] EOS::MemoryStatistics GetStatistics() const;
+
+    uint32_t AddEvictionCallback(EOS::EvictionCallback callback);
+    void RemoveEvictionCallback(uint32_t id);
+
+private:
+    struct EvictionCallbackEntry final
+    {
+        uint32_t Id;
+        EOS::EvictionCallback Callback;
+    };
+
+    VmaAllocator Vma = VK_NULL_HANDLE;
+    float Threshold = 1.0f;
+    bool IsOverBudget = false;
+    uint32_t NextCallbackId = 1;
+    std::array<uint64_t, static_cast<size_t>(EOS::MemoryCategory::Count)> CategoryUsage{};
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> HeapBudgets{};
+    std::array<uint64_t, VK_MAX_MEMORY_HEAPS> PendingReleaseBytes{};
+    std::vector<EvictionCallbackEntry> EvictionCallbacks;
+};
+
+//An incremental VMA defragmentation, every pass copies a part of the textures to their new place and ends once the GPU is done with those copies
+struct DefragmentationState final
+{
+    VmaDefragmentationContext Context = VK_NULL_HANDLE;
+    VmaDefragmentationPassMoveInfo Pass{};
+    bool IsPassActive = false;
+    bool AreSlotsRewritten = false;             // the bindless slots of the moved textures point at their new images
+    EOS::SubmitHandle WaitHandle{};             // the pass can end once this submit is done
+    std::vector<VkImage> OldImages;             // the images that were moved away from, destroyed when the pass ends
+    std::vector<VkImageView> OldImageViews;
+    std::vector<EOS::TextureHandle> MovedTextures;  // their slots are rewritten once the frames in flight during the copies are done
+};
+
+//The one descriptor set every pipeline has bound at set 0, resources are found in its arrays by the index of their handle.
+//It is updated after bind, so resources can be added and removed while commandbuffers that use the set are still pending.
+//Changes are kept in a copy of the set on the CPU and only the changed slots get written, once per frame.
+//With VK_EXT_descriptor_buffer the set lives in a mapped buffer instead, descriptors are written straight into it without pools or sets.
+//Both backends write the slots at Flush, on the thread that submits. Writing them from streaming threads would need handles that can be created
+//on any thread and a copy of the set that can be changed concurrently, neither of which exists. Streaming threads fill textures with UploadAsync instead,
+//the slot of the texture has been written when it was created.
+class BindlessHeap final
+{
+public:
+    enum Binding : uint32_t
+    {
+        Textures        = 0,    // sampled images, indexed by TextureHandle
+        Samplers        = 1,    // indexed by SamplerHandle
+        StorageImages   = 2,    // indexed by TextureHandle
+        StorageBuffers  = 3,    // indexed by BufferHandle
+        NumBindings,
+    };
+
+    BindlessHeap(VkDevice device, VkPhysicalDevice physicalDevice, VmaAllocator allocator, const EOS::ContextConfiguration& configuration, const DeviceCapabilities& capabilities);
+    ~BindlessHeap();
+    DELETE_COPY_MOVE(BindlessHeap);
+
+    //Puts the views of the texture in the arrays its usage allows.
+    //Slots are written in place, also in the descriptor buffer the GPU reads, so no frame in flight may read the slot anymore.
+    //The context makes sure of that: indices of destroyed resources are quarantined until the GPU is done.
+    //Moved textures are the exception, frames submitted after the copy can still read their slot while it is rewritten, so the old image stays alive until those are done.
+    void SetTexture(uint32_t index, const VulkanImage& image);
+    void SetSampler(uint32_t index, VkSampler sampler);
+    void SetBuffer(uint32_t index, const VulkanBuffer& buffer);
+
+    //Points the slots of a destroyed resource at nothing, should only be called once the GPU is done with the resource.
+    //A slot that already holds a new resource is left alone. Freed sampler slots get the sampler of slot 0.
+    void ClearTexture(uint32_t index, VkImageView imageView);
+    void ClearSampler(uint32_t index, VkSampler sampler);
+    void ClearBuffer(uint32_t index, VkBuffer buffer);
+
+    //Writes all changed slots, contiguous slots are written together. Needs to be called before the submit that could use them.
+    void Flush();
+
+    void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint) const;
+
+    [[nodiscard]] VkDescriptorSetLayout GetSetLayout() const { return SetLayout; }
+    [[nodiscard]] VkPipelineLayout GetPipelineLayout() const { return PipelineLayout; }
+    [[nodiscard]] uint32_t GetPushConstantsSize() const { return PushConstantsSize; }
+
+    //Pipelines that use the layout of a descriptor buffer have to be created with these flags
+    [[nodiscard]] VkPipelineCreateFlags GetPipelineCreateFlags() const { return UsesDescriptorBuffer ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0u; }
+
+private:
+    static constexpr std::array<VkDescriptorType, NumBindings> DescriptorTypes{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, VK_DESCRIPTOR_TYPE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER };
+
+    void CreateDescriptorSet();
+    void CreateDescriptorBuffer(VkPhysicalDevice physicalDevice);
+
+    void SetImageInfo(Binding binding, uint32_t index, const VkDescriptorImageInfo& imageInfo);
+    void MarkDirty(Binding binding, uint32_t index);
+
+    //Writes the dirty slots into the set or into the descriptor buffer
+    void UpdateDescriptorSet();
+    void UpdateDescriptorBuffer();
+
+    VkDevice Device                         = VK_NULL_HANDLE;
+    VkDescriptorSetLayout SetLayout         = VK_NULL_HANDLE;
+    VkDescriptorPool DescriptorPool         = VK_NULL_HANDLE;
+    VkDescriptorSet DescriptorSet           = VK_NULL_HANDLE;
+    VkPipelineLayout PipelineLayout         = VK_NULL_HANDLE;   // the bindless set and 1 push constant range, shared by all pipelines
+    uint32_t PushConstantsSize              = 0;
+    bool HasNullDescriptor                  = false;    // without VK_EXT_robustness2 freed slots keep pointing at the destroyed resource, which is allowed as long as they aren't used
+    bool UsesDescriptorBuffer               = false;
+    std::array<uint32_t, NumBindings> Capacity{};
+
+    // only used by the descriptor buffer, 1 buffer holds the resource and the sampler descriptors
+    VmaAllocator Vma                        = VK_NULL_HANDLE;
+    VkBuffer DescriptorBuffer               = VK_NULL_HANDLE;
+    VmaAllocation DescriptorBufferAllocation= VK_NULL_HANDLE;
+    uint8_t* DescriptorBufferPtr            = nullptr;
+    VkDeviceAddress DescriptorBufferAddress = 0;
+    std::array<VkDeviceSize, NumBindings> BindingOffsets{};
+    std::array<size_t, NumBindings> DescriptorSizes{};
+
+    // the content of the set on the CPU, grows up to the highest slot that has been used
+    std::array<std::vector<VkDescriptorImageInfo>, NumBindings> ImageInfos{};    // unused for StorageBuffers
+    std::vector<VkDescriptorBufferInfo> BufferInfos{};
+    std::vector<VkDeviceAddress> BufferAddresses{};                             // only used by the descriptor buffer
+    std::array<std::vector<uint32_t>, NumBindings> DirtySlots{};
+    std::array<std::vector<bool>, NumBindings> IsDirty{};
+
+    // reused by every Flush() to avoid allocations
+    std::vector<VkWriteDescriptorSet> Writes{};
+};
+
+//How data gets from the CPU into resources that live in device memory
+enum class UploadStrategy : uint8_t
+{
+    Staging,    // Copy through host visible staging memory in a separate submit
+    Direct,     // Write straight into device local memory that is host visible (ReBAR, integrated GPUs, software rasterizers)
+};
+
 struct DeferredTask
 {
     DeferredTask(std::packaged_task<void()>&& task, EOS::SubmitHandle handle) : Task(std::move(task)), Handle(handle) {}
@@ -260,27 +714,123 @@ public:
 
     [[nodiscard]] EOS::ICommandBuffer& AcquireCommandBuffer() override;
     [[nodiscard]] EOS::SubmitHandle Submit(EOS::ICommandBuffer &commandBuffer, EOS::TextureHandle present) override;
+    void Wait(EOS::SubmitHandle handle) override;
     [[nodiscard]] EOS::TextureHandle GetSwapChainTexture() override;
     [[nodiscard]] EOS::Holder<EOS::ShaderModuleHandle> CreateShaderModule(const EOS::ShaderInfo &shaderInfo) override;
+    [[nodiscard]] EOS::Holder<EOS::SamplerHandle> CreateSampler(const EOS::SamplerDescription& samplerDescription) override;
+    [[nodiscard]] EOS::Holder<EOS::ComputePipelineHandle> CreateComputePipeline(const EOS::ComputePipelineDescription& computePipelineDescription) override;
+    [[nodiscard]] EOS::Holder<EOS::RenderPipelineHandle> CreateRenderPipeline(const EOS::RenderPipelineDescription& renderPipelineDescription) override;
+    [[nodiscard]] EOS::Holder<EOS::RenderPipelineHandle> CreateRenderPipeline(const EOS::RenderPipelineDescription& renderPipelineDescription, const EOS::Framebuffer& framebuffer) override;
+    [[nodiscard]] bool IsPipelineReady(EOS::ComputePipelineHandle handle) override;
+    [[nodiscard]] bool IsPipelineReady(EOS::RenderPipelineHandle handle) override;
+    [[nodiscard]] bool HasShaderObjects() const override;
+    [[nodiscard]] EOS::Holder<EOS::TextureHandle> CreateTexture(const EOS::TextureDescription& textureDescription) override;
+    [[nodiscard]] EOS::Holder<EOS::BufferHandle> CreateBuffer(const EOS::BufferDescription& bufferDescription) override;
+    [[nodiscard]] EOS::Holder<EOS::BufferHandle> CreateBuffer(const EOS::BufferDescription& bufferDescription, EOS::MemoryCategory category);
+
+    [[nodiscard]] uint8_t* GetMappedPtr(EOS::BufferHandle handle) const override;
+    [[nodiscard]] uint64_t GetGPUAddress(EOS::BufferHandle handle) const override;
+    void FlushMappedMemory(EOS::BufferHandle handle, size_t offset, size_t size) const override;
+    [[nodiscard]] EOS::UploadAllocation AllocateUpload(uint64_t size, uint64_t alignment = 16) override;
+    void Upload(EOS::BufferHandle handle, const void* data, size_t size, size_t offset = 0) override;
+    void Upload(EOS::TextureHandle handle, const void* data, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+    [[nodiscard]] std::future<void> UploadAsync(EOS::TextureHandle handle, const void* data, uint32_t mipLevel = 0, uint32_t arrayLayer = 0) override;
+
+    [[nodiscard]] EOS::MemoryStatistics GetMemoryStatistics() const override;
+    uint32_t AddEvictionCallback(EOS::EvictionCallback callback) override;
+    void RemoveEvictionCallback(uint32_t id) override;
+
+    void Defragment() override;
+    [[nodiscard]] bool IsDefragmenting() const override;
+
+    [[nodiscard]] EOS::MemoryRequirements GetMemoryRequirements(const EOS::TextureDescription& textureDescription) const override;
+    [[nodiscard]] EOS::Holder<EOS::TransientMemoryHandle> CreateTransientMemory(const EOS::MemoryRequirements& requirements, const char* debugName = "") override;
+    [[nodiscard]] EOS::Holder<EOS::TextureHandle> CreateAliasedTexture(const EOS::TextureDescription& textureDescription, EOS::TransientMemoryHandle memory, uint64_t offset) override;
 
     void Destroy(EOS::TextureHandle handle) override;
+    void Destroy(EOS::BufferHandle handle) override;
+    void Destroy(EOS::TransientMemoryHandle handle) override;
     void Destroy(EOS::ShaderModuleHandle handle) override;
+    void Destroy(EOS::SamplerHandle handle) override;
+    void Destroy(EOS::ComputePipelineHandle handle) override;
+    void Destroy(EOS::RenderPipelineHandle handle) override;
 
     void ProcessDeferredTasks() const;
     void Defer(std::packaged_task<void()>&& task, EOS::SubmitHandle handle = {}) const;
 
+    //The index of a resource is its bindless slot, so it only goes back to the pool once the GPU is done with the frames that might still read that slot
+    template<typename ObjectType, typename ObjectType_Impl>
+    void DeferRelease(EOS::Pool<ObjectType, ObjectType_Impl>& pool, EOS::Handle<ObjectType> handle)
+    {
+        Defer(std::packaged_task<void()>([&pool, retired = pool.Retire(handle)]() { pool.Release(retired); }));
+    }
+
+    [[nodiscard]] const BindlessHeap& GetBindlessHeap() const { return *Bindless; }
+    [[nodiscard]] const DeviceCapabilities& GetCapabilities() const { return Capabilities; }
+
+    //Events are pooled, a released event becomes available again once the GPU is done with the commandbuffer that used it
+    [[nodiscard]] VkEvent AcquireEvent();
+    void ReleaseEvent(VkEvent event);
+
 
     std::unique_ptr<CommandPool> VulkanCommandPool = nullptr;
     VulkanShaderModulePool ShaderModulePool{};
     VulkanTexturePool TexturePool{};
+    VulkanSplitBarrierPool SplitBarrierPool{};
+    VulkanBufferPool BufferPool{};
+    VulkanTransientMemoryPool TransientMemoryPool{};
+    VulkanSamplerPool SamplerPool{};
+    VulkanComputePipelinePool ComputePipelinePool{};
+    VulkanRenderPipelinePool RenderPipelinePool{};
 private:
     [[nodiscard]] bool HasSwapChain() const noexcept;
     void CreateVulkanInstance(const char* applicationName);
     void SetupDebugMessenger();
     void CreateSurface(void* window, void* display);
+    void CreateAllocator();
     void GetHardwareDevice(EOS::HardwareDeviceType desiredDeviceType, std::vector<EOS::HardwareDeviceDescription>& compatibleDevices) const;
     void WaitOnDeferredTasks();
     [[nodiscard]] bool IsHostVisibleMemorySingleHeap() const;
+    [[nodiscard]] bool IsDeviceLocalMemoryHostVisible() const;
+
+    [[nodiscard]] bool CanUseLinearTiling(const VkImageCreateInfo& imageCreateInfo) const;
+    [[nodiscard]] bool CanUseHostImageCopy(const VkImageCreateInfo& imageCreateInfo) const;
+
+    //Returns the shared sampler of the description with 1 more reference, creates it the first time the description is asked for
+    [[nodiscard]] EOS::SamplerHandle AcquireSampler(const EOS::SamplerDescription& samplerDescription);
+
+    //Creates the pipeline right away when it is in the pipeline cache, otherwise the pipeline gets compiled on a worker thread
+    [[nodiscard]] VulkanPipeline CompilePipeline(std::function<VkResult(VkPipelineCreateFlags flags, VkPipeline& outPipeline)> build);
+    //The builds run one after the other on the same worker thread, so a build can use the pipeline libraries the builds before it compiled
+    [[nodiscard]] std::vector<std::future<VkPipeline>> CompileOnWorker(std::vector<std::function<VkResult(VkPipelineCreateFlags flags, VkPipeline& outPipeline)>> builds);
+    [[nodiscard]] VkResult BuildComputePipeline(const ComputePipelineState& state, VkPipelineCreateFlags flags, VkPipeline& outPipeline) const;
+    [[nodiscard]] VkResult BuildRenderPipeline(const RenderPipelineState& state, VkPipelineCreateFlags flags, VkPipeline& outPipeline) const;
+
+    //Links a render pipeline out of its 4 pipeline library parts, the parts are compiled once and shared by every pipeline that has the same state for them.
+    //An optimized link takes longer, but the pipeline is as fast as a monolithic one.
+    [[nodiscard]] VkResult LinkRenderPipeline(const RenderPipelineState& state, VkPipelineCreateFlags flags, bool optimize, VkPipeline& outPipeline);
+    [[nodiscard]] VkResult GetPipelineLibrary(const RenderPipelineState& state, VkGraphicsPipelineLibraryFlagBitsEXT part, VkPipelineCreateFlags flags, VkPipeline& outLibrary);
+    [[nodiscard]] static uint64_t HashPipelineLibrary(const RenderPipelineState& state, VkGraphicsPipelineLibraryFlagBitsEXT part);
+
+    //Resolves the pipelines that are done compiling, waits for all of them or only for the ones built from the given shader
+    void UpdatePipelineCompilations(bool waitForAll, VkShaderModule waitForShader = VK_NULL_HANDLE);
+
+    //The create info every texture of the description is created with, whether it gets its own memory or is placed in transient memory
+    [[nodiscard]] VkImageCreateInfo GetImageCreateInfo(const EOS::TextureDescription& textureDescription) const;
+    [[nodiscard]] EOS::TextureHandle AddTexture(const EOS::TextureDescription& textureDescription, const VkImageCreateInfo& imageCreateInfo, VkImage vkImage, VmaAllocation allocation, void* mappedPtr);
+
+    //Transitions the subresource to the host image copy layout when it can be copied into by the host, returns false when it can't or when the GPU might still use it
+    [[nodiscard]] bool PrepareHostImageCopy(EOS::TextureHandle handle, uint32_t mipLevel, uint32_t arrayLayer);
+    void CopyMemoryToImage(VkImage image, const void* data, VkExtent3D extent, uint32_t mipLevel, uint32_t arrayLayer) const;
+
+    //Ends the pass that is done and begins and submits the next one, called once per submit
+    void ProcessDefragmentation();
+    void EndDefragmentationPass();
+    void StopDefragmentation();
+    [[nodiscard]] bool MoveTexture(CommandBuffer& commandBuffer, const VmaDefragmentationMove& move);
+
+    //Copies the data into staging memory and submits the commands recordCopy records to copy it out of there
+    void SubmitStagingCopy(const void* data, uint64_t size, uint64_t alignment, const std::function<void(CommandBuffer& commandBuffer, VkBuffer stagingBuffer, uint64_t stagingOffset)>& recordCopy);
 
 private:
     VkInstance VulkanInstance                       = VK_NULL_HANDLE;
@@ -289,11 +839,28 @@ private:
     VkDevice VulkanDevice                           = VK_NULL_HANDLE;
     VkSurfaceKHR VulkanSurface                      = VK_NULL_HANDLE;
     VkSemaphore TimelineSemaphore                   = VK_NULL_HANDLE;
+    VmaAllocator Vma                                = VK_NULL_HANDLE;
     std::unique_ptr<VulkanSwapChain> SwapChain      = nullptr;
+    std::unique_ptr<UploadRing> FrameUploadRing     = nullptr;
+    std::unique_ptr<EOS::ThreadPool> UploadWorkers  = nullptr;     // created on the first async upload
+    std::unique_ptr<EOS::ThreadPool> PipelineWorkers = nullptr;    // created on the first pipeline that is not in the pipeline cache
+    std::unique_ptr<MemoryBudgetTracker> Budget     = nullptr;
+    std::unique_ptr<BindlessHeap> Bindless          = nullptr;
+    std::unique_ptr<PersistentPipelineCache> PipelineCache = nullptr;   // only created when the configuration has a path for it
+    EOS::SamplerHandle DefaultSampler{};                                // slot 0 of the bindless samplers, freed sampler slots fall back to it
+    std::unordered_map<EOS::SamplerDescription, EOS::SamplerHandle, SamplerDescriptionHash> SamplerCache{};
+    std::vector<EOS::ComputePipelineHandle> CompilingComputePipelines{};
+    std::vector<EOS::RenderPipelineHandle> CompilingRenderPipelines{};
+    std::unordered_map<uint64_t, PipelineLibrary> PipelineLibraries{};     // by the hash of the state of their part
+    std::mutex PipelineLibrariesMutex;                                      // the parts are created on the pipeline worker threads
     mutable std::deque<DeferredTask> DeferredTasks;
+    std::vector<VkEvent> FreeEvents{};
 
     CommandBuffer CurrentCommandBuffer;         //TODO: This needs to become a map or vector for multithreaded recording.
     DeviceQueues VulkanDeviceQueues{};
+    DeviceCapabilities Capabilities{};
+    UploadStrategy Uploads = UploadStrategy::Staging;
+    DefragmentationState Defragmentation{};
     EOS::ContextConfiguration Configuration{}; //TODO: Should the lifetime of this obj be the whole application?
 
     friend struct VulkanSwapChain;
@@ -0,0 +1,143 @@
+#include <chrono>
+
+#include "logger.h"
+#include "testUtils.h"
+#include "vulkan/vkTools.h"
+
+//Compares the per-bit tables in vkTools.h with the branches they replaced.
+//Every ResourceState that can be made out of the bits gets converted, so this also checks that both give the same result.
+namespace
+{
+    constexpr uint32_t NumStates = 1u << VkSynchronization::NumResourceStateBits;
+    constexpr uint32_t NumIterations = 64;
+
+    //The conversions as they were before the tables, tests every state 1 by 1
+    namespace Branches
+    {
+        VkPipelineStageFlags2 ConvertToVkPipelineStage2(const EOS::ResourceState state)
+        {
+            VkPipelineStageFlags2 flags = 0;
+
+            if (state & EOS::ResourceState::AccelerationStructureRead) { flags |= VK_PIPELINE_STAGE_2_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR; }
+            if (state & EOS::ResourceState::AccelerationStructureWrite) { flags |= VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR; }
+            if (state & EOS::ResourceState::IndexBuffer) { flags |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT; }
+            if (state & EOS::ResourceState::VertexAndConstantBuffer) { flags |= VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT; }
+            if (state & EOS::ResourceState::PixelShaderResource) { flags |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT; }
+            if (state & EOS::ResourceState::NonPixelShaderResource) { flags |= VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT; }
+            if (state & EOS::ResourceState::UnorderedAccess) { flags |= VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT; }
+            if (state & EOS::ResourceState::UnorderedAccessPixel) { flags |= VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT; }
+            if (state & EOS::ResourceState::RenderTarget) { flags |= VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT; }
+            if (state & (EOS::ResourceState::DepthRead | EOS::ResourceState::DepthWrite)) { flags |= VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT; }
+            if (state & EOS::ResourceState::IndirectArgument) { flags |= VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT; }
+            if (state & (EOS::ResourceState::CopyDest | EOS::ResourceState::CopySource)) { flags |= VK_PIPELINE_STAGE_2_TRANSFER_BIT; }
+
+            return flags != 0 ? flags : VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT;
+        }
+
+        VkAccessFlags2 ConvertToVkAccessFlags2(const EOS::ResourceState state)
+        {
+            VkAccessFlags2 flags = 0;
+
+            if (state & EOS::ResourceState::CopySource) { flags |= VK_ACCESS_2_TRANSFER_READ_BIT; }
+            if (state & EOS::ResourceState::CopyDest) { flags |= VK_ACCESS_2_TRANSFER_WRITE_BIT; }
+            if (state & EOS::ResourceState::VertexAndConstantBuffer) { flags |= VK_ACCESS_2_UNIFORM_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT; }
+            if (state & EOS::ResourceState::IndexBuffer) { flags |= VK_ACCESS_2_INDEX_READ_BIT; }
+            if (state & (EOS::ResourceState::UnorderedAccess | EOS::ResourceState::UnorderedAccessPixel)) { flags |= VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT; }
+            if (state & EOS::ResourceState::IndirectArgument) { flags |= VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT; }
+            if (state & EOS::ResourceState::RenderTarget) { flags |= VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT; }
+            if (state & EOS::ResourceState::DepthWrite) { flags |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT; }
+            if (state & EOS::ResourceState::DepthRead) { flags |= VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT; }
+            if (state & EOS::ResourceState::ShaderResource) { flags |= VK_ACCESS_2_SHADER_READ_BIT; }
+            if (state & EOS::ResourceState::Present) { flags |= VK_ACCESS_2_MEMORY_READ_BIT; }
+            if (state & EOS::ResourceState::AccelerationStructureRead) { flags |= VK_ACCESS_2_ACCELERATION_STRUCTURE_READ_BIT_KHR; }
+            if (state & EOS::ResourceState::AccelerationStructureWrite) { flags |= VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR; }
+
+            return flags;
+        }
+
+        VkImageLayout ConvertToVkImageLayout(const EOS::ResourceState state)
+        {
+            if (state & EOS::ResourceState::CopySource) { return VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; }
+            if (state & EOS::ResourceState::CopyDest) { return VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; }
+            if (state & EOS::ResourceState::RenderTarget) { return VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; }
+            if (state & EOS::ResourceState::DepthWrite) { return VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL; }
+            if (state & EOS::ResourceState::DepthRead) { return VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL; }
+            if (state & (EOS::ResourceState::UnorderedAccess | EOS::ResourceState::UnorderedAccessPixel)) { return VK_IMAGE_LAYOUT_GENERAL; }
+            if (state & EOS::ResourceState::ShaderResource) { return VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL; }
+            if (state & EOS::ResourceState::Present) { return VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; }
+            if (state == EOS::ResourceState::Common) { return VK_IMAGE_LAYOUT_GENERAL; }
+
+            return VK_IMAGE_LAYOUT_UNDEFINED;
+        }
+    }
+
+    struct ConvertedState final
+    {
+        VkPipelineStageFlags2 Stage;
+        VkAccessFlags2 Access;
+        VkImageLayout Layout;
+    };
+
+    ConvertedState ConvertWithTables(const EOS::ResourceState state)
+    {
+        return {VkSynchronization::ConvertToVkPipelineStage2(state), VkSynchronization::ConvertToVkAccessFlags2(state), VkSynchronization::ConvertToVkImageLayout(state)};
+    }
+
+    ConvertedState ConvertWithBranches(const EOS::ResourceState state)
+    {
+        return {Branches::ConvertToVkPipelineStage2(state), Branches::ConvertToVkAccessFlags2(state), Branches::ConvertToVkImageLayout(state)};
+    }
+
+    void TablesGiveTheSameResultAsBranches()
+    {
+        for (uint32_t state{}; state < NumStates; ++state)
+        {
+            const ConvertedState tables = ConvertWithTables(static_cast<EOS::ResourceState>(state));
+            const ConvertedState branches = ConvertWithBranches(static_cast<EOS::ResourceState>(state));
+            EXPECT(tables.Stage == branches.Stage);
+            EXPECT(tables.Access == branches.Access);
+            EXPECT(tables.Layout == branches.Layout);
+        }
+    }
+
+    //Returns the time in nanoseconds per converted state
+    template<typename Convert>
+    double Measure(Convert convert)
+    {
+        //Fold every result in, so the conversions can't be optimized away
+        volatile uint64_t sink = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint32_t iteration{}; iteration < NumIterations; ++iteration)
+        {
+            uint64_t folded = 0;
+            for (uint32_t state{}; state < NumStates; ++state)
+            {
+                const ConvertedState converted = convert(static_cast<EOS::ResourceState>(state));
+                folded ^= converted.Stage ^ converted.Access ^ converted.Layout;
+            }
+            sink = sink + folded;
+        }
+        const auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count() / (static_cast<double>(NumIterations) * NumStates);
+    }
+
+    void MeasureConversions()
+    {
+        const double branches = Measure(ConvertWithBranches);
+        const double tables = Measure(ConvertWithTables);
+        EOS::Logger->info("ResourceState conversions, branches: {:.2f} ns, tables: {:.2f} ns, speedup: {:.2f}x", branches, tables, branches / tables);
+    }
+}
+
+int main()
+{
+    EOS::Logger::Init("EOS Barrier Benchmark", ".cache/barrierBenchmark.txt");
+
+    TablesGiveTheSameResultAsBranches();
+    MeasureConversions();
+
+    EOS::Logger::Destroy();
+    return NumFailedExpectations;
+}
@@ -0,0 +1,210 @@
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "EOS.h"
+#include "logger.h"
+#include "testUtils.h"
+#include "shaders/shaderUtils.h"
+
+//Records real work on a context without a window and reads back what the GPU wrote, a software device like lavapipe is enough to run these
+namespace
+{
+    constexpr uint32_t NumValues    = 256;
+    constexpr uint32_t GroupSize    = 64;       // the numthreads of specializedAdd.slang
+    constexpr float Scale           = 3.0f;     // the specialization constant of specializedAdd.slang
+    constexpr float Untouched       = -1.0f;    // what the result buffer holds where the shader should not write
+
+    constexpr uint32_t TargetSize   = 64;
+    constexpr int ColorTolerance    = 8;        // the rasterizer samples the interpolated colors at the pixel centers, not at the exact center of the target
+
+    //Matches the uniform parameters of specializedAdd.slang
+    struct AddPushConstants final
+    {
+        uint64_t Buffer0;
+        uint64_t Buffer1;
+        uint64_t Result;
+        uint32_t Count;
+    };
+
+    //Pipelines compile on a worker thread, one that failed to compile never becomes ready
+    template<typename PipelineHandle>
+    bool WaitUntilReady(EOS::IContext& context, PipelineHandle pipeline)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (!context.IsPipelineReady(pipeline))
+        {
+            if (std::chrono::steady_clock::now() > deadline) { return false; }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        return true;
+    }
+
+    EOS::Holder<EOS::BufferHandle> CreateFloatBuffer(EOS::IContext& context, const std::vector<float>& values, const char* debugName)
+    {
+        //Host visible, so the result can be read back through its mapped pointer
+        return context.CreateBuffer({ .Usage = EOS::BufferUsageFlags::StorageBuffer, .Storage = EOS::StorageType::HostVisible, .Size = values.size() * sizeof(float), .Data = values.data(), .DebugName = debugName });
+    }
+
+    //The buffers of 1 dispatch of specializedAdd.slang, buffer0 holds the index of each value and buffer1 holds ones
+    struct AddBuffers final
+    {
+        explicit AddBuffers(EOS::IContext& context)
+        {
+            std::vector<float> indices(NumValues);
+            for (uint32_t i{}; i < NumValues; ++i) { indices[i] = static_cast<float>(i); }
+
+            Buffer0 = CreateFloatBuffer(context, indices, "Indices");
+            Buffer1 = CreateFloatBuffer(context, std::vector<float>(NumValues, 1.0f), "Ones");
+            Result = CreateFloatBuffer(context, std::vector<float>(NumValues, Untouched), "Result");
+        }
+
+        [[nodiscard]] AddPushConstants GetPushConstants(const EOS::IContext& context, const uint32_t count) const
+        {
+            return { context.GetGPUAddress(Buffer0), context.GetGPUAddress(Buffer1), context.GetGPUAddress(Result), count };
+        }
+
+        //Every value below numWritten should hold the scaled sum, the ones after it should not be written to
+        void ExpectResult(const EOS::IContext& context, const uint32_t numWritten) const
+        {
+            const float* result = reinterpret_cast<const float*>(context.GetMappedPtr(Result));
+            EXPECT(result);
+            if (!result) { return; }
+
+            for (uint32_t i{}; i < NumValues; ++i)
+            {
+                EXPECT(result[i] == (i < numWritten ? (static_cast<float>(i) + 1.0f) * Scale : Untouched));
+            }
+        }
+
+        EOS::Holder<EOS::BufferHandle> Buffer0;
+        EOS::Holder<EOS::BufferHandle> Buffer1;
+        EOS::Holder<EOS::BufferHandle> Result;
+    };
+
+    EOS::Holder<EOS::ComputePipelineHandle> CreateSpecializedAddPipeline(EOS::IContext& context, const EOS::ShaderModuleHandle shader)
+    {
+        constexpr EOS::SpecializationConstant scaleConstant{ .ID = 0, .Offset = 0, .Size = sizeof(float) };
+        return context.CreateComputePipeline({ .ComputeShader = shader, .Specialization = { .Constants = {&scaleConstant, 1}, .Data = &Scale, .DataSize = sizeof(Scale) }, .DebugName = "SpecializedAdd" });
+    }
+
+    void DispatchWritesTheScaledSumUpToTheCount(EOS::IContext& context, const EOS::ComputePipelineHandle pipeline)
+    {
+        //Not a multiple of the group size, so the shader has to skip the threads of the last group that are past the count
+        constexpr uint32_t count = 200;
+
+        const AddBuffers buffers(context);
+        const AddPushConstants pushConstants = buffers.GetPushConstants(context, count);
+
+        EOS::ICommandBuffer& cmdBuffer = context.AcquireCommandBuffer();
+        cmdBindComputePipeline(cmdBuffer, pipeline);
+        cmdPushConstants(cmdBuffer, &pushConstants, sizeof(pushConstants));
+        cmdDispatch(cmdBuffer, (count + GroupSize - 1) / GroupSize);
+        context.Wait(context.Submit(cmdBuffer, {}));
+
+        buffers.ExpectResult(context, count);
+    }
+
+    void DispatchIndirectReadsTheGroupCountFromTheBuffer(EOS::IContext& context, const EOS::ComputePipelineHandle pipeline)
+    {
+        //The count lets every thread write, so only the number of groups in the indirect buffer limits the result
+        constexpr uint32_t numGroups[3] = { 2, 1, 1 };
+
+        const AddBuffers buffers(context);
+        const AddPushConstants pushConstants = buffers.GetPushConstants(context, NumValues);
+        EOS::Holder<EOS::BufferHandle> indirectBuffer = context.CreateBuffer({ .Usage = EOS::BufferUsageFlags::Indirect, .Size = sizeof(numGroups), .Data = numGroups, .DebugName = "DispatchArguments" });
+
+        EOS::ICommandBuffer& cmdBuffer = context.AcquireCommandBuffer();
+        cmdTransition(cmdBuffer, indirectBuffer, EOS::ResourceState::IndirectArgument);
+        cmdBindComputePipeline(cmdBuffer, pipeline);
+        cmdPushConstants(cmdBuffer, &pushConstants, sizeof(pushConstants));
+        cmdDispatchIndirect(cmdBuffer, indirectBuffer);
+        context.Wait(context.Submit(cmdBuffer, {}));
+
+        buffers.ExpectResult(context, numGroups[0] * GroupSize);
+    }
+
+    void ExpectPixel(const uint8_t* pixels, const uint32_t x, const uint32_t y, const std::array<int, 4>& expected)
+    {
+        const uint8_t* pixel = pixels + (static_cast<size_t>(y) * TargetSize + x) * 4;
+        for (size_t channel{}; channel < expected.size(); ++channel)
+        {
+            EXPECT(std::abs(pixel[channel] - expected[channel]) <= ColorTolerance);
+        }
+    }
+
+    void TriangleIsRenderedIntoAnOffscreenTexture(EOS::IContext& context, const EOS::ShaderModuleHandle vertexShader, const EOS::ShaderModuleHandle fragmentShader)
+    {
+        EOS::Holder<EOS::TextureHandle> target = context.CreateTexture({ .TextureFormat = EOS::Format::RGBA_UN8, .Width = TargetSize, .Height = TargetSize, .Usage = EOS::TextureUsageFlags::Attachment, .DebugName = "Offscreen" });
+        EOS::Holder<EOS::BufferHandle> readback = context.CreateBuffer({ .Storage = EOS::StorageType::HostVisible, .Size = TargetSize * TargetSize * 4, .DebugName = "Readback" });
+
+        EOS::Framebuffer framebuffer{};
+        framebuffer.ColorAttachments[0] = { .Texture = target, .Load = EOS::LoadOp::Clear, .Store = EOS::StoreOp::Store, .ClearColor = { 0.0f, 0.0f, 0.0f, 1.0f } };
+        EOS::Holder<EOS::RenderPipelineHandle> pipeline = context.CreateRenderPipeline({ .VertexShader = vertexShader, .FragmentShader = fragmentShader, .Culling = EOS::CullMode::None, .DebugName = "Triangle" }, framebuffer);
+
+        const bool isPipelineReady = WaitUntilReady(context, static_cast<EOS::RenderPipelineHandle>(pipeline));
+        EXPECT(isPipelineReady);
+        if (!isPipelineReady) { return; }
+
+        EOS::ICommandBuffer& cmdBuffer = context.AcquireCommandBuffer();
+        cmdBeginRendering(cmdBuffer, framebuffer);
+        cmdBindRenderPipeline(cmdBuffer, pipeline);
+        cmdDraw(cmdBuffer, 3);
+        cmdEndRendering(cmdBuffer);
+        cmdCopyTextureToBuffer(cmdBuffer, target, readback);
+        context.Wait(context.Submit(cmdBuffer, {}));
+
+        const uint8_t* pixels = context.GetMappedPtr(readback);
+        EXPECT(pixels);
+        if (!pixels) { return; }
+
+        //The corners are outside of the triangle, so they keep the clear color
+        ExpectPixel(pixels, 0, 0, { 0, 0, 0, 255 });
+        ExpectPixel(pixels, TargetSize - 1, 0, { 0, 0, 0, 255 });
+        ExpectPixel(pixels, 0, TargetSize - 1, { 0, 0, 0, 255 });
+        ExpectPixel(pixels, TargetSize - 1, TargetSize - 1, { 0, 0, 0, 255 });
+
+        //The center is halfway between the red vertex at the top and the green and blue vertices at the bottom
+        ExpectPixel(pixels, TargetSize / 2, TargetSize / 2, { 128, 64, 64, 255 });
+    }
+}
+
+int main()
+{
+    {
+        //The context initializes the logger
+        const EOS::ContextCreationDescription contextDescription
+        {
+            .config =
+            {
+                .enableValidationLayers = true,
+                .PipelineCachePath      = nullptr,
+            },
+            .preferredHardwareType  = EOS::HardwareDeviceType::Software,
+            .applicationName        = "EOS - Headless Tests",
+        };
+        std::unique_ptr<EOS::IContext> context = EOS::CreateHeadlessContext(contextDescription);
+        std::unique_ptr<EOS::ShaderCompiler> shaderCompiler = EOS::CreateShaderCompiler("src/shaders/");
+
+        EOS::Holder<EOS::ShaderModuleHandle> addShader = EOS::LoadShader(context, shaderCompiler, "specializedAdd");
+        EOS::Holder<EOS::ShaderModuleHandle> vertexShader = EOS::LoadShader(context, shaderCompiler, "triangleVertex");
+        EOS::Holder<EOS::ShaderModuleHandle> fragmentShader = EOS::LoadShader(context, shaderCompiler, "triangleFragment");
+        EOS::Holder<EOS::ComputePipelineHandle> addPipeline = CreateSpecializedAddPipeline(*context, addShader);
+
+        const bool isAddPipelineReady = WaitUntilReady(*context, static_cast<EOS::ComputePipelineHandle>(addPipeline));
+        EXPECT(isAddPipelineReady);
+        if (isAddPipelineReady)
+        {
+            DispatchWritesTheScaledSumUpToTheCount(*context, addPipeline);
+            DispatchIndirectReadsTheGroupCountFromTheBuffer(*context, addPipeline);
+        }
+
+        TriangleIsRenderedIntoAnOffscreenTexture(*context, vertexShader, fragmentShader);
+    }
+
+    EOS::Logger::Destroy();
+    return NumFailedExpectations;
+}
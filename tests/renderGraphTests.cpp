@@ -0,0 +1,115 @@
+#include "renderGraph.h"
+#include "logger.h"
+#include "testUtils.h"
+
+//These only compile the graph, recording it needs a context, see headlessTests.cpp
+namespace
+{
+    constexpr EOS::TransientTextureDescription TransientDescription{ .Size = 1024, .Alignment = 256, .MemoryTypeBits = 0xFFFFFFFF };
+
+    void DoNothing(const EOS::ICommandBuffer&, const EOS::RenderGraph&) {}
+
+    void PassesThatDontReachAnImportedResourceAreCulled()
+    {
+        EOS::RenderGraph renderGraph{};
+        const EOS::RenderGraphResource backBuffer = renderGraph.ImportTexture("BackBuffer", {}, EOS::ResourceState::Present);
+        const EOS::RenderGraphResource unused = renderGraph.CreateTransientTexture("Unused", TransientDescription);
+        const EOS::RenderGraphResource gBuffer = renderGraph.CreateTransientTexture("GBuffer", TransientDescription);
+
+        renderGraph.AddPass("Unused", DoNothing).Write(unused, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("GBuffer", DoNothing).Write(gBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("Lighting", DoNothing).Read(gBuffer, EOS::ResourceState::PixelShaderResource).Write(backBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("Debug", DoNothing).Write(unused, EOS::ResourceState::UnorderedAccess).SideEffect();
+        renderGraph.Compile();
+
+        EXPECT(renderGraph.GetNumPasses() == 4);
+        EXPECT(renderGraph.IsPassCulled(0));
+        EXPECT(!renderGraph.IsPassCulled(1));
+        EXPECT(!renderGraph.IsPassCulled(2));
+        EXPECT(!renderGraph.IsPassCulled(3));
+    }
+
+    void TransientTexturesWithoutOverlappingLifetimesShareMemory()
+    {
+        EOS::RenderGraph renderGraph{};
+        const EOS::RenderGraphResource backBuffer = renderGraph.ImportTexture("BackBuffer", {}, EOS::ResourceState::Present);
+        const EOS::RenderGraphResource first = renderGraph.CreateTransientTexture("First", TransientDescription);
+        const EOS::RenderGraphResource second = renderGraph.CreateTransientTexture("Second", TransientDescription);
+
+        //first lives in pass 0 and 1, second in pass 2 and 3
+        renderGraph.AddPass("WriteFirst", DoNothing).Write(first, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("ReadFirst", DoNothing).Read(first, EOS::ResourceState::PixelShaderResource).Write(backBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("WriteSecond", DoNothing).Write(second, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("ReadSecond", DoNothing).Read(second, EOS::ResourceState::PixelShaderResource).Write(backBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.Compile();
+
+        EXPECT(renderGraph.GetTransientMemoryOffset(first) == renderGraph.GetTransientMemoryOffset(second));
+        EXPECT(renderGraph.GetTransientMemorySize() == TransientDescription.Size);
+    }
+
+    void TransientTexturesWithOverlappingLifetimesDontShareMemory()
+    {
+        EOS::RenderGraph renderGraph{};
+        const EOS::RenderGraphResource backBuffer = renderGraph.ImportTexture("BackBuffer", {}, EOS::ResourceState::Present);
+        const EOS::RenderGraphResource first = renderGraph.CreateTransientTexture("First", TransientDescription);
+        const EOS::RenderGraphResource second = renderGraph.CreateTransientTexture("Second", TransientDescription);
+
+        renderGraph.AddPass("WriteBoth", DoNothing).Write(first, EOS::ResourceState::RenderTarget).Write(second, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("ReadBoth", DoNothing).Read(first, EOS::ResourceState::PixelShaderResource).Read(second, EOS::ResourceState::PixelShaderResource).Write(backBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.Compile();
+
+        const uint64_t firstOffset = renderGraph.GetTransientMemoryOffset(first);
+        const uint64_t secondOffset = renderGraph.GetTransientMemoryOffset(second);
+        EXPECT(firstOffset + TransientDescription.Size <= secondOffset || secondOffset + TransientDescription.Size <= firstOffset);
+        EXPECT(firstOffset % TransientDescription.Alignment == 0 && secondOffset % TransientDescription.Alignment == 0);
+        EXPECT(renderGraph.GetTransientMemorySize() == 2 * TransientDescription.Size);
+    }
+
+    void IndependentComputePassesAreAsyncComputeCandidates()
+    {
+        EOS::RenderGraph renderGraph{};
+        const EOS::RenderGraphResource backBuffer = renderGraph.ImportTexture("BackBuffer", {}, EOS::ResourceState::Present);
+        const EOS::RenderGraphResource shadowMap = renderGraph.CreateTransientTexture("ShadowMap", TransientDescription);
+        const EOS::RenderGraphResource particles = renderGraph.CreateTransientTexture("Particles", TransientDescription);
+
+        //The particles don't need the shadow map, so both can be worked on at the same time
+        renderGraph.AddPass("ShadowMap", DoNothing).Write(shadowMap, EOS::ResourceState::DepthWrite);
+        renderGraph.AddPass("Particles", DoNothing, EOS::RenderGraphQueue::Compute).Write(particles, EOS::ResourceState::UnorderedAccess);
+        renderGraph.AddPass("Lighting", DoNothing).Read(shadowMap, EOS::ResourceState::PixelShaderResource).Read(particles, EOS::ResourceState::PixelShaderResource).Write(backBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.Compile();
+
+        EXPECT(!renderGraph.IsAsyncComputeCandidate(0));
+        EXPECT(renderGraph.IsAsyncComputeCandidate(1));
+        EXPECT(!renderGraph.IsAsyncComputeCandidate(2));
+    }
+
+    void DependentComputePassesAreNotAsyncComputeCandidates()
+    {
+        EOS::RenderGraph renderGraph{};
+        const EOS::RenderGraphResource backBuffer = renderGraph.ImportTexture("BackBuffer", {}, EOS::ResourceState::Present);
+        const EOS::RenderGraphResource gBuffer = renderGraph.CreateTransientTexture("GBuffer", TransientDescription);
+        const EOS::RenderGraphResource ambientOcclusion = renderGraph.CreateTransientTexture("AmbientOcclusion", TransientDescription);
+
+        //The ambient occlusion waits on the GBuffer and the lighting waits on the ambient occlusion, no graphics pass is left to overlap with
+        renderGraph.AddPass("GBuffer", DoNothing).Write(gBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.AddPass("AmbientOcclusion", DoNothing, EOS::RenderGraphQueue::Compute).Read(gBuffer, EOS::ResourceState::NonPixelShaderResource).Write(ambientOcclusion, EOS::ResourceState::UnorderedAccess);
+        renderGraph.AddPass("Lighting", DoNothing).Read(gBuffer, EOS::ResourceState::PixelShaderResource).Read(ambientOcclusion, EOS::ResourceState::PixelShaderResource).Write(backBuffer, EOS::ResourceState::RenderTarget);
+        renderGraph.Compile();
+
+        EXPECT(!renderGraph.IsAsyncComputeCandidate(1));
+    }
+}
+
+int main()
+{
+    EOS::Logger::Init("EOS Tests", ".cache/renderGraphTests.txt");
+
+    PassesThatDontReachAnImportedResourceAreCulled();
+    TransientTexturesWithoutOverlappingLifetimesShareMemory();
+    TransientTexturesWithOverlappingLifetimesDontShareMemory();
+    IndependentComputePassesAreAsyncComputeCandidates();
+    DependentComputePassesAreNotAsyncComputeCandidates();
+
+    EOS::Logger::Destroy();
+    return NumFailedExpectations;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdio>
+
+//Every test executable returns the number of failed expectations, so ctest sees any failure
+inline int NumFailedExpectations = 0;
+
+//Unlike CHECK this is not stripped out in release and doesn't stop the test
+#define EXPECT(condition)                                                                       \
+do                                                                                              \
+{                                                                                               \
+    if (!(condition))                                                                           \
+    {                                                                                           \
+        std::fprintf(stderr, "%s:%d: EXPECT(%s) failed\n", __FILE__, __LINE__, #condition);     \
+        ++NumFailedExpectations;                                                                \
+    }                                                                                           \
+} while (0)